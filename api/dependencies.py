@@ -5,11 +5,17 @@ from sqlalchemy import select
 from slowapi import Limiter
 from slowapi.util import get_remote_address
 from jose import JWTError
-from typing import Optional
+from typing import Optional, AsyncGenerator
+import logging
 
-from db.database import get_async_session
+from core.config import settings
+from db.database import get_async_session, get_session_maker, get_replica_session_maker
 from db.models import User
 from services.auth_service import decode_access_token
+from services.principals import Principal, get_principal
+from services.redis import has_recent_write
+
+logger = logging.getLogger(__name__)
 
 security = HTTPBearer()
 security_optional = HTTPBearer(auto_error=False)
@@ -17,42 +23,101 @@ security_optional = HTTPBearer(auto_error=False)
 # Rate limiter - uses client IP address for identification
 limiter = Limiter(key_func=get_remote_address)
 
+# Methods that never write - eligible for the read replica
+SAFE_METHODS = {"GET", "HEAD", "OPTIONS"}
 
-async def get_current_user(
+
+def _credentials_exception() -> HTTPException:
+    return HTTPException(
+        status_code=status.HTTP_401_UNAUTHORIZED,
+        detail="Invalid authentication credentials",
+        headers={"WWW-Authenticate": "Bearer"},
+    )
+
+
+def user_id_from_request(request: Request) -> Optional[int]:
+    """Caller's user id from the bearer token, or None - no DB, no errors"""
+    scheme, _, token = request.headers.get("authorization", "").partition(" ")
+    if scheme.lower() != "bearer" or not token:
+        return None
+    try:
+        return int(decode_access_token(token).get("sub"))
+    except (JWTError, ValueError, TypeError):
+        return None
+
+
+async def get_read_session(request: Request) -> AsyncGenerator[AsyncSession, None]:
+    """
+    Session for read-only endpoints.
+
+    GET/HEAD requests go to the read replica (DATABASE_REPLICA_URL) unless the
+    caller wrote something in the last REPLICA_PIN_SECONDS - see the
+    pin_recent_writers middleware in main.py - so users always read their own
+    writes. Anything else, or no replica configured, uses the primary.
+    Endpoints using this must not write.
+    """
+    session_maker = get_session_maker()
+    if settings.DATABASE_REPLICA_URL and request.method in SAFE_METHODS:
+        user_id = user_id_from_request(request)
+        try:
+            pinned = user_id is not None and await has_recent_write(user_id)
+        except Exception as e:
+            logger.warning(f"Recent-write check failed, reading from primary: {e}")
+            pinned = True
+        if not pinned:
+            session_maker = get_replica_session_maker()
+
+    async with session_maker() as session:
+        yield session
+
+
+async def get_current_principal(
     credentials: HTTPAuthorizationCredentials = Depends(security),
     db: AsyncSession = Depends(get_async_session)
-) -> User:
+) -> Principal:
     """
-    Get current authenticated user from JWT access token.
+    Get the slim principal (id, nickname, avatar, flags) for the JWT caller.
 
     Validates:
     - Token signature and expiration
     - Token type is 'access' (not refresh)
     - User exists and is active
-    """
-    credentials_exception = HTTPException(
-        status_code=status.HTTP_401_UNAUTHORIZED,
-        detail="Invalid authentication credentials",
-        headers={"WWW-Authenticate": "Bearer"},
-    )
 
+    Served from the principal cache, so most requests never read the users table.
+    """
     try:
         token = credentials.credentials
         payload = decode_access_token(token)
         user_id = int(payload.get("sub"))
+    except JWTError:
+        raise _credentials_exception()
+    except (ValueError, TypeError):
+        raise _credentials_exception()
 
-        result = await db.execute(select(User).where(User.id == user_id))
-        user = result.scalar_one_or_none()
+    principal = await get_principal(db, user_id)
+    if not principal or not principal.is_active:
+        raise _credentials_exception()
 
-        if not user or not user.is_active:
-            raise credentials_exception
+    return principal
 
-        return user
 
-    except JWTError:
-        raise credentials_exception
-    except (ValueError, TypeError):
-        raise credentials_exception
+async def get_current_user(
+    principal: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_async_session)
+) -> User:
+    """
+    Get the full ORM User for the authenticated caller.
+
+    Only for endpoints that read or write profile columns - everything else
+    should depend on get_current_principal. Shares the request's session, so
+    changes to the returned User are committed by the endpoint as before.
+    """
+    user = await db.get(User, principal.id)
+
+    if not user or not user.is_active:
+        raise _credentials_exception()
+
+    return user
 
 
 async def get_admin_user(
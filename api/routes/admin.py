@@ -11,6 +11,12 @@ from db.database import get_async_session
 from db.models import User, CheckIn, Bounce, BounceInvite, BounceAttendee, Follow, Place, CheckInHistory
 from api.dependencies import get_admin_user
 from services.auth_service import create_access_token
+from services.device_tokens import invalidate_token_index
+from services.principals import invalidate_principal
+from services.follow_graph import remove_follow, remove_user_follows, sync_follow_graph, sync_checkins
+from services.etag import (
+    BOUNCES_SCOPE, CHECKINS_SCOPE, bounce_scope, bump_versions, close_friend_locations_scope, user_scope
+)
 
 router = APIRouter(prefix="/admin", tags=["admin"])
 templates = Jinja2Templates(directory="templates")
@@ -204,22 +210,14 @@ async def admin_user_detail(
     if not user:
         raise HTTPException(status_code=404, detail="User not found")
 
-    # Get follower/following counts
-    follower_count = await db.scalar(
-        select(func.count(Follow.id)).where(Follow.following_id == user_id)
-    )
-    following_count = await db.scalar(
-        select(func.count(Follow.id)).where(Follow.follower_id == user_id)
-    )
-
     return templates.TemplateResponse(
         "admin/users/detail.html",
         {
             "request": request,
             "admin": admin,
             "user": user,
-            "follower_count": follower_count or 0,
-            "following_count": following_count or 0
+            "follower_count": user.followers_count,
+            "following_count": user.following_count
         }
     )
 
@@ -253,6 +251,8 @@ async def admin_user_update(
     user.can_post = can_post
 
     await db.commit()
+    await invalidate_principal(user_id)
+    await bump_versions(user_scope(user_id))
 
     return RedirectResponse(url=f"/admin/users/{user_id}", status_code=302)
 
@@ -274,8 +274,13 @@ async def admin_user_delete(
     if not user:
         raise HTTPException(status_code=404, detail="User not found")
 
+    await remove_user_follows(db, user_id)
     await db.delete(user)
     await db.commit()
+    await sync_follow_graph(db)
+    await invalidate_token_index([user_id])
+    await invalidate_principal(user_id)
+    await bump_versions(user_scope(user_id), BOUNCES_SCOPE, CHECKINS_SCOPE)
 
     return RedirectResponse(url="/admin/users", status_code=302)
 
@@ -342,6 +347,9 @@ async def admin_checkin_delete(
 
     await db.delete(checkin)
     await db.commit()
+    if checkin.is_active:
+        await sync_checkins(left=[(checkin.user_id, checkin.place_id)])
+    await bump_versions(CHECKINS_SCOPE)
 
     return RedirectResponse(url="/admin/checkins", status_code=302)
 
@@ -443,6 +451,7 @@ async def admin_bounce_update(
     bounce.is_now = is_now
 
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE, bounce_scope(bounce_id))
 
     return RedirectResponse(url=f"/admin/bounces/{bounce_id}", status_code=302)
 
@@ -462,6 +471,7 @@ async def admin_bounce_delete(
 
     await db.delete(bounce)
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE, bounce_scope(bounce_id))
 
     return RedirectResponse(url="/admin/bounces", status_code=302)
 
@@ -571,7 +581,13 @@ async def admin_follow_delete(
     if not follow:
         raise HTTPException(status_code=404, detail="Follow not found")
 
-    await db.delete(follow)
+    follower_id, following_id = follow.follower_id, follow.following_id
+    await remove_follow(db, follow)
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(
+        user_scope(follower_id), user_scope(following_id),
+        close_friend_locations_scope(follower_id), close_friend_locations_scope(following_id)
+    )
 
     return RedirectResponse(url="/admin/follows", status_code=302)
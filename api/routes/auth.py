@@ -16,7 +16,9 @@ from services.auth_service import (
 )
 from services.apple_auth import verify_apple_token
 from core.config import settings
-from api.dependencies import limiter, get_current_user
+from api.dependencies import limiter, get_current_principal
+from services.principals import Principal, invalidate_principal
+from services.etag import bump_versions, user_scope
 import logging
 
 router = APIRouter(prefix="/auth", tags=["auth"])
@@ -98,6 +100,8 @@ async def apple_signin(
             if updated:
                 await db.commit()
                 await db.refresh(user)
+                await invalidate_principal(user.id)
+                await bump_versions(user_scope(user.id))
 
         # Create tokens
         access_token = create_access_token({"sub": str(user.id)})
@@ -184,7 +188,7 @@ async def passcode_auth(
 @limiter.limit("10/minute")
 async def logout(
     request: Request,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -3,19 +3,26 @@ import json
 import logging
 import hashlib
 import time
+from typing import Optional
 from fastapi import APIRouter, Depends, HTTPException, Request, WebSocket, WebSocketDisconnect, Query
-from fastapi.responses import HTMLResponse, Response
+from fastapi.responses import HTMLResponse, Response, StreamingResponse
 from sqlalchemy.ext.asyncio import AsyncSession
 from sqlalchemy import select
 
 from db.database import get_async_session, create_async_session
 from db.models import Bounce, BounceInvite, BounceLocationShare, BounceGuestLocation, User, Follow
 from sqlalchemy import func
-from api.dependencies import get_current_user
+from api.dependencies import get_current_principal, get_read_session
+from services.principals import Principal
 from api.routes.websocket import manager
 from api.routes.bounces import get_bounce_participants, get_venue_photo_url
-from core.config import settings
 from services.ai_commentator import get_or_create_commentator, remove_commentator
+from services.image_store import thumbnail_url
+from services.image_proxy import ImageProxyError, get_image, iter_file
+from services.etag import bounce_scope, get_versions, user_scope
+from services.share_page import (
+    ASSET_CACHE_CONTROL, CompressedBody, cache_page, get_asset, get_cached_page, get_share_page
+)
 
 router = APIRouter(tags=["bounce-share"])
 logger = logging.getLogger(__name__)
@@ -41,7 +48,7 @@ async def _is_participant(db: AsyncSession, bounce_id: int, user_id: int) -> boo
 async def create_share_link(
     bounce_id: int,
     request: Request,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Generate a shareable link for a bounce. Caller must be a participant."""
@@ -68,31 +75,29 @@ async def create_share_link(
 
 @router.get("/bounce/img-proxy")
 async def image_proxy(url: str = Query(...)):
-    """Proxy external images to avoid CORS/CORP blocks (e.g. Instagram CDN)."""
-    import httpx
+    """Proxy external images to avoid CORS/CORP blocks (e.g. Instagram CDN), cached on disk."""
     if not url.startswith("https://"):
         raise HTTPException(status_code=400, detail="Only HTTPS URLs allowed")
     try:
-        async with httpx.AsyncClient(follow_redirects=True, timeout=10) as client:
-            resp = await client.get(url)
-            if resp.status_code != 200:
-                raise HTTPException(status_code=502, detail="Upstream error")
-            content_type = resp.headers.get("content-type", "image/jpeg")
-            return Response(
-                content=resp.content,
-                media_type=content_type,
-                headers={"Cache-Control": "public, max-age=86400"}
-            )
-    except httpx.TimeoutException:
-        raise HTTPException(status_code=504, detail="Upstream timeout")
-    except Exception:
-        raise HTTPException(status_code=502, detail="Failed to fetch image")
+        image, f = await get_image(url)
+    except ImageProxyError as e:
+        raise HTTPException(status_code=e.status_code, detail=e.detail)
+
+    max_age = image.max_age
+    return StreamingResponse(
+        iter_file(f),
+        media_type=image.content_type,
+        headers={
+            "Content-Length": str(image.size),
+            "Cache-Control": f"public, max-age={max_age}" if max_age else "no-store",
+        }
+    )
 
 
 @router.get("/bounce/share/{share_token}/attendees")
 async def bounce_share_attendees(
     share_token: str,
-    db: AsyncSession = Depends(get_async_session)
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Return all attendees for a shared bounce: creator, invited users, and connected guests."""
     result = await db.execute(
@@ -108,7 +113,7 @@ async def bounce_share_attendees(
 
     attendees = []
     if creator:
-        pic = creator.profile_picture or creator.instagram_profile_pic or creator.profile_picture_1 or ""
+        pic = creator.profile_picture or creator.instagram_profile_pic or thumbnail_url(creator.profile_picture_1) or ""
         attendees.append({
             "type": "app",
             "user_id": creator.id,
@@ -126,7 +131,7 @@ async def bounce_share_attendees(
     for invite, user in result.all():
         if user.id == bounce.creator_id:
             continue
-        pic = user.profile_picture or user.instagram_profile_pic or user.profile_picture_1 or ""
+        pic = user.profile_picture or user.instagram_profile_pic or thumbnail_url(user.profile_picture_1) or ""
         attendees.append({
             "type": "app",
             "user_id": user.id,
@@ -154,7 +159,7 @@ async def bounce_share_attendees(
 async def bounce_share_user_profile(
     share_token: str,
     user_id: int,
-    db: AsyncSession = Depends(get_async_session)
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Public profile info for a user visible on the shared bounce map."""
     result = await db.execute(
@@ -175,7 +180,7 @@ async def bounce_share_user_profile(
         select(func.count()).select_from(Follow).where(Follow.follower_id == user_id)
     )).scalar() or 0
 
-    pic = user.profile_picture or user.instagram_profile_pic or user.profile_picture_1 or ""
+    pic = user.profile_picture or user.instagram_profile_pic or thumbnail_url(user.profile_picture_1) or ""
     return {
         "user_id": user.id,
         "nickname": user.nickname or user.first_name or "User",
@@ -191,7 +196,34 @@ async def bounce_share_page(
     request: Request,
     db: AsyncSession = Depends(get_async_session)
 ):
-    """Serve the web map page for a shared bounce."""
+    """
+    Serve the web map page for a shared bounce.
+
+    Reads from the primary: the version counters are bumped right after the
+    primary commits, so a replica read could be cached under newer versions.
+    """
+    # Derive WS base — respect X-Forwarded-Proto (Railway/proxies terminate TLS)
+    proto = request.headers.get("x-forwarded-proto", request.url.scheme)
+    host = request.headers.get("host") or request.base_url.hostname
+    ws_proto = "wss" if proto == "https" else "ws"
+    ws_base = f"{ws_proto}://{host}"
+
+    accept_encoding = request.headers.get("accept-encoding")
+    page_body = await get_cached_page(share_token, ws_base)
+    if page_body is not None:
+        return _compressed_response(page_body, accept_encoding, "text/html")
+
+    # Versions are read before the data the page is rendered from (see cache_page)
+    ids_result = await db.execute(
+        select(Bounce.id, Bounce.creator_id)
+        .where(Bounce.share_token == share_token, Bounce.status == 'active')
+    )
+    ids = ids_result.first()
+    if not ids:
+        raise HTTPException(status_code=404, detail="Bounce not found or no longer active")
+    scopes = [bounce_scope(ids.id), user_scope(ids.creator_id)]
+    versions = await get_versions(*scopes)
+
     result = await db.execute(
         select(Bounce, User)
         .join(User, Bounce.creator_id == User.id)
@@ -202,53 +234,59 @@ async def bounce_share_page(
         raise HTTPException(status_code=404, detail="Bounce not found or no longer active")
 
     bounce, creator = row
+    if (bounce.id, creator.id) != (ids.id, ids.creator_id):
+        # Changed hands between the two reads - serve it, don't cache it
+        versions = None
 
     # Fetch venue photo URL
     venue_photo_url = await get_venue_photo_url(db, bounce.places_fk_id) or ""
 
     # Creator profile picture
-    creator_pic = creator.profile_picture or creator.instagram_profile_pic or creator.profile_picture_1 or ""
-
-    # Read the template and partial sheets
-    import os
-    tpl_dir = os.path.join(os.path.dirname(__file__), "..", "..", "templates")
-    with open(os.path.join(tpl_dir, "bounce_share.html"), "r") as f:
-        html = f.read()
-    with open(os.path.join(tpl_dir, "venue_sheet.html"), "r") as f:
-        html = html.replace("{{VENUE_SHEET}}", f.read())
-    with open(os.path.join(tpl_dir, "user_sheet.html"), "r") as f:
-        html = html.replace("{{USER_SHEET}}", f.read())
-    with open(os.path.join(tpl_dir, "feed_item.html"), "r") as f:
-        feed_item_html = f.read()
-    with open(os.path.join(tpl_dir, "chat_panel.html"), "r") as f:
-        chat_panel_html = f.read().replace("{{FEED_ITEM}}", feed_item_html)
-    html = html.replace("{{CHAT_PANEL}}", chat_panel_html)
-
-    # Replace template placeholders
-    html = html.replace("{{VENUE_NAME}}", bounce.venue_name or "")
-    html = html.replace("{{VENUE_ADDRESS}}", bounce.venue_address or "")
-    html = html.replace("{{LATITUDE}}", str(bounce.latitude))
-    html = html.replace("{{LONGITUDE}}", str(bounce.longitude))
-    html = html.replace("{{MESSAGE}}", bounce.message or "")
-    html = html.replace("{{CREATOR_NAME}}", creator.nickname or creator.first_name or "Someone")
-    html = html.replace("{{SHARE_TOKEN}}", share_token)
-    html = html.replace("{{VENUE_PHOTO_URL}}", venue_photo_url)
-    html = html.replace("{{CREATOR_PROFILE_PIC}}", creator_pic)
-    html = html.replace("{{GOOGLE_MAPS_API_KEY}}", settings.GOOGLE_MAPS_API_KEY)
-
-    # Bounce timing
-    bounce_time_iso = bounce.bounce_time.isoformat() if bounce.bounce_time else ""
-    html = html.replace("{{BOUNCE_TIME}}", bounce_time_iso)
-    html = html.replace("{{IS_NOW}}", "true" if bounce.is_now else "false")
+    creator_pic = creator.profile_picture or creator.instagram_profile_pic or thumbnail_url(creator.profile_picture_1) or ""
+
+    html = get_share_page().render({
+        "VENUE_NAME": bounce.venue_name or "",
+        "VENUE_ADDRESS": bounce.venue_address or "",
+        "LATITUDE": str(bounce.latitude),
+        "LONGITUDE": str(bounce.longitude),
+        "MESSAGE": bounce.message or "",
+        "CREATOR_NAME": creator.nickname or creator.first_name or "Someone",
+        "SHARE_TOKEN": share_token,
+        "VENUE_PHOTO_URL": venue_photo_url,
+        "CREATOR_PROFILE_PIC": creator_pic,
+        "BOUNCE_TIME": bounce.bounce_time.isoformat() if bounce.bounce_time else "",
+        "IS_NOW": "true" if bounce.is_now else "false",
+        "WS_BASE": ws_base,
+    })
+    page_body = cache_page(share_token, ws_base, scopes, versions, html)
+    return _compressed_response(page_body, accept_encoding, "text/html")
+
+
+@router.get("/bounce/assets/{filename}")
+async def bounce_share_asset(filename: str, request: Request):
+    """Hashed, immutable CSS/JS split out of the share page"""
+    asset = get_asset(filename)
+    if asset is None:
+        raise HTTPException(status_code=404, detail="Asset not found")
+    return _compressed_response(
+        asset.body, request.headers.get("accept-encoding"), asset.content_type,
+        cache_control=ASSET_CACHE_CONTROL
+    )
 
-    # Derive WS base — respect X-Forwarded-Proto (Railway/proxies terminate TLS)
-    proto = request.headers.get("x-forwarded-proto", request.url.scheme)
-    host = request.headers.get("host") or request.base_url.hostname
-    ws_proto = "wss" if proto == "https" else "ws"
-    ws_base = f"{ws_proto}://{host}"
-    html = html.replace("{{WS_BASE}}", ws_base)
 
-    return HTMLResponse(content=html)
+def _compressed_response(
+    body: CompressedBody,
+    accept_encoding: Optional[str],
+    media_type: str,
+    cache_control: Optional[str] = None
+) -> Response:
+    content, encoding = body.select(accept_encoding)
+    headers = {"Vary": "Accept-Encoding"}
+    if encoding:
+        headers["Content-Encoding"] = encoding
+    if cache_control:
+        headers["Cache-Control"] = cache_control
+    return Response(content=content, media_type=media_type, headers=headers)
 
 
 @router.websocket("/ws/bounce/{share_token}")
@@ -570,7 +608,7 @@ async def _build_initial_state(db: AsyncSession, bounce_id: int) -> dict:
         app_users.append({
             "user_id": share.user_id,
             "nickname": user.nickname,
-            "profile_picture": user.profile_picture or user.instagram_profile_pic or user.profile_picture_1,
+            "profile_picture": user.profile_picture or user.instagram_profile_pic or thumbnail_url(user.profile_picture_1),
             "latitude": share.latitude,
             "longitude": share.longitude
         })
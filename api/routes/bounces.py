@@ -1,20 +1,23 @@
-from fastapi import APIRouter, Depends, HTTPException, status
+from fastapi import APIRouter, Depends, HTTPException, Request, Response, status
 from sqlalchemy.ext.asyncio import AsyncSession
 from sqlalchemy import select, desc, func, or_, and_
+from sqlalchemy.dialects.postgresql import insert as pg_insert
 from pydantic import BaseModel
 from typing import Optional, List
-from datetime import datetime, timezone, timedelta
+from datetime import datetime, timezone
 import logging
 
 from db.database import get_async_session
 from db.models import Bounce, BounceInvite, BounceAttendee, BounceLocationShare, BounceGuestLocation, User, Place, GooglePic
-from api.dependencies import get_current_user
+from api.dependencies import get_current_user, get_current_principal, get_read_session
+from services.principals import Principal
 from services.geofence import haversine_distance
 from services.places import get_place_with_photos
 from api.routes.websocket import manager
 from services.apns_service import NotificationPayload, NotificationType
 from services.cache import cache_get, cache_set, cache_delete
-from services.tasks import enqueue_notification, payload_to_dict
+from services.tasks import enqueue_notification_fanout, payload_to_dict
+from services.etag import not_modified, bump_versions, bounce_scope, round_coordinates, BOUNCES_SCOPE
 
 router = APIRouter(prefix="/bounces", tags=["bounces"])
 logger = logging.getLogger(__name__)
@@ -25,6 +28,39 @@ ATTENDEE_EXPIRY_MINUTES = 15
 BOUNCE_PROXIMITY_KM = 0.1  # 100 meters
 
 
+async def insert_invites(db: AsyncSession, bounce_id: int, user_ids: List[int], inviter_id: int) -> List[int]:
+    """
+    Bulk-insert invites in one statement, skipping the inviter and users already invited.
+    Returns the user IDs that were newly invited. Caller commits.
+    """
+    user_ids = [user_id for user_id in dict.fromkeys(user_ids) if user_id != inviter_id]
+    if not user_ids:
+        return []
+    result = await db.execute(
+        pg_insert(BounceInvite)
+        .values([{"bounce_id": bounce_id, "user_id": user_id} for user_id in user_ids])
+        .on_conflict_do_nothing(constraint="uq_bounce_invite_user")
+        .returning(BounceInvite.user_id)
+    )
+    return [row[0] for row in result.all()]
+
+
+def invite_payload(inviter: User | Principal, profile_picture: Optional[str], bounce: Bounce) -> dict:
+    """Serialized BOUNCE_INVITE notification from inviter for bounce"""
+    payload = NotificationPayload(
+        notification_type=NotificationType.BOUNCE_INVITE,
+        title="Bounce Invite",
+        body=f"{inviter.nickname or inviter.first_name} invited you to bounce at {bounce.venue_name}",
+        actor_id=inviter.id,
+        actor_nickname=inviter.nickname or inviter.first_name or "Someone",
+        actor_profile_picture=profile_picture,
+        bounce_id=bounce.id,
+        bounce_venue_name=bounce.venue_name,
+        bounce_place_id=bounce.place_id
+    )
+    return payload_to_dict(payload)
+
+
 async def get_venue_photo_url(db: AsyncSession, places_fk_id: Optional[int]) -> Optional[str]:
     """Get the first photo URL for a venue from GooglePic table."""
     if not places_fk_id:
@@ -58,19 +94,15 @@ async def get_active_attendees(
     include_details: bool = True
 ) -> tuple[int, List["AttendeeInfo"]]:
     """
-    Get active attendees for a bounce (seen within last 15 minutes).
+    Get active attendees for a bounce. Rows not seen for ATTENDEE_EXPIRY_MINUTES
+    are deleted by the expiry reaper (services/reaper.py), so no time filter here.
     Returns (count, attendee_list).
     """
-    expiry_time = datetime.now(timezone.utc) - timedelta(minutes=ATTENDEE_EXPIRY_MINUTES)
-
     if include_details:
         stmt = (
             select(BounceAttendee, User)
             .join(User, BounceAttendee.user_id == User.id)
-            .where(
-                BounceAttendee.bounce_id == bounce_id,
-                BounceAttendee.last_seen_at >= expiry_time
-            )
+            .where(BounceAttendee.bounce_id == bounce_id)
             .order_by(BounceAttendee.joined_at.asc())
         )
         result = await db.execute(stmt)
@@ -89,10 +121,7 @@ async def get_active_attendees(
     else:
         stmt = (
             select(func.count(BounceAttendee.id))
-            .where(
-                BounceAttendee.bounce_id == bounce_id,
-                BounceAttendee.last_seen_at >= expiry_time
-            )
+            .where(BounceAttendee.bounce_id == bounce_id)
         )
         result = await db.execute(stmt)
         count = result.scalar() or 0
@@ -222,15 +251,13 @@ async def create_bounce(
         await db.flush()  # Get the bounce ID
 
         # Add invites if provided
-        invite_count = 0
-        if bounce_data.invite_user_ids:
-            for user_id in bounce_data.invite_user_ids:
-                if user_id != current_user.id:  # Don't invite yourself
-                    invite = BounceInvite(bounce_id=bounce.id, user_id=user_id)
-                    db.add(invite)
-                    invite_count += 1
+        invited_ids = await insert_invites(
+            db, bounce.id, bounce_data.invite_user_ids or [], current_user.id
+        )
+        invite_count = len(invited_ids)
 
         await db.commit()
+        await bump_versions(BOUNCES_SCOPE)
         await db.refresh(bounce)
 
         logger.info(
@@ -251,7 +278,6 @@ async def create_bounce(
         )
 
         # Broadcast via WebSocket
-        invited_ids = bounce_data.invite_user_ids or []
         ws_message = {
             "type": "new_bounce",
             "bounce": bounce_response.model_dump(mode='json'),
@@ -271,28 +297,10 @@ async def create_bounce(
                         except Exception:
                             pass
 
-        # Send notifications to invited users
-        from services.tasks import send_websocket_notification
-
-        for user_id in invited_ids:
-            payload = NotificationPayload(
-                notification_type=NotificationType.BOUNCE_INVITE,
-                title="Bounce Invite",
-                body=f"{current_user.nickname or current_user.first_name} invited you to bounce at {bounce.venue_name}",
-                actor_id=current_user.id,
-                actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-                actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
-                bounce_id=bounce.id,
-                bounce_venue_name=bounce.venue_name,
-                bounce_place_id=bounce.place_id
-            )
-            payload_dict = payload_to_dict(payload)
-
-            # Send WebSocket notification for in-app display (immediate)
-            await send_websocket_notification(user_id, payload_dict)
-
-            # Queue push notification (background)
-            enqueue_notification(user_id, payload_dict)
+        # Notify invited users (WebSocket + push) in the background
+        enqueue_notification_fanout(invited_ids, invite_payload(
+            current_user, current_user.profile_picture or current_user.instagram_profile_pic, bounce
+        ))
 
         return bounce_response
 
@@ -308,8 +316,8 @@ async def create_bounce(
 @router.get("/", response_model=List[BounceResponse])
 async def get_bounces(
     status_filter: Optional[str] = "active",
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get bounces: ones I created + ones I'm invited to + public ones"""
 
@@ -363,10 +371,12 @@ async def get_bounces(
 
 @router.get("/map", response_model=List[BounceResponse])
 async def get_map_bounces(
+    request: Request,
+    response: Response,
     lat: float,
     lng: float,
     radius: float = 50.0,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -382,6 +392,11 @@ async def get_map_bounces(
         lng: User's longitude
         radius: Search radius in km for public bounces (default 50km)
     """
+    lat, lng = round_coordinates(lat, lng)
+    cached = await not_modified(request, response, [BOUNCES_SCOPE], current_user.id, lat, lng, radius)
+    if cached:
+        return cached
+
     now = datetime.now(timezone.utc)
 
     invite_count_subq = (
@@ -461,8 +476,8 @@ async def get_map_bounces(
 
 @router.get("/mine", response_model=List[BounceResponse])
 async def get_my_bounces(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get bounces created by the current user"""
     invite_count_subq = (
@@ -497,8 +512,8 @@ async def get_my_bounces(
 
 @router.get("/invited", response_model=List[BounceResponse])
 async def get_invited_bounces(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get bounces the current user is invited to"""
     invite_count_subq = (
@@ -538,8 +553,8 @@ async def get_invited_bounces(
 @router.get("/shared/{user_id}", response_model=List[BounceResponse])
 async def get_shared_bounces(
     user_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get bounces shared between current user and another user.
@@ -612,10 +627,12 @@ async def get_shared_bounces(
 
 @router.get("/public", response_model=List[BounceResponse])
 async def get_public_bounces(
+    request: Request,
+    response: Response,
     lat: float,
     lng: float,
     radius: float = 10.0,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -626,6 +643,12 @@ async def get_public_bounces(
         lng: User's longitude
         radius: Search radius in km (default 10km)
     """
+    lat, lng = round_coordinates(lat, lng)
+    # Short time bucket: bounces drop out as their bounce_time passes, without a write
+    cached = await not_modified(request, response, [BOUNCES_SCOPE], lat, lng, radius, bucket_seconds=60)
+    if cached:
+        return cached
+
     now = datetime.now(timezone.utc)
 
     invite_count_subq = (
@@ -670,8 +693,8 @@ async def get_public_bounces(
 @router.get("/{bounce_id}", response_model=BounceResponse)
 async def get_bounce(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get a single bounce by ID"""
 
@@ -717,7 +740,7 @@ async def get_bounce(
 @router.delete("/{bounce_id}", status_code=status.HTTP_204_NO_CONTENT)
 async def delete_bounce(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Delete a bounce (creator only)"""
@@ -750,6 +773,7 @@ async def delete_bounce(
 
     await db.delete(bounce)
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE, bounce_scope(bounce_id))
 
     logger.info(f"Bounce {bounce_id} deleted by user {current_user.id}")
 
@@ -771,7 +795,7 @@ async def delete_bounce(
 async def invite_to_bounce(
     bounce_id: int,
     invite_data: InviteRequest,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Invite users to a bounce (creator only)"""
@@ -787,56 +811,30 @@ async def invite_to_bounce(
     if bounce.creator_id != current_user.id:
         raise HTTPException(status_code=403, detail="Only the creator can invite to this bounce")
 
-    # Get existing invites
-    existing_result = await db.execute(
-        select(BounceInvite.user_id).where(BounceInvite.bounce_id == bounce_id)
+    newly_invited = await insert_invites(db, bounce_id, invite_data.user_ids, current_user.id)
+    added = len(newly_invited)
+
+    total_result = await db.execute(
+        select(func.count(BounceInvite.id)).where(BounceInvite.bounce_id == bounce_id)
     )
-    existing_user_ids = {row[0] for row in existing_result.all()}
-
-    # Add new invites
-    added = 0
-    newly_invited = []
-    for user_id in invite_data.user_ids:
-        if user_id not in existing_user_ids and user_id != current_user.id:
-            invite = BounceInvite(bounce_id=bounce_id, user_id=user_id)
-            db.add(invite)
-            added += 1
-            newly_invited.append(user_id)
+    total = total_result.scalar() or 0
 
     await db.commit()
+    if newly_invited:
+        await bump_versions(BOUNCES_SCOPE)
 
     logger.info(f"Added {added} invites to bounce {bounce_id}")
 
-    # Send notifications to newly invited users
-    from services.tasks import send_websocket_notification
-
-    for user_id in newly_invited:
-        payload = NotificationPayload(
-            notification_type=NotificationType.BOUNCE_INVITE,
-            title="Bounce Invite",
-            body=f"{current_user.nickname or current_user.first_name} invited you to bounce at {bounce.venue_name}",
-            actor_id=current_user.id,
-            actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
-            bounce_id=bounce.id,
-            bounce_venue_name=bounce.venue_name,
-            bounce_place_id=bounce.place_id
-        )
-        payload_dict = payload_to_dict(payload)
+    # Notify newly invited users (WebSocket + push) in the background
+    enqueue_notification_fanout(newly_invited, invite_payload(current_user, current_user.avatar_url, bounce))
 
-        # Send WebSocket notification for in-app display (immediate)
-        await send_websocket_notification(user_id, payload_dict)
-
-        # Queue push notification (background)
-        enqueue_notification(user_id, payload_dict)
-
-    return {"added": added, "total": len(existing_user_ids) + added}
+    return {"added": added, "total": total}
 
 
 @router.post("/{bounce_id}/accept")
 async def accept_bounce_invite(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -872,30 +870,28 @@ async def accept_bounce_invite(
 
     invite.status = "accepted"
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE)
 
     logger.info(f"Invite accepted: bounce {bounce_id}, user {current_user.id}")
 
-    # Notify all participants (push + in-app)
-    from services.tasks import send_websocket_notification
+    # Notify all participants (push + in-app) in the background
     actor_name = current_user.nickname or current_user.first_name or "Someone"
     participants = await get_bounce_participants(db, bounce_id)
-    for pid in participants:
-        if pid == current_user.id:
-            continue
-        payload = NotificationPayload(
-            notification_type=NotificationType.BOUNCE_ACCEPTED,
-            title="Bounce Accepted",
-            body=f"{actor_name} is coming to {bounce.venue_name}",
-            actor_id=current_user.id,
-            actor_nickname=actor_name,
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
-            bounce_id=bounce.id,
-            bounce_venue_name=bounce.venue_name,
-            bounce_place_id=bounce.place_id
-        )
-        payload_dict = payload_to_dict(payload)
-        await send_websocket_notification(pid, payload_dict)
-        enqueue_notification(pid, payload_dict)
+    payload = NotificationPayload(
+        notification_type=NotificationType.BOUNCE_ACCEPTED,
+        title="Bounce Accepted",
+        body=f"{actor_name} is coming to {bounce.venue_name}",
+        actor_id=current_user.id,
+        actor_nickname=actor_name,
+        actor_profile_picture=current_user.avatar_url,
+        bounce_id=bounce.id,
+        bounce_venue_name=bounce.venue_name,
+        bounce_place_id=bounce.place_id
+    )
+    enqueue_notification_fanout(
+        [pid for pid in participants if pid != current_user.id],
+        payload_to_dict(payload)
+    )
 
     return {"success": True, "message": "Invite accepted"}
 
@@ -903,7 +899,7 @@ async def accept_bounce_invite(
 @router.post("/{bounce_id}/decline")
 async def decline_bounce_invite(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -936,6 +932,7 @@ async def decline_bounce_invite(
 
     invite.status = "declined"
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE)
 
     logger.info(f"Invite declined: bounce {bounce_id}, user {current_user.id}")
 
@@ -959,7 +956,7 @@ async def decline_bounce_invite(
 async def remove_invite(
     bounce_id: int,
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -995,6 +992,7 @@ async def remove_invite(
 
     await db.delete(invite)
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE)
 
     logger.info(f"Invite removed: bounce {bounce_id}, user {user_id}, by {current_user.id}")
 
@@ -1025,15 +1023,11 @@ class InvitedUserInfo(BaseModel):
     is_checked_in: bool = False
 
 
-# Constants for check-in status
-CHECKIN_EXPIRY_HOURS = 24
-
-
 @router.get("/{bounce_id}/invites")
 async def get_bounce_invites(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get list of users invited to a bounce.
@@ -1083,13 +1077,11 @@ async def get_bounce_invites(
     # Get users checked in at the bounce's venue (if place_id exists)
     checked_in_user_ids = set()
     if bounce.place_id:
-        expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
         checkin_result = await db.execute(
             select(CheckIn.user_id).where(
                 and_(
                     CheckIn.place_id == bounce.place_id,
-                    CheckIn.is_active == True,
-                    CheckIn.last_seen_at >= expiry_time
+                    CheckIn.is_active == True
                 )
             )
         )
@@ -1119,7 +1111,7 @@ async def get_bounce_invites(
 @router.post("/{bounce_id}/archive", response_model=BounceResponse)
 async def archive_bounce(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Archive a bounce (creator only)"""
@@ -1141,6 +1133,7 @@ async def archive_bounce(
 
     bounce.status = 'archived'
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE, bounce_scope(bounce_id))
     await db.refresh(bounce)
 
     # Get invite count
@@ -1182,8 +1175,8 @@ class NearbyBouncesResponse(BaseModel):
 async def get_nearby_bounces(
     lat: float,
     lng: float,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get public 'now' bounces within check-in proximity.
@@ -1194,13 +1187,10 @@ async def get_nearby_bounces(
     - nearby_bounces: list of bounces within proximity that user can check into
     """
     # Check if user is already checked into a bounce
-    expiry_time = datetime.now(timezone.utc) - timedelta(minutes=ATTENDEE_EXPIRY_MINUTES)
     current_checkin_result = await db.execute(
         select(BounceAttendee.bounce_id)
-        .where(
-            BounceAttendee.user_id == current_user.id,
-            BounceAttendee.last_seen_at >= expiry_time
-        )
+        .where(BounceAttendee.user_id == current_user.id)
+        .limit(1)
     )
     current_checkin = current_checkin_result.scalar_one_or_none()
 
@@ -1249,7 +1239,7 @@ async def checkin_to_bounce(
     bounce_id: int,
     lat: float,
     lng: float,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -1331,6 +1321,8 @@ async def checkin_to_bounce(
         db.add(attendee)
 
     await db.commit()
+    if previous_bounce_id or not current_attendee:
+        await bump_versions(BOUNCES_SCOPE)
 
     # Broadcast update for previous bounce if user switched
     if previous_bounce_id:
@@ -1367,7 +1359,7 @@ async def checkin_to_bounce(
 @router.post("/{bounce_id}/leave")
 async def leave_bounce(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -1401,6 +1393,7 @@ async def leave_bounce(
         await db.delete(invite)
 
     await db.commit()
+    await bump_versions(BOUNCES_SCOPE)
 
     # Get updated attendee count
     count, attendees = await get_active_attendees(db, bounce_id, include_details=True)
@@ -1420,22 +1413,17 @@ async def leave_bounce(
 
 @router.get("/my-checkin")
 async def get_my_checkin(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get the bounce the current user is checked into (if any).
     """
-    expiry_time = datetime.now(timezone.utc) - timedelta(minutes=ATTENDEE_EXPIRY_MINUTES)
-
     result = await db.execute(
         select(BounceAttendee, Bounce, User)
         .join(Bounce, BounceAttendee.bounce_id == Bounce.id)
         .join(User, Bounce.creator_id == User.id)
-        .where(
-            BounceAttendee.user_id == current_user.id,
-            BounceAttendee.last_seen_at >= expiry_time
-        )
+        .where(BounceAttendee.user_id == current_user.id)
     )
     row = result.first()
 
@@ -1464,8 +1452,8 @@ async def get_my_checkin(
 @router.get("/{bounce_id}/attendees")
 async def get_bounce_attendees(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get list of current attendees at a public now bounce.
@@ -1588,7 +1576,7 @@ async def is_bounce_participant(db: AsyncSession, bounce_id: int, user_id: int)
 async def toggle_location_sharing(
     bounce_id: int,
     toggle: LocationSharingToggle,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Toggle location sharing on/off for a bounce"""
@@ -1667,7 +1655,7 @@ async def toggle_location_sharing(
 async def update_location(
     bounce_id: int,
     location: LocationUpdate,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Update current user's location and broadcast to other participants"""
@@ -1700,7 +1688,7 @@ async def update_location(
         "bounce_id": bounce_id,
         "user_id": current_user.id,
         "nickname": current_user.nickname,
-        "profile_picture": current_user.profile_picture or current_user.instagram_profile_pic or current_user.profile_picture_1,
+        "profile_picture": current_user.avatar_url,
         "latitude": location.latitude,
         "longitude": location.longitude
     }
@@ -1718,8 +1706,8 @@ async def update_location(
 @router.get("/{bounce_id}/locations", response_model=LocationsResponse)
 async def get_shared_locations(
     bounce_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get all users currently sharing their location for this bounce"""
     # Check if user can participate
@@ -1,20 +1,25 @@
-from fastapi import APIRouter, Depends, HTTPException
+from fastapi import APIRouter, Depends, HTTPException, Request, Response
 from sqlalchemy.ext.asyncio import AsyncSession
-from sqlalchemy import select, desc, and_, func
+from sqlalchemy import select, desc, and_, or_, func, tuple_, text
 from pydantic import BaseModel
 from typing import List, Optional
-from datetime import datetime, timezone, timedelta
+from datetime import datetime, timedelta, timezone
+import base64
 from math import radians, sin, cos, sqrt, atan2
 
-from db.database import get_async_session
+from db.database import get_async_session, get_session_maker
 from db.models import CheckIn, CheckInHistory, User, Place, Bounce, Follow
-from api.dependencies import get_current_user
+from api.dependencies import get_current_user, get_current_principal, get_read_session
+from services.principals import Principal
 from services.geofence import is_in_basel_area
 from services.places.service import get_place_with_photos
+from services.places.autocomplete import increment_checkin_count
+from services.follow_graph import checkin_recipients, followers_at_place, sync_checkins
 from api.routes.websocket import manager
 from services.apns_service import NotificationPayload, NotificationType
-from services.cache import cache_get, cache_set, cache_delete
-from services.tasks import enqueue_notification, payload_to_dict
+from services.cache import cache_get_or_load, cache_delete
+from services.tasks import enqueue_notification, enqueue_notifications_bulk, payload_to_dict
+from services.etag import not_modified, bump_versions, bump_close_friend_viewers, round_coordinates, CHECKINS_SCOPE
 import logging
 
 logger = logging.getLogger(__name__)
@@ -33,7 +38,7 @@ async def move_checkin_to_history(db: AsyncSession, checkin: CheckIn) -> None:
         user_id=checkin.user_id,
         place_id=checkin.place_id,
         places_fk_id=checkin.places_fk_id,
-        venue_name=checkin.location_name,
+        venue_name=checkin.location_name or "",
         venue_address=None,
         latitude=checkin.latitude,
         longitude=checkin.longitude,
@@ -45,6 +50,126 @@ async def move_checkin_to_history(db: AsyncSession, checkin: CheckIn) -> None:
     await db.delete(checkin)
 
 
+# Closes the user's check-ins elsewhere (and an expired one at :place_id) into
+# history, then refreshes the unexpired active check-in at :place_id or inserts
+# one, returning the check-in and the place IDs that were closed - one statement
+# instead of a round trip per step.
+CHECKIN_TRANSITION_SQL = text("""
+    WITH closed AS (
+        DELETE FROM check_ins
+        WHERE user_id = :user_id
+          AND is_active = true
+          AND (place_id IS DISTINCT FROM :place_id
+               OR last_seen_at IS NULL
+               OR last_seen_at < :expires_before)
+        RETURNING user_id, place_id, places_fk_id, location_name, latitude, longitude, created_at
+    ), archived AS (
+        INSERT INTO check_in_history (
+            user_id, place_id, places_fk_id, venue_name, venue_address,
+            latitude, longitude, checked_in_at, checked_out_at
+        )
+        SELECT user_id, place_id, places_fk_id, COALESCE(location_name, ''), NULL,
+               latitude, longitude, created_at, CAST(:now AS timestamptz)
+        FROM closed
+        WHERE place_id IS NOT NULL
+    ), refreshed AS (
+        UPDATE check_ins
+        SET last_seen_at = :now, latitude = :latitude, longitude = :longitude
+        WHERE user_id = :user_id AND place_id = :place_id AND is_active = true
+          AND last_seen_at >= :expires_before
+        RETURNING id, created_at
+    ), inserted AS (
+        INSERT INTO check_ins (
+            user_id, latitude, longitude, location_name, place_id, places_fk_id,
+            created_at, last_seen_at, is_active
+        )
+        SELECT CAST(:user_id AS integer), CAST(:latitude AS double precision),
+               CAST(:longitude AS double precision), CAST(:location_name AS varchar),
+               CAST(:place_id AS varchar), CAST(:places_fk_id AS integer),
+               CAST(:now AS timestamptz), CAST(:now AS timestamptz), true
+        WHERE NOT EXISTS (SELECT 1 FROM refreshed)
+        RETURNING id, created_at
+    ), checkin AS (
+        SELECT id, created_at, false AS is_new FROM refreshed
+        UNION ALL
+        SELECT id, created_at, true AS is_new FROM inserted
+    )
+    SELECT checkin.id, checkin.created_at, checkin.is_new,
+           ARRAY(SELECT DISTINCT place_id FROM closed WHERE place_id IS NOT NULL) AS previous_place_ids
+    FROM checkin
+    LIMIT 1
+""")
+
+
+async def transition_checkin(
+    db: AsyncSession,
+    user_id: int,
+    place: Place,
+    latitude: float,
+    longitude: float
+):
+    """
+    Make place the user's only active check-in. Commits.
+    Returns a row of (id, created_at, is_new, previous_place_ids).
+    """
+    now = datetime.now(timezone.utc)
+    result = await db.execute(CHECKIN_TRANSITION_SQL, {
+        "user_id": user_id,
+        "place_id": place.place_id,
+        "places_fk_id": place.id,
+        "location_name": place.name,
+        "latitude": latitude,
+        "longitude": longitude,
+        "now": now,
+        "expires_before": now - timedelta(hours=CHECKIN_EXPIRY_HOURS),
+    })
+    row = result.one()
+    await db.commit()
+    return row
+
+
+async def get_checkin_recipients(
+    db: AsyncSession,
+    user_id: int,
+    place_id: str
+) -> tuple[List[int], List[int]]:
+    """
+    Followers to notify about a check-in, from the follow graph or in one query.
+    Returns (followers checked in at the same venue, followers who marked user a close friend).
+    """
+    recipients = await checkin_recipients(user_id, place_id)
+    if recipients is not None:
+        return recipients
+
+    at_venue = (
+        select(CheckIn.id)
+        .where(
+            CheckIn.user_id == Follow.follower_id,
+            CheckIn.place_id == place_id,
+            CheckIn.is_active == True
+        )
+        .exists()
+    )
+    # Same close friend definition as the graph's close_friend_of set
+    is_close_friend = Follow.close_friend_status == 'accepted'
+    result = await db.execute(
+        select(Follow.follower_id, is_close_friend.label("is_close_friend"), at_venue.label("at_venue"))
+        .where(
+            Follow.following_id == user_id,
+            Follow.follower_id != user_id,
+            or_(is_close_friend, at_venue)
+        )
+    )
+
+    same_venue_ids, close_friend_ids = [], []
+    for follower_id, is_close_friend, is_at_venue in result.all():
+        if is_at_venue:
+            same_venue_ids.append(follower_id)
+        if is_close_friend:
+            close_friend_ids.append(follower_id)
+    return same_venue_ids, close_friend_ids
+
+
 def haversine_distance(lat1: float, lng1: float, lat2: float, lng2: float) -> float:
     """Calculate distance between two points in meters using Haversine formula."""
     R = 6371000  # Earth's radius in meters
@@ -100,6 +225,7 @@ async def create_checkin(
     db.add(checkin)
     await db.commit()
     await db.refresh(checkin)
+    await bump_versions(CHECKINS_SCOPE)
 
     return CheckInResponse(
         id=checkin.id,
@@ -115,8 +241,8 @@ async def create_checkin(
 @router.get("/recent", response_model=List[CheckInResponse])
 async def get_recent_checkins(
     limit: int = 50,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get recent check-ins"""
     result = await db.execute(
@@ -207,6 +333,8 @@ class VenuesWithCheckInsResponse(BaseModel):
 
 @router.get("/area", response_model=VenuesWithCheckInsResponse)
 async def get_venues_with_checkins_in_area(
+    request: Request,
+    response: Response,
     lat: float,
     lng: float,
     radius: float = 5000,
@@ -216,9 +344,12 @@ async def get_venues_with_checkins_in_area(
     Get all venues with active check-ins within a radius.
     Returns venues with their check-in counts for map display.
     """
-    from db.models import GooglePic
+    lat, lng = round_coordinates(lat, lng)
+    cached = await not_modified(request, response, [CHECKINS_SCOPE], lat, lng, radius)
+    if cached:
+        return cached
 
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
+    from db.models import GooglePic
 
     # Get all active check-ins grouped by place_id
     # Note: latitude/longitude in CheckIn are USER locations, not venue locations
@@ -231,7 +362,6 @@ async def get_venues_with_checkins_in_area(
         .where(
             and_(
                 CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time,
                 CheckIn.place_id.isnot(None)
             )
         )
@@ -279,7 +409,7 @@ async def get_venues_with_checkins_in_area(
 async def checkin_to_venue(
     place_id: str,
     checkin_data: VenueCheckInCreate,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -311,75 +441,37 @@ async def checkin_to_venue(
             detail=f"You must be within {CHECKIN_PROXIMITY_METERS}m of the venue to check in. You are {int(distance)}m away."
         )
 
-    # Check for existing active check-in at this venue
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
-    existing_checkin = await db.execute(
-        select(CheckIn).where(
-            and_(
-                CheckIn.user_id == current_user.id,
-                CheckIn.place_id == place_id,
-                CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time
-            )
-        )
+    checkin = await transition_checkin(
+        db, current_user.id, place, checkin_data.latitude, checkin_data.longitude
     )
-    existing = existing_checkin.scalar_one_or_none()
-
-    if existing:
-        # Update last_seen_at to refresh the check-in
-        existing.last_seen_at = datetime.now(timezone.utc)
-        existing.latitude = checkin_data.latitude
-        existing.longitude = checkin_data.longitude
-        await db.commit()
-        await db.refresh(existing)
 
+    # Invalidate venue count caches for any venue just left, and the new one if joined
+    changed_place_ids = set(checkin.previous_place_ids)
+    if checkin.is_new:
+        changed_place_ids.add(place_id)
+    await sync_checkins(
+        joined=[(current_user.id, place_id)] if checkin.is_new else [],
+        left=[(current_user.id, previous_place_id) for previous_place_id in checkin.previous_place_ids]
+    )
+    for changed_place_id in changed_place_ids:
+        await cache_delete(f"venue_count:{changed_place_id}")
+    if changed_place_ids:
+        await bump_versions(CHECKINS_SCOPE)
+        await bump_close_friend_viewers(db, [current_user.id])
+    if checkin.is_new:
+        await increment_checkin_count(place_id)
+
+    # Already checked in here - the check-in was just refreshed
+    if not checkin.is_new:
         return VenueCheckInResponse(
-            id=existing.id,
-            user_id=existing.user_id,
+            id=checkin.id,
+            user_id=current_user.id,
             place_id=place_id,
             venue_name=place.name,
-            checked_in_at=existing.created_at,
-            is_active=existing.is_active
+            checked_in_at=checkin.created_at,
+            is_active=True
         )
 
-    # Move any other active check-ins for this user to history (user can only be at one place)
-    result = await db.execute(
-        select(CheckIn).where(
-            and_(
-                CheckIn.user_id == current_user.id,
-                CheckIn.is_active == True
-            )
-        )
-    )
-    old_place_ids = []
-    for old_checkin in result.scalars().all():
-        if old_checkin.place_id:
-            old_place_ids.append(old_checkin.place_id)
-        # Move to history and delete
-        await move_checkin_to_history(db, old_checkin)
-
-    # Invalidate cache for old venues
-    for old_place_id in old_place_ids:
-        await cache_delete(f"venue_count:{old_place_id}")
-
-    # Create new check-in
-    checkin = CheckIn(
-        user_id=current_user.id,
-        latitude=checkin_data.latitude,
-        longitude=checkin_data.longitude,
-        location_name=place.name,
-        place_id=place_id,
-        places_fk_id=place.id,
-        last_seen_at=datetime.now(timezone.utc),
-        is_active=True
-    )
-    db.add(checkin)
-    await db.commit()
-    await db.refresh(checkin)
-
-    # Invalidate venue count cache
-    await cache_delete(f"venue_count:{place_id}")
-
     # Broadcast check-in to all connected clients
     await manager.broadcast({
         "type": "venue_checkin",
@@ -392,121 +484,72 @@ async def checkin_to_venue(
         "timestamp": datetime.now(timezone.utc).isoformat()
     })
 
-    # Send notifications to users at the same venue who follow the current user
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
-
-    # Get users who are checked into the same venue AND follow the current user
-    same_venue_followers_result = await db.execute(
-        select(User, CheckIn).join(
-            CheckIn, CheckIn.user_id == User.id
-        ).join(
-            Follow, and_(
-                Follow.follower_id == User.id,
-                Follow.following_id == current_user.id
-            )
-        ).where(
-            and_(
-                CheckIn.place_id == place_id,
-                CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time,
-                User.id != current_user.id
-            )
-        )
-    )
+    # Notify followers at the same venue and followers who marked the current user a close friend
+    same_venue_ids, close_friend_ids = await get_checkin_recipients(db, current_user.id, place_id)
 
     # Send notifications (WebSocket + push)
     from services.tasks import send_websocket_notification
 
-    # Notify users at the same venue
-    for user, _ in same_venue_followers_result.all():
-        payload = NotificationPayload(
-            notification_type=NotificationType.FRIEND_AT_VENUE,
-            title="Friend Arrived",
-            body=f"{current_user.nickname} just arrived at {place.name}",
-            actor_id=current_user.id,
-            actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
-            venue_place_id=place_id,
-            venue_name=place.name,
-            venue_latitude=place.latitude,
-            venue_longitude=place.longitude
-        )
-        payload_dict = payload_to_dict(payload)
-        await send_websocket_notification(user.id, payload_dict)
-        enqueue_notification(user.id, payload_dict)
-        logger.info(f"Sent friend_at_venue notification for user {user.id}")
-
-    # Notify users who have the current user marked as a close friend
-    close_friend_followers_result = await db.execute(
-        select(User).join(
-            Follow, and_(
-                Follow.follower_id == User.id,
-                Follow.following_id == current_user.id,
-                Follow.is_close_friend == True
-            )
-        ).where(User.id != current_user.id)
-    )
-
-    for user in close_friend_followers_result.scalars().all():
+    notifications = [
+        (same_venue_ids, NotificationType.FRIEND_AT_VENUE, "Friend Arrived",
+         f"{current_user.nickname} just arrived at {place.name}"),
+        (close_friend_ids, NotificationType.CLOSE_FRIEND_CHECKIN, "Close Friend Check-in",
+         f"{current_user.nickname} checked into {place.name}"),
+    ]
+    for recipient_ids, notification_type, title, body in notifications:
+        if not recipient_ids:
+            continue
         payload = NotificationPayload(
-            notification_type=NotificationType.CLOSE_FRIEND_CHECKIN,
-            title="Close Friend Check-in",
-            body=f"{current_user.nickname} checked into {place.name}",
+            notification_type=notification_type,
+            title=title,
+            body=body,
             actor_id=current_user.id,
             actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
+            actor_profile_picture=current_user.avatar_url,
             venue_place_id=place_id,
             venue_name=place.name,
             venue_latitude=place.latitude,
             venue_longitude=place.longitude
         )
         payload_dict = payload_to_dict(payload)
-        await send_websocket_notification(user.id, payload_dict)
-        enqueue_notification(user.id, payload_dict)
-        logger.info(f"Sent close_friend_checkin notification for user {user.id}")
+        for recipient_id in recipient_ids:
+            await send_websocket_notification(recipient_id, payload_dict)
+        enqueue_notifications_bulk(recipient_ids, payload_dict)
+        logger.info(f"Sent {notification_type.value} notification to {len(recipient_ids)} user(s)")
 
     return VenueCheckInResponse(
         id=checkin.id,
-        user_id=checkin.user_id,
+        user_id=current_user.id,
         place_id=place_id,
         venue_name=place.name,
         checked_in_at=checkin.created_at,
-        is_active=checkin.is_active
+        is_active=True
     )
 
 
 @router.get("/venue/{place_id}/count", response_model=VenueCheckInCountResponse)
 async def get_venue_checkin_count(
-    place_id: str,
-    db: AsyncSession = Depends(get_async_session)
+    place_id: str
 ):
     """
     Get count of people checked in at venue (public, no auth required).
     """
-    cache_key = f"venue_count:{place_id}"
-    cached_count = await cache_get(cache_key)
-
-    if cached_count is not None:
-        return VenueCheckInCountResponse(
-            place_id=place_id,
-            count=cached_count
-        )
-
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
-
-    result = await db.execute(
-        select(func.count(CheckIn.id)).where(
-            and_(
-                CheckIn.place_id == place_id,
-                CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time
+    # Shared by concurrent requests and may outlive this one - own session, on the
+    # primary because check-in writes delete this key and the next load must see them
+    async def count_checkins() -> int:
+        async with get_session_maker()() as db:
+            result = await db.execute(
+                select(func.count(CheckIn.id)).where(
+                    and_(
+                        CheckIn.place_id == place_id,
+                        CheckIn.is_active == True
+                    )
+                )
             )
-        )
-    )
-    count = result.scalar() or 0
+            return result.scalar() or 0
 
-    # Cache for 2 minutes
-    await cache_set(cache_key, count, ttl=120)
+    # Cached for 2 minutes; concurrent misses share one COUNT
+    count = await cache_get_or_load(f"venue_count:{place_id}", count_checkins, ttl=120)
 
     return VenueCheckInCountResponse(
         place_id=place_id,
@@ -517,23 +560,20 @@ async def get_venue_checkin_count(
 @router.get("/venue/{place_id}/attendees", response_model=VenueAttendeesResponse)
 async def get_venue_attendees(
     place_id: str,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get list of people checked in at venue.
     Returns attendee details only if user is part of an active bounce at this venue.
     Otherwise, returns just the count.
     """
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
-
     # Get count of active check-ins
     count_result = await db.execute(
         select(func.count(CheckIn.id)).where(
             and_(
                 CheckIn.place_id == place_id,
-                CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time
+                CheckIn.is_active == True
             )
         )
     )
@@ -551,8 +591,7 @@ async def get_venue_attendees(
             .where(
                 and_(
                     CheckIn.place_id == place_id,
-                    CheckIn.is_active == True,
-                    CheckIn.last_seen_at >= expiry_time
+                    CheckIn.is_active == True
                 )
             )
             .order_by(desc(CheckIn.last_seen_at))
@@ -577,7 +616,7 @@ async def get_venue_attendees(
 @router.delete("/venue/{place_id}")
 async def checkout_from_venue(
     place_id: str,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -607,51 +646,52 @@ async def checkout_from_venue(
     # Move to history and delete from active check-ins
     await move_checkin_to_history(db, checkin)
     await db.commit()
+    await sync_checkins(left=[(current_user.id, place_id)])
 
     # Invalidate venue count cache
     await cache_delete(f"venue_count:{place_id}")
+    await bump_versions(CHECKINS_SCOPE)
+    await bump_close_friend_viewers(db, [current_user.id])
 
     # Notify users at the same venue who follow the current user
-    expiry_time = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
-
-    same_venue_followers_result = await db.execute(
-        select(User, CheckIn).join(
-            CheckIn, CheckIn.user_id == User.id
-        ).join(
-            Follow, and_(
-                Follow.follower_id == User.id,
-                Follow.following_id == current_user.id
-            )
-        ).where(
-            and_(
-                CheckIn.place_id == place_id,
-                CheckIn.is_active == True,
-                CheckIn.last_seen_at >= expiry_time,
-                User.id != current_user.id
+    same_venue_ids = await followers_at_place(current_user.id, place_id)
+    if same_venue_ids is None:
+        same_venue_result = await db.execute(
+            select(CheckIn.user_id).join(
+                Follow, and_(
+                    Follow.follower_id == CheckIn.user_id,
+                    Follow.following_id == current_user.id
+                )
+            ).where(
+                and_(
+                    CheckIn.place_id == place_id,
+                    CheckIn.is_active == True,
+                    CheckIn.user_id != current_user.id
+                )
             )
         )
-    )
+        same_venue_ids = same_venue_result.scalars().all()
 
     # Send notifications (WebSocket + push)
     from services.tasks import send_websocket_notification
 
-    for user, _ in same_venue_followers_result.all():
+    for user_id in same_venue_ids:
         payload = NotificationPayload(
             notification_type=NotificationType.FRIEND_LEFT_VENUE,
             title="Friend Left",
             body=f"{current_user.nickname} left {venue_name}",
             actor_id=current_user.id,
             actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic,
+            actor_profile_picture=current_user.avatar_url,
             venue_place_id=place_id,
             venue_name=venue_name,
             venue_latitude=place.latitude if place else None,
             venue_longitude=place.longitude if place else None
         )
         payload_dict = payload_to_dict(payload)
-        await send_websocket_notification(user.id, payload_dict)
-        enqueue_notification(user.id, payload_dict)
-        logger.info(f"Sent friend_left_venue notification for user {user.id}")
+        await send_websocket_notification(user_id, payload_dict)
+        enqueue_notification(user_id, payload_dict)
+        logger.info(f"Sent friend_left_venue notification for user {user_id}")
 
     # Broadcast checkout to all connected clients
     await manager.broadcast({
@@ -690,61 +730,111 @@ class CheckInHistoryWithUser(CheckInHistoryResponse):
     profile_picture: Optional[str]
 
 
+HISTORY_PAGE_MAX = 100
+NEXT_CURSOR_HEADER = "X-Next-Cursor"
+
+
+def encode_history_cursor(checked_in_at: datetime, history_id: int) -> str:
+    """Opaque cursor pointing just past a history row"""
+    raw = f"{checked_in_at.isoformat()}|{history_id}".encode()
+    return base64.urlsafe_b64encode(raw).decode().rstrip("=")
+
+
+def decode_history_cursor(cursor: str) -> tuple[datetime, int]:
+    try:
+        raw = base64.urlsafe_b64decode(cursor + "=" * (-len(cursor) % 4)).decode()
+        checked_in_at, history_id = raw.split("|")
+        return datetime.fromisoformat(checked_in_at), int(history_id)
+    except (ValueError, UnicodeDecodeError):
+        raise HTTPException(status_code=400, detail="Invalid cursor")
+
+
+def paginate_history(query, limit: int, offset: int, cursor: Optional[str]):
+    """
+    Newest-first page of a CheckInHistory query.
+
+    With a cursor, seeks on (checked_in_at, id) so every page is an index range
+    scan; the plain checked_in_at bound lets Postgres skip newer partitions.
+    offset is only honoured without a cursor, for older app builds.
+    """
+    limit = max(1, min(limit, HISTORY_PAGE_MAX))
+    if cursor:
+        checked_in_at, history_id = decode_history_cursor(cursor)
+        query = query.where(
+            CheckInHistory.checked_in_at <= checked_in_at,
+            tuple_(CheckInHistory.checked_in_at, CheckInHistory.id) < tuple_(checked_in_at, history_id)
+        )
+    elif offset:
+        query = query.offset(offset)
+    # One extra row tells us whether there is a next page
+    return query.order_by(desc(CheckInHistory.checked_in_at), desc(CheckInHistory.id)).limit(limit + 1), limit
+
+
+def set_next_cursor(response: Response, rows: list, limit: int, history=lambda row: row) -> list:
+    """Trim the look-ahead row and expose the next cursor as a header"""
+    if len(rows) > limit:
+        rows = rows[:limit]
+        last = history(rows[-1])
+        response.headers[NEXT_CURSOR_HEADER] = encode_history_cursor(last.checked_in_at, last.id)
+    return rows
+
+
 @router.get("/history/me", response_model=List[CheckInHistoryResponse])
 async def get_my_checkin_history(
+    response: Response,
     limit: int = 50,
     offset: int = 0,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    cursor: Optional[str] = None,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
-    """Get current user's check-in history."""
-    result = await db.execute(
-        select(CheckInHistory)
-        .where(CheckInHistory.user_id == current_user.id)
-        .order_by(desc(CheckInHistory.checked_in_at))
-        .limit(limit)
-        .offset(offset)
+    """Get current user's check-in history. Pass X-Next-Cursor back as cursor for the next page."""
+    query, limit = paginate_history(
+        select(CheckInHistory).where(CheckInHistory.user_id == current_user.id),
+        limit, offset, cursor
     )
-    return result.scalars().all()
+    result = await db.execute(query)
+    return set_next_cursor(response, result.scalars().all(), limit)
 
 
 @router.get("/history/user/{user_id}", response_model=List[CheckInHistoryResponse])
 async def get_user_checkin_history(
     user_id: int,
+    response: Response,
     limit: int = 50,
     offset: int = 0,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    cursor: Optional[str] = None,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
-    """Get a user's check-in history."""
-    result = await db.execute(
-        select(CheckInHistory)
-        .where(CheckInHistory.user_id == user_id)
-        .order_by(desc(CheckInHistory.checked_in_at))
-        .limit(limit)
-        .offset(offset)
+    """Get a user's check-in history. Pass X-Next-Cursor back as cursor for the next page."""
+    query, limit = paginate_history(
+        select(CheckInHistory).where(CheckInHistory.user_id == user_id),
+        limit, offset, cursor
     )
-    return result.scalars().all()
+    result = await db.execute(query)
+    return set_next_cursor(response, result.scalars().all(), limit)
 
 
 @router.get("/history/venue/{place_id}", response_model=List[CheckInHistoryWithUser])
 async def get_venue_checkin_history(
     place_id: str,
+    response: Response,
     limit: int = 50,
     offset: int = 0,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    cursor: Optional[str] = None,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
-    """Get a venue's check-in history (all users who checked in)."""
-    result = await db.execute(
-        select(CheckInHistory, User)
+    """Get a venue's check-in history (all users who checked in). Pass X-Next-Cursor back as cursor."""
+    query, limit = paginate_history(
+        select(CheckInHistory, User.nickname, User.profile_picture, User.instagram_profile_pic)
         .join(User, CheckInHistory.user_id == User.id)
-        .where(CheckInHistory.place_id == place_id)
-        .order_by(desc(CheckInHistory.checked_in_at))
-        .limit(limit)
-        .offset(offset)
+        .where(CheckInHistory.place_id == place_id),
+        limit, offset, cursor
     )
-    rows = result.all()
+    result = await db.execute(query)
+    rows = set_next_cursor(response, result.all(), limit, history=lambda row: row[0])
 
     return [
         CheckInHistoryWithUser(
@@ -757,8 +847,8 @@ async def get_venue_checkin_history(
             longitude=checkin.longitude,
             checked_in_at=checkin.checked_in_at,
             checked_out_at=checkin.checked_out_at,
-            nickname=user.nickname,
-            profile_picture=user.profile_picture or user.instagram_profile_pic
+            nickname=nickname,
+            profile_picture=profile_picture or instagram_profile_pic
         )
-        for checkin, user in rows
+        for checkin, nickname, profile_picture, instagram_profile_pic in rows
     ]
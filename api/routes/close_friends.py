@@ -1,4 +1,4 @@
-from fastapi import APIRouter, Depends, HTTPException
+from fastapi import APIRouter, Depends, HTTPException, Request, Response
 from sqlalchemy.ext.asyncio import AsyncSession
 from sqlalchemy import select
 from pydantic import BaseModel
@@ -9,10 +9,13 @@ from datetime import datetime, timezone
 
 from db.database import get_async_session, get_session_maker
 from db.models import User, Follow, CheckIn
-from api.dependencies import get_current_user
+from api.dependencies import get_current_user, get_current_principal, get_read_session
+from services.principals import Principal
 from api.routes.websocket import manager as ws_manager
 from api.routes.users import SimpleUserResponse
 from services.tasks import enqueue_notification, payload_to_dict
+from services.etag import not_modified, bump_versions, close_friend_locations_scope, user_scope
+from services.follow_graph import mark_follows_changed, sync_follow_graph, location_viewers, location_sharers
 
 router = APIRouter(prefix="/users", tags=["close-friends"])
 logger = logging.getLogger(__name__)
@@ -94,8 +97,8 @@ class CloseFriendLocationResponse(BaseModel):
 
 @router.get("/me/close-friend-requests")
 async def get_pending_close_friend_requests(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get list of pending close friend requests where others have requested to be close friends with the current user.
@@ -130,7 +133,7 @@ async def get_pending_close_friend_requests(
 @router.post("/follow/{user_id}/close-friend/request")
 async def request_close_friend(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -184,7 +187,7 @@ async def request_close_friend(
 
     # Send WebSocket notification to the target user
     actor_name = current_user.nickname or current_user.first_name or "Someone"
-    actor_pic = current_user.profile_picture or current_user.instagram_profile_pic
+    actor_pic = current_user.avatar_url
 
     notification_payload = {
         "type": "close_friend_request",
@@ -217,7 +220,7 @@ async def request_close_friend(
 @router.post("/follow/{user_id}/close-friend/accept")
 async def accept_close_friend(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -257,12 +260,18 @@ async def accept_close_friend(
     if reverse_follow:
         reverse_follow.close_friend_status = 'accepted'
         reverse_follow.is_close_friend = True
+    mark_follows_changed(db, follow, reverse_follow)
 
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(
+        user_scope(current_user.id), user_scope(user_id),
+        close_friend_locations_scope(current_user.id), close_friend_locations_scope(user_id)
+    )
 
     # Send WebSocket notification to the requester
     actor_name = current_user.nickname or current_user.first_name or "Someone"
-    actor_pic = current_user.profile_picture or current_user.instagram_profile_pic
+    actor_pic = current_user.avatar_url
 
     notification_payload = {
         "type": "close_friend_accepted",
@@ -295,7 +304,7 @@ async def accept_close_friend(
 @router.post("/follow/{user_id}/close-friend/decline")
 async def decline_close_friend(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -332,8 +341,14 @@ async def decline_close_friend(
     if reverse_follow:
         reverse_follow.close_friend_status = 'none'
         reverse_follow.close_friend_requester_id = None
+    mark_follows_changed(db, follow, reverse_follow)
 
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(
+        user_scope(current_user.id), user_scope(user_id),
+        close_friend_locations_scope(current_user.id), close_friend_locations_scope(user_id)
+    )
 
     # Send WebSocket notification to the requester
     notification_payload = {
@@ -354,7 +369,7 @@ async def decline_close_friend(
 @router.delete("/follow/{user_id}/close-friend")
 async def remove_close_friend(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -393,8 +408,14 @@ async def remove_close_friend(
         reverse_follow.close_friend_status = 'none'
         reverse_follow.close_friend_requester_id = None
         reverse_follow.is_close_friend = False
+    mark_follows_changed(db, follow, reverse_follow)
 
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(
+        user_scope(current_user.id), user_scope(user_id),
+        close_friend_locations_scope(current_user.id), close_friend_locations_scope(user_id)
+    )
 
     # Send WebSocket notification to the other user
     notification_payload = {
@@ -415,8 +436,8 @@ async def remove_close_friend(
 @router.get("/follow/{user_id}/close-friend/status")
 async def get_close_friend_status(
     user_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get the close friend status between current user and target user.
@@ -449,7 +470,7 @@ async def get_close_friend_status(
 @router.post("/follow/{user_id}/location-sharing")
 async def toggle_location_sharing(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -478,8 +499,11 @@ async def toggle_location_sharing(
     # Toggle location sharing
     new_state = not follow.is_sharing_location
     follow.is_sharing_location = new_state
+    mark_follows_changed(db, follow)
 
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(close_friend_locations_scope(user_id))
 
     # If enabling location sharing, notify the other user
     if new_state:
@@ -498,7 +522,7 @@ async def toggle_location_sharing(
             "type": "location_sharing_started",
             "actor_id": current_user.id,
             "actor_nickname": current_user.nickname or current_user.first_name or "Someone",
-            "actor_profile_picture": current_user.profile_picture or current_user.instagram_profile_pic,
+            "actor_profile_picture": current_user.avatar_url,
             "message": f"{current_user.nickname or current_user.first_name} started sharing their location with you",
             "is_requesting_share_back": not other_is_sharing
         }
@@ -512,7 +536,7 @@ async def toggle_location_sharing(
             body=f"{current_user.nickname or current_user.first_name} started sharing their location with you",
             actor_id=current_user.id,
             actor_nickname=current_user.nickname or current_user.first_name or "Someone",
-            actor_profile_picture=current_user.profile_picture or current_user.instagram_profile_pic
+            actor_profile_picture=current_user.avatar_url
         )
         enqueue_notification(user_id, payload_to_dict(payload))
     else:
@@ -534,8 +558,8 @@ async def toggle_location_sharing(
 @router.get("/follow/{user_id}/location-sharing/status")
 async def get_location_sharing_status(
     user_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Get location sharing status between current user and target user.
@@ -585,17 +609,19 @@ async def broadcast_location_to_close_friends(
     await db.commit()
 
     # Find all close friends we're sharing location with
-    result = await db.execute(
-        select(Follow).where(
-            Follow.follower_id == current_user.id,
-            Follow.close_friend_status == 'accepted',
-            Follow.is_sharing_location == True
+    viewer_ids = await location_viewers([current_user.id])
+    if viewer_ids is None:
+        result = await db.execute(
+            select(Follow.following_id).where(
+                Follow.follower_id == current_user.id,
+                Follow.close_friend_status == 'accepted',
+                Follow.is_sharing_location == True
+            )
         )
-    )
-    follows = result.scalars().all()
+        viewer_ids = result.scalars().all()
 
     # Send location update to each close friend via WebSocket
-    for follow in follows:
+    for viewer_id in viewer_ids:
         location_payload = {
             "type": "close_friend_location",
             "user_id": current_user.id,
@@ -605,14 +631,18 @@ async def broadcast_location_to_close_friends(
             "longitude": location.longitude,
             "updated_at": datetime.now(timezone.utc).isoformat()
         }
-        await ws_manager.send_to_user(follow.following_id, location_payload)
+        await ws_manager.send_to_user(viewer_id, location_payload)
+
+    await bump_versions(*(close_friend_locations_scope(viewer_id) for viewer_id in viewer_ids))
 
-    return {"status": "success", "recipients": len(follows)}
+    return {"status": "success", "recipients": len(viewer_ids)}
 
 
 @router.get("/close-friends/locations", response_model=List[CloseFriendLocationResponse])
 async def get_close_friend_locations(
-    current_user: User = Depends(get_current_user),
+    request: Request,
+    response: Response,
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -621,26 +651,37 @@ async def get_close_friend_locations(
     - They are sharing their location with you (their is_sharing_location = True)
     - They have a recent location update
     """
+    cached = await not_modified(request, response, [close_friend_locations_scope(current_user.id)], current_user.id)
+    if cached:
+        return cached
+
     logger.info(f"get_close_friend_locations called for user {current_user.id}")
 
     # Find close friends who are sharing their location with us
     # This means: they follow us AND have is_sharing_location = True
+    sharer_ids = await location_sharers(current_user.id)
+    if sharer_ids is not None:
+        sharing = User.id.in_(sharer_ids)
+    else:
+        sharing = User.id.in_(
+            select(Follow.follower_id).where(
+                Follow.following_id == current_user.id,
+                Follow.close_friend_status == 'accepted',
+                Follow.is_sharing_location == True
+            )
+        )
     result = await db.execute(
-        select(User, Follow).join(
-            Follow, Follow.follower_id == User.id
-        ).where(
-            Follow.following_id == current_user.id,
-            Follow.close_friend_status == 'accepted',
-            Follow.is_sharing_location == True,
+        select(User).where(
+            sharing,
             User.last_location_lat.isnot(None),
             User.last_location_lon.isnot(None)
         )
     )
-    rows = result.all()
-    logger.info(f"Found {len(rows)} close friends sharing location")
+    users = result.scalars().all()
+    logger.info(f"Found {len(users)} close friends sharing location")
 
     # Get active check-ins for these users
-    user_ids = [user.id for user, _ in rows]
+    user_ids = [user.id for user in users]
     checkin_result = await db.execute(
         select(CheckIn).where(
             CheckIn.user_id.in_(user_ids),
@@ -650,7 +691,7 @@ async def get_close_friend_locations(
     active_checkins = {ci.user_id: ci for ci in checkin_result.scalars().all()}
 
     locations = []
-    for user, follow in rows:
+    for user in users:
         checkin = active_checkins.get(user.id)
         locations.append(CloseFriendLocationResponse(
             user_id=user.id,
@@ -667,8 +708,8 @@ async def get_close_friend_locations(
 
 @router.get("/me/close-friends", response_model=List[SimpleUserResponse])
 async def get_close_friends(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get list of close friends (users you've marked as close friends)"""
     result = await db.execute(
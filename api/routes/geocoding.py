@@ -2,22 +2,23 @@
 
 import asyncio
 from typing import List, Optional
-import aiohttp
-import ssl
-import certifi
+import httpx
 
 from fastapi import APIRouter, Depends, HTTPException, Query
 from pydantic import BaseModel, Field
 
 from services.geocoding import GeocodingService, LocationResult, ReverseGeocodeResult
-from api.dependencies import get_current_user
-from db.models import User
+from api.dependencies import get_current_principal
+from services.principals import Principal
 from core.config import settings
-from services.cache import cache_get, cache_set
+from services.cache import cache_get_or_load
+from services.http_clients import GOOGLE, get_http_client
 from services.places.autocomplete import (
     global_autocomplete_search,
     index_place as index_place_to_cache
 )
+from services.places.fuzzy import fuzzy_search
+from services.places.nearby import NEARBY_MAX_CANDIDATES, NEARBY_MAX_RADIUS_METERS, nearby_places
 
 router = APIRouter(prefix="/geocoding", tags=["geocoding"])
 
@@ -52,7 +53,7 @@ class ReverseGeocodeRequest(BaseModel):
 @router.post("/forward", response_model=LocationResult)
 async def geocode_address(
     request: GeocodeRequest,
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Forward geocoding: Convert address to coordinates
@@ -62,7 +63,7 @@ async def geocode_address(
     Example: {"address": "Miami Beach Convention Center, Miami Beach, FL"}
     """
     service = get_geocoding_service()
-    result = service.geocode(request.address)
+    result = await service.geocode(request.address)
 
     if not result:
         raise HTTPException(status_code=404, detail="Address not found")
@@ -73,7 +74,7 @@ async def geocode_address(
 @router.get("/forward", response_model=LocationResult)
 async def geocode_address_get(
     address: str = Query(..., description="Address to geocode", min_length=1),
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Forward geocoding: Convert address to coordinates (GET method)
@@ -83,7 +84,7 @@ async def geocode_address_get(
     Example: /geocoding/forward?address=Miami%20Beach%20Convention%20Center
     """
     service = get_geocoding_service()
-    result = service.geocode(address)
+    result = await service.geocode(address)
 
     if not result:
         raise HTTPException(status_code=404, detail="Address not found")
@@ -94,7 +95,7 @@ async def geocode_address_get(
 @router.post("/reverse", response_model=ReverseGeocodeResult)
 async def reverse_geocode(
     request: ReverseGeocodeRequest,
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Reverse geocoding: Convert coordinates to address
@@ -104,7 +105,7 @@ async def reverse_geocode(
     Example: {"latitude": 25.7907, "longitude": -80.1300}
     """
     service = get_geocoding_service()
-    result = service.reverse_geocode(request.latitude, request.longitude)
+    result = await service.reverse_geocode(request.latitude, request.longitude)
 
     if not result:
         raise HTTPException(status_code=404, detail="Location not found")
@@ -116,7 +117,7 @@ async def reverse_geocode(
 async def reverse_geocode_get(
     lat: float = Query(..., ge=-90, le=90, description="Latitude in decimal degrees"),
     lon: float = Query(..., ge=-180, le=180, description="Longitude in decimal degrees"),
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Reverse geocoding: Convert coordinates to address (GET method)
@@ -126,7 +127,7 @@ async def reverse_geocode_get(
     Example: /geocoding/reverse?lat=25.7907&lon=-80.1300
     """
     service = get_geocoding_service()
-    result = service.reverse_geocode(lat, lon)
+    result = await service.reverse_geocode(lat, lon)
 
     if not result:
         raise HTTPException(status_code=404, detail="Location not found")
@@ -174,6 +175,20 @@ class AutocompleteResponse(BaseModel):
     from_cache: bool = False
 
 
+class NearbyPlace(PlacePrediction):
+    """A venue around the user, from the global places index"""
+    bounce_count: int = 0
+    occupancy: int = 0  # People checked in right now
+    from_cache: bool = True
+
+
+class NearbyResponse(BaseModel):
+    """One page of nearby venues, best first"""
+    places: List[NearbyPlace]
+    total: int  # Ranked venues within the radius (at most NEARBY_MAX_CANDIDATES)
+    next_offset: Optional[int] = None  # Pass as offset for the next page; None on the last one
+
+
 GOOGLE_PLACES_AUTOCOMPLETE_URL = "https://places.googleapis.com/v1/places:autocomplete"
 GOOGLE_PLACES_DETAILS_URL = "https://maps.googleapis.com/maps/api/place/details/json"
 
@@ -193,11 +208,6 @@ VENUE_TYPES_B = [
     "lodging",
 ]
 
-# SSL context for aiohttp requests to Google APIs
-def get_ssl_context():
-    return ssl.create_default_context(cafile=certifi.where())
-
-
 import math
 import asyncio
 
@@ -215,9 +225,7 @@ def haversine_distance_meters(lat1: float, lon1: float, lat2: float, lon2: float
 
 
 async def fetch_place_details_for_autocomplete(
-    session: aiohttp.ClientSession,
     place_id: str,
-    ssl_ctx,
     api_key: str
 ) -> tuple[Optional[float], Optional[float], Optional[str], List[str]]:
     """Fetch coordinates, photo, and types for a place. Returns (lat, lng, photo_url, types).
@@ -225,71 +233,68 @@ async def fetch_place_details_for_autocomplete(
     Uses cache to avoid redundant API calls - popular places are fetched once
     and reused across all users' searches.
     """
-    # Check cache first - reuse place details across all searches
-    cache_key = f"place_details:{place_id}"
-    cached = await cache_get(cache_key)
-    if cached:
-        lat = cached.get("latitude")
-        lng = cached.get("longitude")
-        photos = cached.get("photos", [])
-        photo_url = photos[0].get("url") if photos else None
-        types = cached.get("types", [])
-        return lat, lng, photo_url, types
-
     params = {
         "place_id": place_id,
         "key": api_key,
         "fields": "name,formatted_address,geometry,types,photos"  # Fetch full details for caching
     }
 
-    try:
-        async with session.get(GOOGLE_PLACES_DETAILS_URL, params=params, ssl=ssl_ctx) as response:
-            data = await response.json()
-
-            if data.get("status") != "OK":
-                return None, None, None
-
-            result = data.get("result", {})
-            location = result.get("geometry", {}).get("location", {})
-            lat = location.get("lat")
-            lng = location.get("lng")
-
-            # Build photo URLs (up to 5 photos) for caching
-            photos = []
-            for photo in result.get("photos", [])[:5]:
-                photo_ref = photo.get("photo_reference")
-                if photo_ref:
-                    photo_url = (
-                        f"https://maps.googleapis.com/maps/api/place/photo"
-                        f"?maxwidth=800"
-                        f"&photo_reference={photo_ref}"
-                        f"&key={api_key}"
-                    )
-                    photos.append({
-                        "url": photo_url,
-                        "width": photo.get("width"),
-                        "height": photo.get("height")
-                    })
-
-            # Cache full place details for 24 hours (reused by /places/details endpoint too)
-            types = result.get("types", [])
-            place_details = {
-                "place_id": place_id,
-                "name": result.get("name", ""),
-                "address": result.get("formatted_address", ""),
-                "latitude": lat,
-                "longitude": lng,
-                "types": types,
-                "photos": photos
-            }
-            await cache_set(cache_key, place_details)
+    async def load_place_details() -> Optional[dict]:
+        try:
+            response = await get_http_client(GOOGLE).get(GOOGLE_PLACES_DETAILS_URL, params=params)
+            data = response.json()
+        except Exception:
+            return None
+
+        if data.get("status") != "OK":
+            return None
+
+        result = data.get("result", {})
+        location = result.get("geometry", {}).get("location", {})
+
+        # Build photo URLs (up to 5 photos) for caching
+        photos = []
+        for photo in result.get("photos", [])[:5]:
+            photo_ref = photo.get("photo_reference")
+            if photo_ref:
+                photo_url = (
+                    f"https://maps.googleapis.com/maps/api/place/photo"
+                    f"?maxwidth=800"
+                    f"&photo_reference={photo_ref}"
+                    f"&key={api_key}"
+                )
+                photos.append({
+                    "url": photo_url,
+                    "width": photo.get("width"),
+                    "height": photo.get("height")
+                })
+
+        return {
+            "place_id": place_id,
+            "name": result.get("name", ""),
+            "address": result.get("formatted_address", ""),
+            "latitude": location.get("lat"),
+            "longitude": location.get("lng"),
+            "types": result.get("types", []),
+            "photos": photos
+        }
 
-            # Return first photo URL for autocomplete thumbnail
-            first_photo_url = photos[0]["url"] if photos else None
-            return lat, lng, first_photo_url, types
+    # Reuse place details across all searches (and the /places/details endpoint);
+    # concurrent searches for the same place share one Details call
+    try:
+        place_details = await cache_get_or_load(
+            f"place_details:{place_id}", load_place_details, reset_ttl=True
+        )
     except Exception:
+        place_details = None
+    if not place_details:
         return None, None, None, []
 
+    # Return first photo URL for autocomplete thumbnail
+    photos = place_details.get("photos", [])
+    first_photo_url = photos[0].get("url") if photos else None
+    return place_details.get("latitude"), place_details.get("longitude"), first_photo_url, place_details.get("types", [])
+
 
 async def _index_predictions_to_global_cache(predictions: List[PlacePrediction]) -> None:
     """Fire-and-forget: index Google API predictions to global cache."""
@@ -312,7 +317,7 @@ async def places_autocomplete(
     query: str = Query(..., min_length=2, description="Search query"),
     lat: Optional[float] = Query(None, ge=-90, le=90, description="User latitude for location bias"),
     lng: Optional[float] = Query(None, ge=-180, le=180, description="User longitude for location bias"),
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Places Autocomplete for venue search (bars, restaurants, cafes, clubs).
@@ -335,6 +340,12 @@ async def places_autocomplete(
         predictions = [PlacePrediction(**{**p, "from_cache": True}) for p in cached_results]
         return AutocompleteResponse(predictions=predictions, from_cache=True)
 
+    # 2b. No prefix match - try typos / word order against the in-process index
+    fuzzy_results = fuzzy_search(query, user_lat=lat, user_lng=lng, limit=10)
+    if fuzzy_results:
+        predictions = [PlacePrediction(**{**p, "from_cache": True}) for p in fuzzy_results]
+        return AutocompleteResponse(predictions=predictions, from_cache=True)
+
     # 3. Fall back to Google API (only when Redis has no matches)
     if not settings.GOOGLE_MAPS_API_KEY:
         # If no API key, return whatever we have from cache
@@ -369,120 +380,116 @@ async def places_autocomplete(
             b["locationBias"] = location_bias
         ac_bodies.append(b)
 
-    async def _autocomplete_request(session, body, ssl_ctx):
+    async def _autocomplete_request(body):
         """Fire one autocomplete request, return suggestions list or []."""
         try:
-            async with session.post(GOOGLE_PLACES_AUTOCOMPLETE_URL, headers=headers, json=body, ssl=ssl_ctx) as resp:
-                data = await resp.json()
-                if resp.status != 200:
-                    return []
-                return data.get("suggestions", [])
+            resp = await get_http_client(GOOGLE).post(GOOGLE_PLACES_AUTOCOMPLETE_URL, headers=headers, json=body)
+            data = resp.json()
+            if resp.status_code != 200:
+                return []
+            return data.get("suggestions", [])
         except Exception:
             return []
 
     try:
-        ssl_ctx = get_ssl_context()
-        async with aiohttp.ClientSession() as session:
-            # Fire two typed autocomplete batches in parallel (bars, restaurants, gyms, etc.)
-            results_a, results_b = await asyncio.gather(
-                _autocomplete_request(session, ac_bodies[0], ssl_ctx),
-                _autocomplete_request(session, ac_bodies[1], ssl_ctx),
-            )
-
-            # Merge and deduplicate autocomplete suggestions (typed results first)
-            seen_ids = set()
-            raw_predictions = []
-            for pred in results_a + results_b:
-                pid = pred.get("placePrediction", {}).get("placeId")
-                if pid and pid not in seen_ids:
-                    raw_predictions.append(pred)
-                    seen_ids.add(pid)
-
-            if not raw_predictions:
-                if cached_results:
-                    predictions = [PlacePrediction(**{**p, "from_cache": True}) for p in cached_results]
-                    return AutocompleteResponse(predictions=predictions, from_cache=True)
-                return AutocompleteResponse(predictions=[])
-
-            # Fetch details for all predictions in parallel
-            detail_tasks = [
-                fetch_place_details_for_autocomplete(
-                    session,
-                    pred.get("placePrediction", {}).get("placeId", ""),
-                    ssl_ctx,
-                    settings.GOOGLE_MAPS_API_KEY
-                )
-                for pred in raw_predictions
-                if pred.get("placePrediction")
-            ]
-            details_results = await asyncio.gather(*detail_tasks)
-
-            # Build predictions with coordinates and distance
-            google_predictions = []
-            detail_idx = 0
-            for pred in raw_predictions:
-                place_pred = pred.get("placePrediction")
-                if not place_pred:
-                    continue
-
-                place_lat, place_lng, photo_url, place_types = details_results[detail_idx]
-                detail_idx += 1
-
-                # Calculate distance if we have both user location and place location
-                distance_meters = None
-                if lat is not None and lng is not None and place_lat is not None and place_lng is not None:
-                    distance_meters = haversine_distance_meters(lat, lng, place_lat, place_lng)
-
-                # Extract structured text from new API format
-                structured_format = place_pred.get("structuredFormat", {})
-                main_text = structured_format.get("mainText", {}).get("text", "")
-                secondary_text = structured_format.get("secondaryText", {}).get("text", "")
-
-                google_predictions.append(PlacePrediction(
-                    place_id=place_pred.get("placeId", ""),
-                    name=main_text or place_pred.get("text", {}).get("text", ""),
-                    address=secondary_text,
-                    full_description=place_pred.get("text", {}).get("text", ""),
-                    latitude=place_lat,
-                    longitude=place_lng,
-                    distance_meters=distance_meters,
-                    photo_url=photo_url,
-                    types=place_types or [],
-                    from_cache=False,
-                ))
-
-            # 4. Merge cached results with Google results (cached first, deduped)
-            seen_place_ids = set()
-            merged_predictions = []
-
-            # Add cached results first (they have bounce_count scoring)
-            for cached in cached_results:
-                pid = cached.get("place_id")
-                if pid and pid not in seen_place_ids:
-                    merged_predictions.append(PlacePrediction(**{**cached, "from_cache": True}))
-                    seen_place_ids.add(pid)
-
-            # Add autocomplete results (skip duplicates)
-            for gp in google_predictions:
-                if gp.place_id not in seen_place_ids:
-                    merged_predictions.append(gp)
-                    seen_place_ids.add(gp.place_id)
-
-            # Sort by distance (closest first) if distances are available
-            merged_predictions.sort(key=lambda p: p.distance_meters if p.distance_meters is not None else float('inf'))
-
-            # Limit to 10 results
-            final_predictions = merged_predictions[:10]
-
-            # 5. Index all Google results to global cache (fire-and-forget)
-            asyncio.create_task(_index_predictions_to_global_cache(google_predictions))
+        # Fire two typed autocomplete batches in parallel (bars, restaurants, gyms, etc.)
+        results_a, results_b = await asyncio.gather(
+            _autocomplete_request(ac_bodies[0]),
+            _autocomplete_request(ac_bodies[1]),
+        )
 
-            return AutocompleteResponse(
-                predictions=final_predictions,
-                from_cache=len(cached_results) > 0 and len(google_predictions) == 0
+        # Merge and deduplicate autocomplete suggestions (typed results first)
+        seen_ids = set()
+        raw_predictions = []
+        for pred in results_a + results_b:
+            pid = pred.get("placePrediction", {}).get("placeId")
+            if pid and pid not in seen_ids:
+                raw_predictions.append(pred)
+                seen_ids.add(pid)
+
+        if not raw_predictions:
+            if cached_results:
+                predictions = [PlacePrediction(**{**p, "from_cache": True}) for p in cached_results]
+                return AutocompleteResponse(predictions=predictions, from_cache=True)
+            return AutocompleteResponse(predictions=[])
+
+        # Fetch details for all predictions in parallel
+        detail_tasks = [
+            fetch_place_details_for_autocomplete(
+                pred.get("placePrediction", {}).get("placeId", ""),
+                settings.GOOGLE_MAPS_API_KEY
             )
+            for pred in raw_predictions
+            if pred.get("placePrediction")
+        ]
+        details_results = await asyncio.gather(*detail_tasks)
+
+        # Build predictions with coordinates and distance
+        google_predictions = []
+        detail_idx = 0
+        for pred in raw_predictions:
+            place_pred = pred.get("placePrediction")
+            if not place_pred:
+                continue
+
+            place_lat, place_lng, photo_url, place_types = details_results[detail_idx]
+            detail_idx += 1
+
+            # Calculate distance if we have both user location and place location
+            distance_meters = None
+            if lat is not None and lng is not None and place_lat is not None and place_lng is not None:
+                distance_meters = haversine_distance_meters(lat, lng, place_lat, place_lng)
+
+            # Extract structured text from new API format
+            structured_format = place_pred.get("structuredFormat", {})
+            main_text = structured_format.get("mainText", {}).get("text", "")
+            secondary_text = structured_format.get("secondaryText", {}).get("text", "")
+
+            google_predictions.append(PlacePrediction(
+                place_id=place_pred.get("placeId", ""),
+                name=main_text or place_pred.get("text", {}).get("text", ""),
+                address=secondary_text,
+                full_description=place_pred.get("text", {}).get("text", ""),
+                latitude=place_lat,
+                longitude=place_lng,
+                distance_meters=distance_meters,
+                photo_url=photo_url,
+                types=place_types or [],
+                from_cache=False,
+            ))
+
+        # 4. Merge cached results with Google results (cached first, deduped)
+        seen_place_ids = set()
+        merged_predictions = []
+
+        # Add cached results first (they have bounce_count scoring)
+        for cached in cached_results:
+            pid = cached.get("place_id")
+            if pid and pid not in seen_place_ids:
+                merged_predictions.append(PlacePrediction(**{**cached, "from_cache": True}))
+                seen_place_ids.add(pid)
+
+        # Add autocomplete results (skip duplicates)
+        for gp in google_predictions:
+            if gp.place_id not in seen_place_ids:
+                merged_predictions.append(gp)
+                seen_place_ids.add(gp.place_id)
+
+        # Sort by distance (closest first) if distances are available
+        merged_predictions.sort(key=lambda p: p.distance_meters if p.distance_meters is not None else float('inf'))
+
+        # Limit to 10 results
+        final_predictions = merged_predictions[:10]
+
+        # 5. Index all Google results to global cache (fire-and-forget)
+        asyncio.create_task(_index_predictions_to_global_cache(google_predictions))
+
+        return AutocompleteResponse(
+            predictions=final_predictions,
+            from_cache=len(cached_results) > 0 and len(google_predictions) == 0
+        )
 
-    except aiohttp.ClientError as e:
+    except httpx.HTTPError as e:
         # If network fails but we have cache results, return those
         if cached_results:
             predictions = [PlacePrediction(**{**p, "from_cache": True}) for p in cached_results]
@@ -493,10 +500,37 @@ async def places_autocomplete(
 GOOGLE_PLACES_PHOTO_URL = "https://maps.googleapis.com/maps/api/place/photo"
 
 
+@router.get("/places/nearby", response_model=NearbyResponse)
+async def places_nearby(
+    lat: float = Query(..., ge=-90, le=90, description="User latitude"),
+    lng: float = Query(..., ge=-180, le=180, description="User longitude"),
+    radius: int = Query(2000, ge=50, le=NEARBY_MAX_RADIUS_METERS, description="Search radius in meters"),
+    offset: int = Query(0, ge=0, le=NEARBY_MAX_CANDIDATES),
+    limit: int = Query(20, ge=1, le=50),
+    current_user: Principal = Depends(get_current_principal)
+):
+    """
+    Venues around the user from the global places index (no Google calls).
+
+    Ranked by distance, popularity (bounces, check-ins) and how many people
+    are checked in right now. Only the NEARBY_MAX_CANDIDATES closest venues
+    are ranked; page through them with offset / next_offset.
+
+    Example: /geocoding/places/nearby?lat=25.79&lng=-80.13&radius=2000
+    """
+    places, total = await nearby_places(lat, lng, radius, offset=offset, limit=limit)
+    next_offset = offset + limit if offset + limit < total else None
+    return NearbyResponse(
+        places=[NearbyPlace(**place) for place in places],
+        total=total,
+        next_offset=next_offset
+    )
+
+
 @router.get("/places/details/{place_id}", response_model=PlaceDetails)
 async def get_place_details(
     place_id: str,
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Get full details for a place including coordinates and photos.
@@ -505,70 +539,62 @@ async def get_place_details(
 
     Example: /geocoding/places/details/ChIJN1t_tDeuEmsRUsoyG83frY4
     """
-    # Check cache first (place details rarely change)
-    cache_key = f"place_details:{place_id}"
-    cached = await cache_get(cache_key)
-    if cached:
-        return PlaceDetails(**cached)
+    async def load_place_details() -> dict:
+        # Only a miss needs Google - cached places are served without a key
+        if not settings.GOOGLE_MAPS_API_KEY:
+            raise HTTPException(
+                status_code=503,
+                detail="Places API not configured. GOOGLE_MAPS_API_KEY required."
+            )
 
-    if not settings.GOOGLE_MAPS_API_KEY:
-        raise HTTPException(
-            status_code=503,
-            detail="Places API not configured. GOOGLE_MAPS_API_KEY required."
-        )
+        params = {
+            "place_id": place_id,
+            "key": settings.GOOGLE_MAPS_API_KEY,
+            "fields": "name,formatted_address,geometry,types,photos"
+        }
+        try:
+            response = await get_http_client(GOOGLE).get(GOOGLE_PLACES_DETAILS_URL, params=params)
+            data = response.json()
+        except (httpx.HTTPError, ValueError) as e:
+            raise HTTPException(status_code=502, detail=f"Failed to reach Places API: {str(e)}")
 
-    params = {
-        "place_id": place_id,
-        "key": settings.GOOGLE_MAPS_API_KEY,
-        "fields": "name,formatted_address,geometry,types,photos"
-    }
+        if data.get("status") != "OK":
+            raise HTTPException(
+                status_code=404 if data.get("status") == "NOT_FOUND" else 502,
+                detail=f"Place not found or API error: {data.get('status')}"
+            )
 
-    try:
-        ssl_ctx = get_ssl_context()
-        async with aiohttp.ClientSession() as session:
-            async with session.get(GOOGLE_PLACES_DETAILS_URL, params=params, ssl=ssl_ctx) as response:
-                data = await response.json()
-
-                if data.get("status") != "OK":
-                    raise HTTPException(
-                        status_code=404 if data.get("status") == "NOT_FOUND" else 502,
-                        detail=f"Place not found or API error: {data.get('status')}"
-                    )
-
-                result = data.get("result", {})
-                location = result.get("geometry", {}).get("location", {})
-
-                # Build photo URLs (up to 5 photos)
-                photos = []
-                for photo in result.get("photos", [])[:5]:
-                    photo_ref = photo.get("photo_reference")
-                    if photo_ref:
-                        photo_url = (
-                            f"{GOOGLE_PLACES_PHOTO_URL}"
-                            f"?maxwidth=800"
-                            f"&photo_reference={photo_ref}"
-                            f"&key={settings.GOOGLE_MAPS_API_KEY}"
-                        )
-                        photos.append(PlacePhoto(
-                            url=photo_url,
-                            width=photo.get("width"),
-                            height=photo.get("height")
-                        ))
-
-                place_details = PlaceDetails(
-                    place_id=place_id,
-                    name=result.get("name", ""),
-                    address=result.get("formatted_address", ""),
-                    latitude=location.get("lat", 0),
-                    longitude=location.get("lng", 0),
-                    types=result.get("types", []),
-                    photos=photos
+        result = data.get("result", {})
+        location = result.get("geometry", {}).get("location", {})
+
+        # Build photo URLs (up to 5 photos)
+        photos = []
+        for photo in result.get("photos", [])[:5]:
+            photo_ref = photo.get("photo_reference")
+            if photo_ref:
+                photo_url = (
+                    f"{GOOGLE_PLACES_PHOTO_URL}"
+                    f"?maxwidth=800"
+                    f"&photo_reference={photo_ref}"
+                    f"&key={settings.GOOGLE_MAPS_API_KEY}"
                 )
+                photos.append(PlacePhoto(
+                    url=photo_url,
+                    width=photo.get("width"),
+                    height=photo.get("height")
+                ))
 
-                # Cache for 24 hours (place details rarely change)
-                await cache_set(cache_key, place_details.model_dump())
-
-                return place_details
-
-    except aiohttp.ClientError as e:
-        raise HTTPException(status_code=502, detail=f"Failed to reach Places API: {str(e)}")
\ No newline at end of file
+        return PlaceDetails(
+            place_id=place_id,
+            name=result.get("name", ""),
+            address=result.get("formatted_address", ""),
+            latitude=location.get("lat", 0),
+            longitude=location.get("lng", 0),
+            types=result.get("types", []),
+            photos=photos
+        ).model_dump()
+
+    # Cached with a sliding TTL (place details rarely change); concurrent
+    # requests for the same place share one Details call
+    cached = await cache_get_or_load(f"place_details:{place_id}", load_place_details, reset_ttl=True)
+    return PlaceDetails(**cached)
\ No newline at end of file
@@ -10,8 +10,10 @@ from typing import Optional
 from datetime import datetime, timezone
 
 from db.database import get_async_session
-from db.models import DeviceToken, NotificationPreference, User
-from api.dependencies import get_current_user
+from db.models import DeviceToken, NotificationPreference
+from api.dependencies import get_current_principal
+from services.principals import Principal
+from services.device_tokens import invalidate_token_index
 
 logger = logging.getLogger(__name__)
 router = APIRouter(prefix="/notifications", tags=["notifications"])
@@ -49,7 +51,7 @@ class NotificationPreferencesResponse(BaseModel):
 @router.post("/device-token")
 async def register_device_token(
     request: RegisterDeviceRequest,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Register or update device token for push notifications"""
@@ -67,20 +69,27 @@ async def register_device_token(
     )
     existing = result.scalar_one_or_none()
 
+    affected_users = {current_user.id}
     if existing:
         # Update existing token
         existing.device_name = request.device_name
         existing.is_sandbox = request.is_sandbox
         existing.is_active = True
+        existing.failure_score = 0
         existing.updated_at = datetime.now(timezone.utc)
     else:
         # Deactivate other tokens with the same device_token (for other users)
         # This handles the case where a device is signed out and signed in with different account
-        await db.execute(
+        result = await db.execute(
             DeviceToken.__table__.update()
-            .where(DeviceToken.device_token == request.device_token)
+            .where(
+                DeviceToken.device_token == request.device_token,
+                DeviceToken.is_active == True
+            )
             .values(is_active=False)
+            .returning(DeviceToken.user_id)
         )
+        affected_users.update(row[0] for row in result.all())
 
         # Create new token entry
         device_token = DeviceToken(
@@ -93,21 +102,9 @@ async def register_device_token(
         db.add(device_token)
 
     await db.commit()
+    await invalidate_token_index(affected_users)
 
-    # Log all active tokens for this user after registration
-    all_tokens = await db.execute(
-        select(DeviceToken).where(
-            and_(
-                DeviceToken.user_id == current_user.id,
-                DeviceToken.is_active == True
-            )
-        )
-    )
-    active_tokens = all_tokens.scalars().all()
     logger.info(f"Device token registered for user {current_user.id}: {request.device_token[:20]}... (sandbox={request.is_sandbox})")
-    logger.info(f"User {current_user.id} now has {len(active_tokens)} active token(s)")
-    for t in active_tokens:
-        logger.info(f"  - Token: {t.device_token[:20]}... sandbox={t.is_sandbox} active={t.is_active}")
 
     return {"status": "success", "message": "Device token registered"}
 
@@ -115,7 +112,7 @@ async def register_device_token(
 @router.delete("/device-token")
 async def unregister_device_token(
     device_token: str,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Unregister device token (e.g., on logout)"""
@@ -135,6 +132,7 @@ async def unregister_device_token(
     if token:
         token.is_active = False
         await db.commit()
+        await invalidate_token_index([current_user.id])
         logger.info(f"Token deactivated for user {current_user.id}")
     else:
         logger.warning(f"Token not found for user {current_user.id} - nothing to unregister")
@@ -144,7 +142,7 @@ async def unregister_device_token(
 
 @router.get("/preferences", response_model=NotificationPreferencesResponse)
 async def get_notification_preferences(
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Get user's notification preferences"""
@@ -182,7 +180,7 @@ async def get_notification_preferences(
 @router.put("/preferences", response_model=NotificationPreferencesResponse)
 async def update_notification_preferences(
     request: NotificationPreferencesRequest,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Update user's notification preferences"""
@@ -222,7 +220,7 @@ async def update_notification_preferences(
 
 @router.post("/test-push")
 async def test_push_notification(
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Send a test push notification to diagnose APNs issues"""
@@ -245,7 +243,7 @@ async def test_push_notification(
     tokens = await apns._get_user_tokens(db, current_user.id, NotificationType.BOUNCE_INVITE)
     diagnostics["active_tokens"] = len(tokens)
     diagnostics["tokens"] = [
-        {"token": t.device_token[:20] + "...", "sandbox": t.is_sandbox, "active": t.is_active}
+        {"token": t.device_token[:20] + "...", "sandbox": t.is_sandbox, "active": True}
         for t in tokens
     ]
 
@@ -284,7 +282,7 @@ async def test_push_notification(
 
 @router.post("/badge/reset")
 async def reset_badge(
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
 ):
     """Reset badge count to 0 (called when app opens)"""
     from services.redis import reset_badge_count
@@ -1,6 +1,6 @@
-from fastapi import APIRouter, Depends, HTTPException, UploadFile, File, Request, Query
+from fastapi import APIRouter, Depends, HTTPException, UploadFile, File, Request, Response, Query
 from sqlalchemy.ext.asyncio import AsyncSession
-from sqlalchemy import select, delete, or_, func
+from sqlalchemy import select, delete, text
 from pydantic import BaseModel
 from typing import Optional, List, Literal
 import aiofiles
@@ -9,18 +9,23 @@ import uuid
 import os
 import hashlib
 import logging
-import base64
 from datetime import datetime, timezone
 from math import radians, cos, sin, asin, sqrt
 
 from db.database import get_async_session
 from db.models import User, Follow, RefreshToken, DeviceToken, NotificationPreference, CheckIn
-from api.dependencies import get_current_user, limiter
+from api.dependencies import get_current_user, get_current_principal, limiter, get_read_session
+from services.principals import Principal, invalidate_principal
 from core.config import settings
 from api.routes.websocket import manager as ws_manager
 from services.geofence import haversine_distance
-from services.cache import cache_get, cache_set, cache_delete
 from services.tasks import enqueue_notification, payload_to_dict
+from services.device_tokens import invalidate_token_index
+from services.image_store import store_image, thumbnail_url, InvalidImageError
+from services.follow_graph import (
+    add_follow, remove_follow, remove_user_follows, sync_follow_graph, sync_checkins, follow_relation
+)
+from services.etag import not_modified, bump_versions, bump_close_friend_viewers, user_scope
 from services.instagram import fetch_instagram_profile
 import re
 
@@ -74,9 +79,9 @@ class ProfileResponse(BaseModel):
     phone: Optional[str] = None
     email: Optional[str] = None
     profile_picture: Optional[str] = None  # Legacy field
-    profile_picture_1: Optional[str] = None  # Base64 encoded image
-    profile_picture_2: Optional[str] = None  # Base64 encoded image
-    profile_picture_3: Optional[str] = None  # Base64 encoded image
+    profile_picture_1: Optional[str] = None  # /files/images/... URL (full variant)
+    profile_picture_2: Optional[str] = None
+    profile_picture_3: Optional[str] = None
     has_profile: bool = False
     # Privacy flags (only returned for own profile)
     phone_visible: Optional[bool] = None
@@ -174,6 +179,9 @@ class UserSearchResult(BaseModel):
     profile_picture: Optional[str]
     instagram_handle: Optional[str]
     match_type: str  # 'nickname' or 'instagram'
+    is_following: bool = False  # Searcher follows them
+    is_mutual: bool = False  # ...and they follow back
+    at_same_venue: bool = False  # Checked in where the searcher is right now
 
     class Config:
         from_attributes = True
@@ -186,6 +194,94 @@ class UserSearchResponse(BaseModel):
     total_count: int
 
 
+class FollowPageResponse(BaseModel):
+    """One page of a follower/following list"""
+    users: List[SimpleUserResponse]
+    total: int  # Full list size, from the profile follow counts
+    next_cursor: Optional[int] = None  # Pass back as ?cursor= for the next page
+
+
+FOLLOW_PAGE_DEFAULT = 30
+FOLLOW_PAGE_MAX = 100
+
+
+async def get_follow_counts(db: AsyncSession, user_id: int) -> tuple[int, int]:
+    """(followers, following) for a user from the denormalized counters"""
+    result = await db.execute(
+        select(User.followers_count, User.following_count).where(User.id == user_id)
+    )
+    row = result.first()
+    return (row.followers_count, row.following_count) if row else (0, 0)
+
+
+async def get_follow_page(
+    db: AsyncSession,
+    user_id: int,
+    direction: Literal["followers", "following"],
+    cursor: Optional[int],
+    limit: int
+) -> FollowPageResponse:
+    """
+    Newest-first page of a follow list, keyed on follows.id.
+
+    Seeks on (following_id, id) / (follower_id, id) and projects only the
+    columns a list row shows rather than full User rows.
+    """
+    limit = max(1, min(limit, FOLLOW_PAGE_MAX))
+    if direction == "followers":
+        owner_column, other_column = Follow.following_id, Follow.follower_id
+    else:
+        owner_column, other_column = Follow.follower_id, Follow.following_id
+
+    query = (
+        select(
+            Follow.id.label("follow_id"),
+            Follow.is_close_friend,
+            User.id,
+            User.nickname,
+            User.first_name,
+            User.last_name,
+            User.profile_picture,
+            User.instagram_profile_pic,
+            User.profile_picture_1,
+            User.employer,
+            User.instagram_handle,
+        )
+        .join(User, User.id == other_column)
+        .where(owner_column == user_id)
+        .order_by(Follow.id.desc())
+        .limit(limit + 1)  # One extra row tells us whether there is a next page
+    )
+    if cursor is not None:
+        query = query.where(Follow.id < cursor)
+
+    rows = (await db.execute(query)).all()
+    next_cursor = None
+    if len(rows) > limit:
+        rows = rows[:limit]
+        next_cursor = rows[-1].follow_id
+
+    followers_count, following_count = await get_follow_counts(db, user_id)
+
+    return FollowPageResponse(
+        users=[
+            SimpleUserResponse(
+                id=row.id,
+                nickname=row.nickname,
+                first_name=row.first_name,
+                last_name=row.last_name,
+                profile_picture=row.profile_picture or row.instagram_profile_pic or thumbnail_url(row.profile_picture_1),
+                employer=row.employer,
+                instagram_handle=row.instagram_handle,
+                is_close_friend=bool(row.is_close_friend) if direction == "following" else False
+            )
+            for row in rows
+        ],
+        total=followers_count if direction == "followers" else following_count,
+        next_cursor=next_cursor
+    )
+
+
 @router.get("/me", response_model=UserResponse)
 async def get_current_user_profile(current_user: User = Depends(get_current_user)):
     """Get current user profile"""
@@ -198,33 +294,6 @@ async def get_profile(
     db: AsyncSession = Depends(get_async_session)
 ):
     """Get current user full profile with stats"""
-    from sqlalchemy import func
-
-    cache_key = f"user_stats:{current_user.id}"
-    cached_stats = await cache_get(cache_key)
-
-    if cached_stats:
-        followers_count = cached_stats["followers"]
-        following_count = cached_stats["following"]
-    else:
-        # Get followers count (users following this user)
-        followers_result = await db.execute(
-            select(func.count(Follow.id)).where(Follow.following_id == current_user.id)
-        )
-        followers_count = followers_result.scalar() or 0
-
-        # Get following count (users this user follows)
-        following_result = await db.execute(
-            select(func.count(Follow.id)).where(Follow.follower_id == current_user.id)
-        )
-        following_count = following_result.scalar() or 0
-
-        # Cache stats for 5 minutes
-        await cache_set(cache_key, {
-            "followers": followers_count,
-            "following": following_count
-        }, ttl=300)
-
     return ProfileResponse(
         id=current_user.id,
         first_name=current_user.first_name,
@@ -238,8 +307,8 @@ async def get_profile(
         instagram_handle=current_user.instagram_handle,
         instagram_profile_pic=current_user.instagram_profile_pic,
         linkedin_handle=current_user.linkedin_handle,
-        followers_count=followers_count,
-        following_count=following_count
+        followers_count=current_user.followers_count,
+        following_count=current_user.following_count
     )
 
 
@@ -279,6 +348,8 @@ async def update_profile_full(
         current_user.email_visible = profile_data.email_visible
 
     await db.commit()
+    await invalidate_principal(current_user.id)
+    await bump_versions(user_scope(current_user.id))
     await db.refresh(current_user)
 
     return ProfileResponse(
@@ -328,6 +399,8 @@ async def update_instagram_handle(
             current_user.instagram_profile_pic = profile.profile_pic_url
 
     await db.commit()
+    await invalidate_principal(current_user.id)
+    await bump_versions(user_scope(current_user.id))
 
     return {
         "success": True,
@@ -375,14 +448,14 @@ class LinkedInLookupRequest(BaseModel):
 @router.post("/linkedin/lookup")
 async def lookup_linkedin_profile(
     request: LinkedInLookupRequest,
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Fetch LinkedIn profile pic URL for a given handle.
 
     Note: LinkedIn is very restrictive about scraping. This may not always work.
     """
-    import httpx
+    from services.http_clients import SOCIAL, get_http_client
 
     handle = request.handle.strip()
     if not handle:
@@ -405,49 +478,49 @@ async def lookup_linkedin_profile(
     }
 
     try:
-        async with httpx.AsyncClient() as client:
-            response = await client.get(
-                f"https://www.linkedin.com/in/{handle}/",
-                headers=headers,
-                follow_redirects=True,
-                timeout=10.0
-            )
+        client = get_http_client(SOCIAL)
+        response = await client.get(
+            f"https://www.linkedin.com/in/{handle}/",
+            headers=headers,
+            follow_redirects=True,
+            timeout=10.0
+        )
 
-            if response.status_code == 200:
-                html = response.text
-                import re
-
-                # Try to find profile image in various formats
-                # LinkedIn often uses data-delayed-url or img tags with specific classes
-                patterns = [
-                    r'"profilePicture"[^}]*"displayImageUrl":"([^"]+)"',
-                    r'data-delayed-url="(https://media\.licdn\.com/[^"]+)"',
-                    r'<img[^>]*class="[^"]*profile-photo[^"]*"[^>]*src="([^"]+)"',
-                    r'<img[^>]*src="(https://media\.licdn\.com/dms/image/[^"]+)"',
-                    r'"picture":"(https://media\.licdn\.com/[^"]+)"',
-                ]
-
-                for pattern in patterns:
-                    match = re.search(pattern, html)
-                    if match:
-                        profile_pic_url = match.group(1).replace("\\u002F", "/").replace("\\/", "/")
-                        break
-
-                # Try to get full name
-                name_patterns = [
-                    r'<title>([^|<]+?)(?:\s*[-|]|\s*\|)',
-                    r'"firstName":"([^"]+)"[^}]*"lastName":"([^"]+)"',
-                    r'<h1[^>]*>([^<]+)</h1>',
-                ]
-
-                for pattern in name_patterns:
-                    match = re.search(pattern, html)
-                    if match:
-                        if match.lastindex == 2:
-                            full_name = f"{match.group(1)} {match.group(2)}"
-                        else:
-                            full_name = match.group(1).strip()
-                        break
+        if response.status_code == 200:
+            html = response.text
+            import re
+
+            # Try to find profile image in various formats
+            # LinkedIn often uses data-delayed-url or img tags with specific classes
+            patterns = [
+                r'"profilePicture"[^}]*"displayImageUrl":"([^"]+)"',
+                r'data-delayed-url="(https://media\.licdn\.com/[^"]+)"',
+                r'<img[^>]*class="[^"]*profile-photo[^"]*"[^>]*src="([^"]+)"',
+                r'<img[^>]*src="(https://media\.licdn\.com/dms/image/[^"]+)"',
+                r'"picture":"(https://media\.licdn\.com/[^"]+)"',
+            ]
+
+            for pattern in patterns:
+                match = re.search(pattern, html)
+                if match:
+                    profile_pic_url = match.group(1).replace("\\u002F", "/").replace("\\/", "/")
+                    break
+
+            # Try to get full name
+            name_patterns = [
+                r'<title>([^|<]+?)(?:\s*[-|]|\s*\|)',
+                r'"firstName":"([^"]+)"[^}]*"lastName":"([^"]+)"',
+                r'<h1[^>]*>([^<]+)</h1>',
+            ]
+
+            for pattern in name_patterns:
+                match = re.search(pattern, html)
+                if match:
+                    if match.lastindex == 2:
+                        full_name = f"{match.group(1)} {match.group(2)}"
+                    else:
+                        full_name = match.group(1).strip()
+                    break
 
     except Exception as e:
         logger.warning(f"LinkedIn lookup error for {handle}: {e}")
@@ -464,7 +537,7 @@ async def lookup_linkedin_profile(
 @router.post("/instagram/lookup")
 async def lookup_instagram_profile(
     request: InstagramLookupRequest,
-    current_user: User = Depends(get_current_user)
+    current_user: Principal = Depends(get_current_principal)
 ):
     """
     Fetch Instagram profile pic URL for a given handle.
@@ -496,7 +569,7 @@ async def upload_profile_picture(
     current_user: User = Depends(get_current_user),
     db: AsyncSession = Depends(get_async_session)
 ):
-    """Upload profile picture to a specific slot (1, 2, or 3). Stored as base64 in database."""
+    """Upload profile picture to a specific slot (1, 2, or 3). Stored in the image store, URL kept on the user."""
     # Validate file type
     allowed_types = ["image/jpeg", "image/jpg", "image/png", "image/webp"]
     if file.content_type not in allowed_types:
@@ -510,24 +583,29 @@ async def upload_profile_picture(
             detail=f"File size exceeds maximum allowed size of {settings.MAX_FILE_SIZE} bytes"
         )
 
-    # Encode to base64 with data URI prefix
-    content_type = file.content_type or "image/jpeg"
-    base64_data = base64.b64encode(content).decode('utf-8')
-    data_uri = f"data:{content_type};base64,{base64_data}"
+    # Resize into full + thumbnail variants, content-addressed on disk
+    try:
+        stored = await store_image(content)
+    except InvalidImageError:
+        raise HTTPException(status_code=400, detail="Could not read image")
 
-    # Store in the appropriate slot
+    # Store the URL in the appropriate slot
     if slot == 1:
-        current_user.profile_picture_1 = data_uri
+        current_user.profile_picture_1 = stored.url
     elif slot == 2:
-        current_user.profile_picture_2 = data_uri
+        current_user.profile_picture_2 = stored.url
     else:
-        current_user.profile_picture_3 = data_uri
+        current_user.profile_picture_3 = stored.url
 
     await db.commit()
+    await invalidate_principal(current_user.id)
+    await bump_versions(user_scope(current_user.id))
 
     return {
         "success": True,
         "slot": slot,
+        "url": stored.url,
+        "thumbnail_url": stored.thumbnail_url,
         "message": f"Profile picture uploaded to slot {slot}"
     }
 
@@ -547,6 +625,8 @@ async def delete_profile_picture(
         current_user.profile_picture_3 = None
 
     await db.commit()
+    await invalidate_principal(current_user.id)
+    await bump_versions(user_scope(current_user.id))
 
     return {
         "success": True,
@@ -570,6 +650,8 @@ async def update_profile(
         current_user.profile_picture = update_data.profile_picture
 
     await db.commit()
+    await invalidate_principal(current_user.id)
+    await bump_versions(user_scope(current_user.id))
     await db.refresh(current_user)
     return current_user
 
@@ -577,7 +659,7 @@ async def update_profile(
 @router.post("/follow/{user_id}")
 async def follow_user(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Follow a user"""
@@ -605,20 +687,17 @@ async def follow_user(
     )
     is_follow_back = reverse_follow_result.scalar_one_or_none() is not None
 
-    follow = Follow(follower_id=current_user.id, following_id=user_id)
-    db.add(follow)
+    await add_follow(db, current_user.id, user_id)
     await db.commit()
-
-    # Invalidate cache for both users' stats
-    await cache_delete(f"user_stats:{user_id}")
-    await cache_delete(f"user_stats:{current_user.id}")
+    await sync_follow_graph(db)
+    await bump_versions(user_scope(current_user.id), user_scope(user_id))
 
     # Send notification
     from services.apns_service import NotificationPayload, NotificationType
     from services.tasks import send_websocket_notification
 
     actor_name = current_user.nickname or current_user.first_name or "Someone"
-    actor_pic = current_user.profile_picture or current_user.instagram_profile_pic
+    actor_pic = current_user.avatar_url
 
     if is_follow_back:
         payload = NotificationPayload(
@@ -654,7 +733,7 @@ async def follow_user(
 @router.delete("/follow/{user_id}")
 async def unfollow_user(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """Unfollow a user"""
@@ -669,20 +748,18 @@ async def unfollow_user(
     if not follow:
         raise HTTPException(status_code=404, detail="Not following this user")
 
-    await db.delete(follow)
+    await remove_follow(db, follow)
     await db.commit()
-
-    # Invalidate cache for both users' stats
-    await cache_delete(f"user_stats:{user_id}")
-    await cache_delete(f"user_stats:{current_user.id}")
+    await sync_follow_graph(db)
+    await bump_versions(user_scope(current_user.id), user_scope(user_id))
 
     return {"status": "success"}
 
 
 @router.get("/me/following", response_model=List[SimpleUserResponse])
 async def get_following(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get list of users current user is following"""
     result = await db.execute(
@@ -707,8 +784,8 @@ async def get_following(
 
 @router.get("/me/followers", response_model=List[SimpleUserResponse])
 async def get_followers(
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get list of users following current user"""
     result = await db.execute(
@@ -731,11 +808,33 @@ async def get_followers(
     ]
 
 
+@router.get("/me/following/page", response_model=FollowPageResponse)
+async def get_following_page(
+    cursor: Optional[int] = None,
+    limit: int = FOLLOW_PAGE_DEFAULT,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
+):
+    """Paginated list of users current user is following, newest first"""
+    return await get_follow_page(db, current_user.id, "following", cursor, limit)
+
+
+@router.get("/me/followers/page", response_model=FollowPageResponse)
+async def get_followers_page(
+    cursor: Optional[int] = None,
+    limit: int = FOLLOW_PAGE_DEFAULT,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
+):
+    """Paginated list of users following current user, newest first"""
+    return await get_follow_page(db, current_user.id, "followers", cursor, limit)
+
+
 @router.get("/{user_id}/following", response_model=List[SimpleUserResponse])
 async def get_user_following(
     user_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get list of users that a specific user is following"""
     # Verify user exists
@@ -766,8 +865,8 @@ async def get_user_following(
 @router.get("/{user_id}/followers", response_model=List[SimpleUserResponse])
 async def get_user_followers(
     user_id: int,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """Get list of users following a specific user"""
     # Verify user exists
@@ -795,8 +894,38 @@ async def get_user_followers(
     ]
 
 
+@router.get("/{user_id}/following/page", response_model=FollowPageResponse)
+async def get_user_following_page(
+    user_id: int,
+    cursor: Optional[int] = None,
+    limit: int = FOLLOW_PAGE_DEFAULT,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
+):
+    """Paginated list of users that a specific user is following, newest first"""
+    if (await db.execute(select(User.id).where(User.id == user_id))).scalar_one_or_none() is None:
+        raise HTTPException(status_code=404, detail="User not found")
+    return await get_follow_page(db, user_id, "following", cursor, limit)
+
+
+@router.get("/{user_id}/followers/page", response_model=FollowPageResponse)
+async def get_user_followers_page(
+    user_id: int,
+    cursor: Optional[int] = None,
+    limit: int = FOLLOW_PAGE_DEFAULT,
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
+):
+    """Paginated list of users following a specific user, newest first"""
+    if (await db.execute(select(User.id).where(User.id == user_id))).scalar_one_or_none() is None:
+        raise HTTPException(status_code=404, detail="User not found")
+    return await get_follow_page(db, user_id, "followers", cursor, limit)
+
+
 @router.get("/{user_id}/profile", response_model=ProfileResponse)
 async def get_user_profile(
+    request: Request,
+    response: Response,
     user_id: int,
     db: AsyncSession = Depends(get_async_session),
     current_user: User = Depends(get_current_user)
@@ -810,57 +939,45 @@ async def get_user_profile(
 
     Returns posts count, followers count, following count, and follow state.
     """
+    # The viewer's own version covers their follow edges and can_post
+    cached = await not_modified(
+        request, response, [user_scope(user_id), user_scope(current_user.id)], current_user.id
+    )
+    if cached:
+        return cached
+
     result = await db.execute(select(User).where(User.id == user_id))
     user = result.scalar_one_or_none()
 
     if not user:
         raise HTTPException(status_code=404, detail="User not found")
 
-    # Try to get cached stats
-    cache_key = f"user_stats:{user_id}"
-    cached_stats = await cache_get(cache_key)
-
-    if cached_stats:
-        followers_count = cached_stats["followers"]
-        following_count = cached_stats["following"]
+    # Follow state between the two users, from the follow graph when it is available
+    relation = await follow_relation(current_user.id, user_id)
+    if relation is not None:
+        is_followed, follows_back, is_close_friend = relation
+        is_mutual = is_followed and follows_back
     else:
-        # Get followers count (users following this user)
-        followers_result = await db.execute(
-            select(func.count(Follow.id)).where(Follow.following_id == user_id)
-        )
-        followers_count = followers_result.scalar() or 0
-
-        # Get following count (users this user follows)
-        following_result = await db.execute(
-            select(func.count(Follow.id)).where(Follow.follower_id == user_id)
-        )
-        following_count = following_result.scalar() or 0
-
-        # Cache stats for 5 minutes
-        await cache_set(cache_key, {
-            "followers": followers_count,
-            "following": following_count
-        }, ttl=300)
-
-    # Check if current user follows this user (and get close friend status)
-    follow_check = await db.execute(
-        select(Follow).where(
-            Follow.follower_id == current_user.id,
-            Follow.following_id == user_id
+        # Check if current user follows this user (and get close friend status)
+        follow_check = await db.execute(
+            select(Follow).where(
+                Follow.follower_id == current_user.id,
+                Follow.following_id == user_id
+            )
         )
-    )
-    follow_record = follow_check.scalar_one_or_none()
-    is_followed = follow_record is not None
-    is_close_friend = follow_record.is_close_friend if follow_record else False
-
-    # Check if this user follows current user (mutual check)
-    reverse_follow_check = await db.execute(
-        select(Follow).where(
-            Follow.follower_id == user_id,
-            Follow.following_id == current_user.id
+        follow_record = follow_check.scalar_one_or_none()
+        is_followed = follow_record is not None
+        # Same close friend definition as the graph's close_friends set
+        is_close_friend = follow_record is not None and follow_record.close_friend_status == 'accepted'
+
+        # Check if this user follows current user (mutual check)
+        reverse_follow_check = await db.execute(
+            select(Follow).where(
+                Follow.follower_id == user_id,
+                Follow.following_id == current_user.id
+            )
         )
-    )
-    is_mutual = is_followed and reverse_follow_check.scalar_one_or_none() is not None
+        is_mutual = is_followed and reverse_follow_check.scalar_one_or_none() is not None
 
     # Conditional privacy: only show phone/email to geolocated users
     can_see_private = current_user.can_post  # Geolocated at Art Basel Miami
@@ -877,8 +994,8 @@ async def get_user_profile(
         instagram_handle=user.instagram_handle,
         instagram_profile_pic=user.instagram_profile_pic,
         has_profile=user.has_profile,
-        followers_count=followers_count,
-        following_count=following_count,
+        followers_count=user.followers_count,
+        following_count=user.following_count,
         is_followed_by_current_user=is_followed,
         is_close_friend=is_close_friend,
         is_mutual=is_mutual
@@ -920,10 +1037,16 @@ async def update_location(
 
     # Check if within geofence
     can_post = distance_km <= basel_radius_km
+    can_post_changed = bool(current_user.can_post) != can_post
     current_user.can_post = can_post
 
     await db.commit()
 
+    # can_post decides which private fields this user sees on profiles
+    if can_post_changed:
+        await bump_versions(user_scope(current_user.id))
+    await bump_close_friend_viewers(db, [current_user.id])
+
     if can_post:
         return LocationResponse(
             can_post=True,
@@ -967,18 +1090,8 @@ async def delete_account(
             "files": 0
         }
 
-        # 1. Delete follows (as follower)
-        result = await db.execute(
-            delete(Follow).where(Follow.follower_id == current_user.id)
-        )
-        follow_count = result.rowcount
-
-        # Delete follows (as following)
-        result = await db.execute(
-            delete(Follow).where(Follow.following_id == current_user.id)
-        )
-        follow_count += result.rowcount
-        deleted_counts["follows"] = follow_count
+        # 1. Delete follows (as follower and following), fixing the other users' counts
+        deleted_counts["follows"] = await remove_user_follows(db, current_user.id)
 
         # 2. Delete refresh tokens
         result = await db.execute(
@@ -1032,6 +1145,12 @@ async def delete_account(
 
         # Commit all changes
         await db.commit()
+        await sync_follow_graph(db)
+        if active_checkin:
+            await sync_checkins(left=[(user_id, active_checkin.place_id)])
+        await invalidate_token_index([user_id])
+        await invalidate_principal(user_id)
+        await bump_versions(user_scope(user_id))
 
         logger.info(
             "Account deleted successfully",
@@ -1086,7 +1205,7 @@ async def get_qr_token(
 @router.get("/{user_id}/qr-token", response_model=QRTokenResponse)
 async def get_user_qr_token(
     user_id: int,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -1114,7 +1233,7 @@ async def get_user_qr_token(
 @router.post("/qr-connect", response_model=QRConnectResponse)
 async def qr_connect(
     request: QRConnectRequest,
-    current_user: User = Depends(get_current_user),
+    current_user: Principal = Depends(get_current_principal),
     db: AsyncSession = Depends(get_async_session)
 ):
     """
@@ -1148,12 +1267,11 @@ async def qr_connect(
         raise HTTPException(status_code=400, detail="Already connected")
 
     # Create mutual follows
-    follow1 = Follow(follower_id=current_user.id, following_id=target_user.id)
-    follow2 = Follow(follower_id=target_user.id, following_id=current_user.id)
-
-    db.add(follow1)
-    db.add(follow2)
+    await add_follow(db, current_user.id, target_user.id)
+    await add_follow(db, target_user.id, current_user.id)
     await db.commit()
+    await sync_follow_graph(db)
+    await bump_versions(user_scope(current_user.id), user_scope(target_user.id))
 
     return QRConnectResponse(
         success=True,
@@ -1170,12 +1288,58 @@ async def qr_connect(
     )
 
 
+USER_SEARCH_CANDIDATES = 50  # Per prefix index, before graph-aware ranking
+
+# Candidates are the first matches from each prefix index (in index order, so
+# no sort of every match) plus every match among the searcher's followers and
+# following, however far down the alphabet. Graph relations and "at the same
+# venue right now" come back as flags for ranking.
+USER_SEARCH_SQL = text("""
+    WITH my_following AS (
+        SELECT following_id AS id FROM follows WHERE follower_id = :me
+    ), my_followers AS (
+        SELECT follower_id AS id FROM follows WHERE following_id = :me
+    ), candidates AS (
+        (SELECT id FROM users
+         WHERE is_active AND lower(nickname) ~>=~ :lower_bound AND lower(nickname) ~<~ :upper_bound
+         ORDER BY lower(nickname) USING ~<~
+         LIMIT :candidates)
+        UNION
+        (SELECT id FROM users
+         WHERE is_active AND lower(instagram_handle) ~>=~ :lower_bound AND lower(instagram_handle) ~<~ :upper_bound
+         ORDER BY lower(instagram_handle) USING ~<~
+         LIMIT :candidates)
+        UNION
+        SELECT u.id FROM users u
+        JOIN (SELECT id FROM my_following UNION SELECT id FROM my_followers) g ON g.id = u.id
+        WHERE u.is_active
+          AND ((lower(u.nickname) ~>=~ :lower_bound AND lower(u.nickname) ~<~ :upper_bound)
+               OR (lower(u.instagram_handle) ~>=~ :lower_bound AND lower(u.instagram_handle) ~<~ :upper_bound))
+    ), my_venue AS (
+        SELECT place_id FROM check_ins
+        WHERE user_id = :me AND is_active = true AND place_id IS NOT NULL
+        LIMIT 1
+    )
+    SELECT u.id, u.nickname, u.first_name, u.last_name, u.profile_picture,
+           u.instagram_profile_pic, u.instagram_handle,
+           EXISTS (SELECT 1 FROM my_following f WHERE f.id = u.id) AS i_follow,
+           EXISTS (SELECT 1 FROM my_followers f WHERE f.id = u.id) AS follows_me,
+           EXISTS (
+               SELECT 1 FROM check_ins c JOIN my_venue v ON c.place_id = v.place_id
+               WHERE c.user_id = u.id AND c.is_active = true
+           ) AS same_venue
+    FROM candidates
+    JOIN users u ON u.id = candidates.id
+    WHERE u.id <> :me
+""")
+
+
 @router.get("/search", response_model=UserSearchResponse)
 async def search_users(
     q: str,
     limit: int = 10,
-    current_user: User = Depends(get_current_user),
-    db: AsyncSession = Depends(get_async_session)
+    current_user: Principal = Depends(get_current_principal),
+    db: AsyncSession = Depends(get_read_session)
 ):
     """
     Search users by nickname or Instagram handle for autocomplete.
@@ -1187,8 +1351,12 @@ async def search_users(
     - q: Search query (min 1 character). Searches both nickname and Instagram handle.
     - limit: Max results to return (default 10, max 50)
 
+    Ranking: people the caller follows (mutuals first), then people who follow
+    the caller, boosted when they are checked in at the caller's venue right
+    now and for exact matches; shorter names first otherwise.
+
     Returns:
-    - List of matching users with profile info and match_type indicator
+    - List of matching users with profile info, match_type indicator and graph flags
     """
     # Validate query
     query = q.strip().lstrip('@').lower()
@@ -1198,34 +1366,38 @@ async def search_users(
     # Cap limit to prevent abuse
     limit = min(limit, 50)
 
-    # Search for users matching nickname or instagram_handle (case-insensitive prefix match)
-    # Uses ILIKE for case-insensitive matching with wildcard suffix for autocomplete
-    search_pattern = f"{query}%"
-
-    result = await db.execute(
-        select(User)
-        .where(
-            User.is_active == True,
-            User.id != current_user.id,  # Exclude current user
-            or_(
-                func.lower(User.nickname).like(search_pattern),
-                func.lower(User.instagram_handle).like(search_pattern)
-            )
-        )
-        .order_by(
-            # Prioritize exact matches, then prefix matches
-            func.length(User.nickname).asc()
-        )
-        .limit(limit)
-    )
-    users = result.scalars().all()
+    # Prefix as a range: lower(x) ~>=~ query AND lower(x) ~<~ query with its last
+    # character incremented, which the text_pattern_ops indexes serve even
+    # under a generic prepared-statement plan (LIKE with a parameter can't)
+    result = await db.execute(USER_SEARCH_SQL, {
+        "me": current_user.id,
+        "lower_bound": query,
+        "upper_bound": query[:-1] + chr(ord(query[-1]) + 1),
+        "candidates": USER_SEARCH_CANDIDATES,
+    })
+    rows = result.all()
+
+    def rank(row) -> tuple:
+        score = 0
+        if row.i_follow and row.follows_me:
+            score += 40
+        elif row.i_follow:
+            score += 30
+        elif row.follows_me:
+            score += 15
+        if row.same_venue:
+            score += 25
+        if (row.nickname or "").lower() == query or (row.instagram_handle or "").lower() == query:
+            score += 20
+        # Then shorter (closer) matches first
+        return (-score, len(row.nickname or row.instagram_handle or ""), (row.nickname or "").lower())
 
     # Build results with match type indicator
     search_results = []
-    for user in users:
+    for row in sorted(rows, key=rank)[:limit]:
         # Determine which field matched
-        nickname_lower = (user.nickname or "").lower()
-        instagram_lower = (user.instagram_handle or "").lower()
+        nickname_lower = (row.nickname or "").lower()
+        instagram_lower = (row.instagram_handle or "").lower()
 
         if nickname_lower.startswith(query):
             match_type = "nickname"
@@ -1235,13 +1407,16 @@ async def search_users(
             match_type = "nickname"  # Fallback
 
         search_results.append(UserSearchResult(
-            id=user.id,
-            nickname=user.nickname,
-            first_name=user.first_name,
-            last_name=user.last_name,
-            profile_picture=user.profile_picture or user.instagram_profile_pic,
-            instagram_handle=user.instagram_handle,
-            match_type=match_type
+            id=row.id,
+            nickname=row.nickname,
+            first_name=row.first_name,
+            last_name=row.last_name,
+            profile_picture=row.profile_picture or row.instagram_profile_pic,
+            instagram_handle=row.instagram_handle,
+            match_type=match_type,
+            is_following=row.i_follow,
+            is_mutual=row.i_follow and row.follows_me,
+            at_same_venue=row.same_venue
         ))
 
     return UserSearchResponse(
@@ -4,7 +4,7 @@ import asyncio
 import json
 import logging
 
-from services.redis import get_redis
+from services.redis import get_redis, redis_available, REDIS_PROBE_INTERVAL_SECONDS
 
 router = APIRouter(tags=["websocket"])
 logger = logging.getLogger(__name__)
@@ -79,6 +79,10 @@ class ConnectionManager:
 
     async def broadcast(self, message: dict):
         """Broadcast to all connected clients across all instances via Redis"""
+        if not redis_available():
+            # Degraded: only this instance's clients get the message
+            await self._send_local(message)
+            return
         try:
             redis = await get_redis()
             await redis.publish(REDIS_CHANNEL_BROADCAST, json.dumps(message))
@@ -88,6 +92,9 @@ class ConnectionManager:
 
     async def send_to_user(self, user_id: int, message: dict):
         """Send to specific user across all instances via Redis"""
+        if not redis_available():
+            await self._send_local(message, user_id)
+            return user_id in self.active_connections
         try:
             redis = await get_redis()
             channel = REDIS_CHANNEL_USER.format(user_id=user_id)
@@ -147,6 +154,9 @@ class ConnectionManager:
 
     async def send_to_bounce(self, bounce_id: int, message: dict):
         """Send to all guest WebSockets for a bounce across all instances via Redis"""
+        if not redis_available():
+            await self._send_to_bounce_local(bounce_id, message)
+            return
         try:
             redis = await get_redis()
             channel = REDIS_CHANNEL_BOUNCE.format(bounce_id=bounce_id)
@@ -165,6 +175,10 @@ class ConnectionManager:
     async def _subscribe_loop(self):
         """Subscribe to Redis channels and dispatch to local connections"""
         while True:
+            if not redis_available():
+                # Sends fall back to local delivery meanwhile; resubscribe once the breaker closes
+                await asyncio.sleep(REDIS_PROBE_INTERVAL_SECONDS)
+                continue
             try:
                 redis = await get_redis()
                 pubsub = redis.pubsub()
@@ -9,6 +9,11 @@ class Settings:
     _db_url = os.getenv("DATABASE_URL", "postgresql+asyncpg://kerim@localhost:5432/artbasel_db")
     DATABASE_URL: str = _db_url.replace("postgresql://", "postgresql+asyncpg://") if _db_url.startswith("postgresql://") else _db_url
 
+    # Optional streaming read replica - read-only GET endpoints use it when set
+    _replica_url = os.getenv("DATABASE_REPLICA_URL", "")
+    DATABASE_REPLICA_URL: str = _replica_url.replace("postgresql://", "postgresql+asyncpg://") if _replica_url.startswith("postgresql://") else _replica_url
+    REPLICA_PIN_SECONDS: int = int(os.getenv("REPLICA_PIN_SECONDS", "5"))  # Users read from primary this long after a write
+
     SECRET_KEY: str = os.getenv("SECRET_KEY", "change-this-secret-key-in-production")
     ALGORITHM: str = os.getenv("ALGORITHM", "HS256")
     ACCESS_TOKEN_EXPIRE_MINUTES: int = int(os.getenv("ACCESS_TOKEN_EXPIRE_MINUTES", "60"))  # 1 hour
@@ -20,6 +25,10 @@ class Settings:
     UPLOAD_DIR: str = os.getenv("UPLOAD_DIR", "uploads")
     MAX_FILE_SIZE: int = int(os.getenv("MAX_FILE_SIZE", str(10 * 1024 * 1024)))
 
+    # Image proxy disk cache (kept outside UPLOAD_DIR, which is served publicly)
+    IMAGE_PROXY_CACHE_DIR: str = os.getenv("IMAGE_PROXY_CACHE_DIR", "image_cache")
+    IMAGE_PROXY_CACHE_MAX_BYTES: int = int(os.getenv("IMAGE_PROXY_CACHE_MAX_BYTES", str(512 * 1024 * 1024)))  # 512 MB
+
     # Apple Sign In
     APPLE_TEAM_ID: str = os.getenv("APPLE_TEAM_ID", "")
     APPLE_KEY_ID: str = os.getenv("APPLE_KEY_ID", "")
@@ -59,6 +68,10 @@ class Settings:
     APNS_TEAM_ID: str = os.getenv("APNS_TEAM_ID", "") or os.getenv("APPLE_TEAM_ID", "")  # Team ID
     APNS_BUNDLE_ID: str = os.getenv("APNS_BUNDLE_ID", "com.theappagency.lit")  # App bundle ID
     APNS_USE_SANDBOX: bool = os.getenv("APNS_USE_SANDBOX", "false").lower() == "true"
+    # Overrides the Apple host, e.g. http://127.0.0.1:2197 for scripts/mock_apns_server.py
+    APNS_BASE_URL: str = os.getenv("APNS_BASE_URL", "")
+    DEVICE_TOKEN_STALE_DAYS: int = int(os.getenv("DEVICE_TOKEN_STALE_DAYS", "90"))  # Prune tokens unused this long
+    DEVICE_TOKEN_MAX_FAILURES: int = int(os.getenv("DEVICE_TOKEN_MAX_FAILURES", "5"))  # Deactivate after N transient failures
 
     # Instagram 2FA Verification
     IG_USERNAME: str = os.getenv("IG_USERNAME", "")
@@ -0,0 +1,425 @@
+"""baseline schema
+
+Everything create_db_and_tables + run_migrations used to do on every worker
+boot, run once. Safe on both an empty database and one that was built by the
+old boot-time DDL: a table (with its indexes) is only created if missing, as
+create_all(checkfirst=True) did, and every statement after that is
+IF NOT EXISTS.
+
+The table DDL is frozen here as of this revision rather than generated from
+db.models, so a fresh database gets exactly this schema and later revisions
+apply on top of it the same way they do on existing databases. Columns that
+STATEMENTS adds to older databases carry the same server defaults here.
+
+Revision ID: 0001
+Revises:
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+import sqlalchemy as sa
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0001"
+down_revision: Union[str, None] = None
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+# Never created by the old create_all (create_type=False on the model)
+CREATE_CLOSE_FRIEND_STATUS = """
+DO $$
+BEGIN
+    CREATE TYPE close_friend_status AS ENUM ('none', 'pending', 'accepted');
+EXCEPTION WHEN duplicate_object THEN NULL;
+END $$
+"""
+
+# (table, [CREATE TABLE, its indexes...]) in dependency order
+TABLES = [
+    ("anonymous_locations", [
+        """
+        CREATE TABLE anonymous_locations (
+            location_id UUID NOT NULL,
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            last_updated TIMESTAMP WITH TIME ZONE DEFAULT now() NOT NULL,
+            PRIMARY KEY (location_id)
+        )
+        """,
+        "CREATE INDEX ix_anonymous_locations_last_updated ON anonymous_locations (last_updated)",
+    ]),
+    ("places", [
+        """
+        CREATE TABLE places (
+            id SERIAL NOT NULL,
+            place_id VARCHAR(255) NOT NULL,
+            name VARCHAR(255) NOT NULL,
+            address VARCHAR(500),
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            types TEXT,
+            bounce_count INTEGER NOT NULL DEFAULT 0,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            updated_at TIMESTAMP WITH TIME ZONE,
+            PRIMARY KEY (id)
+        )
+        """,
+        "CREATE INDEX ix_places_id ON places (id)",
+        "CREATE UNIQUE INDEX ix_places_place_id ON places (place_id)",
+    ]),
+    ("users", [
+        """
+        CREATE TABLE users (
+            id SERIAL NOT NULL,
+            apple_user_id VARCHAR(255) NOT NULL,
+            first_name VARCHAR(100),
+            last_name VARCHAR(100),
+            nickname VARCHAR(50),
+            employer VARCHAR(200),
+            phone VARCHAR(20),
+            email VARCHAR(255),
+            profile_picture VARCHAR,
+            profile_picture_1 TEXT,
+            profile_picture_2 TEXT,
+            profile_picture_3 TEXT,
+            instagram_handle VARCHAR(30),
+            phone_visible BOOLEAN NOT NULL,
+            email_visible BOOLEAN NOT NULL,
+            can_post BOOLEAN NOT NULL,
+            last_location_lat FLOAT,
+            last_location_lon FLOAT,
+            last_location_update TIMESTAMP WITH TIME ZONE,
+            qr_token VARCHAR(64),
+            instagram_profile_pic TEXT,
+            linkedin_handle VARCHAR(100),
+            username VARCHAR(50),
+            bio VARCHAR(500),
+            refresh_token VARCHAR(500),
+            is_active BOOLEAN,
+            is_admin BOOLEAN NOT NULL DEFAULT FALSE,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            updated_at TIMESTAMP WITH TIME ZONE,
+            PRIMARY KEY (id)
+        )
+        """,
+        "CREATE UNIQUE INDEX ix_users_apple_user_id ON users (apple_user_id)",
+        "CREATE INDEX ix_users_id ON users (id)",
+        "CREATE INDEX ix_users_nickname ON users (nickname)",
+        "CREATE UNIQUE INDEX ix_users_qr_token ON users (qr_token)",
+    ]),
+    ("bounces", [
+        """
+        CREATE TABLE bounces (
+            id SERIAL NOT NULL,
+            creator_id INTEGER NOT NULL,
+            places_fk_id INTEGER,
+            venue_name VARCHAR(255) NOT NULL,
+            venue_address VARCHAR(500),
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            place_id VARCHAR(255),
+            bounce_time TIMESTAMP WITH TIME ZONE NOT NULL,
+            is_now BOOLEAN NOT NULL,
+            is_public BOOLEAN NOT NULL,
+            message VARCHAR(500),
+            status VARCHAR(20) NOT NULL,
+            share_token VARCHAR(64),
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(creator_id) REFERENCES users (id) ON DELETE CASCADE,
+            FOREIGN KEY(places_fk_id) REFERENCES places (id) ON DELETE SET NULL
+        )
+        """,
+        "CREATE INDEX ix_bounces_created_at ON bounces (created_at)",
+        "CREATE INDEX ix_bounces_creator_id ON bounces (creator_id)",
+        "CREATE INDEX ix_bounces_id ON bounces (id)",
+        "CREATE INDEX ix_bounces_place_id ON bounces (place_id)",
+        "CREATE INDEX ix_bounces_places_fk_id ON bounces (places_fk_id)",
+        "CREATE UNIQUE INDEX ix_bounces_share_token ON bounces (share_token)",
+        "CREATE INDEX ix_bounces_status ON bounces (status)",
+    ]),
+    ("check_in_history", [
+        """
+        CREATE TABLE check_in_history (
+            id SERIAL NOT NULL,
+            user_id INTEGER NOT NULL,
+            place_id VARCHAR(255) NOT NULL,
+            places_fk_id INTEGER,
+            venue_name VARCHAR(255) NOT NULL,
+            venue_address VARCHAR(500),
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            checked_in_at TIMESTAMP WITH TIME ZONE DEFAULT now() NOT NULL,
+            checked_out_at TIMESTAMP WITH TIME ZONE,
+            PRIMARY KEY (id),
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE,
+            FOREIGN KEY(places_fk_id) REFERENCES places (id) ON DELETE SET NULL
+        )
+        """,
+        "CREATE INDEX ix_check_in_history_checked_in_at ON check_in_history (checked_in_at)",
+        "CREATE INDEX ix_check_in_history_id ON check_in_history (id)",
+        "CREATE INDEX ix_check_in_history_place_id ON check_in_history (place_id)",
+        "CREATE INDEX ix_check_in_history_places_fk_id ON check_in_history (places_fk_id)",
+        "CREATE INDEX ix_check_in_history_user_id ON check_in_history (user_id)",
+    ]),
+    ("check_ins", [
+        """
+        CREATE TABLE check_ins (
+            id SERIAL NOT NULL,
+            user_id INTEGER NOT NULL,
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            location_name VARCHAR(255),
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            place_id VARCHAR(255),
+            places_fk_id INTEGER,
+            last_seen_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            is_active BOOLEAN DEFAULT TRUE,
+            PRIMARY KEY (id),
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE,
+            FOREIGN KEY(places_fk_id) REFERENCES places (id) ON DELETE SET NULL
+        )
+        """,
+        "CREATE INDEX ix_check_ins_created_at ON check_ins (created_at)",
+        "CREATE INDEX ix_check_ins_id ON check_ins (id)",
+        "CREATE INDEX ix_check_ins_place_id ON check_ins (place_id)",
+        "CREATE INDEX ix_check_ins_places_fk_id ON check_ins (places_fk_id)",
+        "CREATE INDEX ix_check_ins_user_id ON check_ins (user_id)",
+    ]),
+    ("device_tokens", [
+        """
+        CREATE TABLE device_tokens (
+            id SERIAL NOT NULL,
+            user_id INTEGER NOT NULL,
+            device_token VARCHAR(255) NOT NULL,
+            device_name VARCHAR(100),
+            platform VARCHAR(20),
+            is_sandbox BOOLEAN,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            updated_at TIMESTAMP WITH TIME ZONE,
+            last_used_at TIMESTAMP WITH TIME ZONE,
+            is_active BOOLEAN,
+            failure_score INTEGER NOT NULL DEFAULT 0,
+            PRIMARY KEY (id),
+            CONSTRAINT uq_user_device_token UNIQUE (user_id, device_token),
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_device_tokens_id ON device_tokens (id)",
+        "CREATE INDEX ix_device_tokens_is_active ON device_tokens (is_active)",
+        "CREATE INDEX ix_device_tokens_user_id ON device_tokens (user_id)",
+    ]),
+    ("follows", [
+        """
+        CREATE TABLE follows (
+            id SERIAL NOT NULL,
+            follower_id INTEGER NOT NULL,
+            following_id INTEGER NOT NULL,
+            is_close_friend BOOLEAN NOT NULL DEFAULT FALSE,
+            close_friend_status close_friend_status NOT NULL,
+            close_friend_requester_id INTEGER,
+            is_sharing_location BOOLEAN NOT NULL,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(follower_id) REFERENCES users (id) ON DELETE CASCADE,
+            FOREIGN KEY(following_id) REFERENCES users (id) ON DELETE CASCADE,
+            FOREIGN KEY(close_friend_requester_id) REFERENCES users (id) ON DELETE SET NULL
+        )
+        """,
+        "CREATE INDEX ix_follows_follower_id ON follows (follower_id)",
+        "CREATE INDEX ix_follows_following_id ON follows (following_id)",
+        "CREATE INDEX ix_follows_id ON follows (id)",
+    ]),
+    ("google_pics", [
+        """
+        CREATE TABLE google_pics (
+            id SERIAL NOT NULL,
+            place_id INTEGER NOT NULL,
+            photo_reference VARCHAR(500) NOT NULL,
+            photo_url TEXT,
+            width INTEGER,
+            height INTEGER,
+            attributions TEXT,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(place_id) REFERENCES places (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_google_pics_id ON google_pics (id)",
+        "CREATE INDEX ix_google_pics_place_id ON google_pics (place_id)",
+    ]),
+    ("notification_preferences", [
+        """
+        CREATE TABLE notification_preferences (
+            id SERIAL NOT NULL,
+            user_id INTEGER NOT NULL,
+            bounce_invites BOOLEAN,
+            new_followers BOOLEAN,
+            follow_backs BOOLEAN,
+            friends_at_same_venue BOOLEAN,
+            friends_leaving_venue BOOLEAN,
+            close_friend_checkins BOOLEAN,
+            push_enabled BOOLEAN,
+            updated_at TIMESTAMP WITH TIME ZONE,
+            PRIMARY KEY (id),
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_notification_preferences_id ON notification_preferences (id)",
+        "CREATE UNIQUE INDEX ix_notification_preferences_user_id ON notification_preferences (user_id)",
+    ]),
+    ("refresh_tokens", [
+        """
+        CREATE TABLE refresh_tokens (
+            id SERIAL NOT NULL,
+            user_id INTEGER NOT NULL,
+            token VARCHAR(500) NOT NULL,
+            expires_at TIMESTAMP WITH TIME ZONE NOT NULL,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_refresh_tokens_id ON refresh_tokens (id)",
+        "CREATE UNIQUE INDEX ix_refresh_tokens_token ON refresh_tokens (token)",
+        "CREATE INDEX ix_refresh_tokens_user_id ON refresh_tokens (user_id)",
+    ]),
+    ("bounce_attendees", [
+        """
+        CREATE TABLE bounce_attendees (
+            id SERIAL NOT NULL,
+            bounce_id INTEGER NOT NULL,
+            user_id INTEGER NOT NULL,
+            joined_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            last_seen_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(bounce_id) REFERENCES bounces (id) ON DELETE CASCADE,
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_bounce_attendees_bounce_id ON bounce_attendees (bounce_id)",
+        "CREATE INDEX ix_bounce_attendees_id ON bounce_attendees (id)",
+        "CREATE INDEX ix_bounce_attendees_last_seen_at ON bounce_attendees (last_seen_at)",
+        "CREATE INDEX ix_bounce_attendees_user_id ON bounce_attendees (user_id)",
+    ]),
+    ("bounce_guest_locations", [
+        """
+        CREATE TABLE bounce_guest_locations (
+            id SERIAL NOT NULL,
+            bounce_id INTEGER NOT NULL,
+            guest_id VARCHAR(64) NOT NULL,
+            display_name VARCHAR(100) NOT NULL,
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            is_sharing BOOLEAN NOT NULL,
+            is_connected BOOLEAN DEFAULT 'false' NOT NULL,
+            updated_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            CONSTRAINT uq_bounce_guest_location UNIQUE (bounce_id, guest_id),
+            FOREIGN KEY(bounce_id) REFERENCES bounces (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_bounce_guest_locations_bounce_id ON bounce_guest_locations (bounce_id)",
+        "CREATE INDEX ix_bounce_guest_locations_id ON bounce_guest_locations (id)",
+    ]),
+    ("bounce_invites", [
+        """
+        CREATE TABLE bounce_invites (
+            id SERIAL NOT NULL,
+            bounce_id INTEGER NOT NULL,
+            user_id INTEGER NOT NULL,
+            status VARCHAR(50) NOT NULL,
+            created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            FOREIGN KEY(bounce_id) REFERENCES bounces (id) ON DELETE CASCADE,
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_bounce_invites_bounce_id ON bounce_invites (bounce_id)",
+        "CREATE INDEX ix_bounce_invites_id ON bounce_invites (id)",
+        "CREATE INDEX ix_bounce_invites_user_id ON bounce_invites (user_id)",
+    ]),
+    ("bounce_location_shares", [
+        """
+        CREATE TABLE bounce_location_shares (
+            id SERIAL NOT NULL,
+            bounce_id INTEGER NOT NULL,
+            user_id INTEGER NOT NULL,
+            latitude FLOAT NOT NULL,
+            longitude FLOAT NOT NULL,
+            is_sharing BOOLEAN NOT NULL,
+            updated_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+            PRIMARY KEY (id),
+            CONSTRAINT uq_bounce_user_location UNIQUE (bounce_id, user_id),
+            FOREIGN KEY(bounce_id) REFERENCES bounces (id) ON DELETE CASCADE,
+            FOREIGN KEY(user_id) REFERENCES users (id) ON DELETE CASCADE
+        )
+        """,
+        "CREATE INDEX ix_bounce_location_shares_bounce_id ON bounce_location_shares (bounce_id)",
+        "CREATE INDEX ix_bounce_location_shares_id ON bounce_location_shares (id)",
+        "CREATE INDEX ix_bounce_location_shares_updated_at ON bounce_location_shares (updated_at)",
+        "CREATE INDEX ix_bounce_location_shares_user_id ON bounce_location_shares (user_id)",
+    ]),
+]
+
+STATEMENTS = [
+    # Users table
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS instagram_handle VARCHAR(30)",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS instagram_profile_pic TEXT",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS linkedin_handle VARCHAR(100)",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_1 TEXT",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_2 TEXT",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_3 TEXT",
+    # Places table
+    "ALTER TABLE places ADD COLUMN IF NOT EXISTS bounce_count INTEGER DEFAULT 0",
+    "ALTER TABLE places ADD COLUMN IF NOT EXISTS updated_at TIMESTAMP WITH TIME ZONE",
+    # Bounces table
+    "ALTER TABLE bounces ADD COLUMN IF NOT EXISTS place_id INTEGER REFERENCES places(id) ON DELETE SET NULL",
+    # Check-ins table
+    "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS place_id VARCHAR(255)",
+    "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS places_fk_id INTEGER REFERENCES places(id) ON DELETE SET NULL",
+    "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS last_seen_at TIMESTAMP WITH TIME ZONE DEFAULT NOW()",
+    "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS is_active BOOLEAN DEFAULT TRUE",
+    # Indexes
+    "CREATE INDEX IF NOT EXISTS ix_bounces_place_id ON bounces(place_id)",
+    "CREATE INDEX IF NOT EXISTS idx_checkins_place_id ON check_ins(place_id)",
+    "CREATE INDEX IF NOT EXISTS idx_checkins_places_fk ON check_ins(places_fk_id)",
+    "CREATE INDEX IF NOT EXISTS idx_checkins_last_seen ON check_ins(last_seen_at)",
+    "CREATE INDEX IF NOT EXISTS idx_checkins_active ON check_ins(is_active) WHERE is_active = true",
+    # Follows table - close friend feature
+    "ALTER TABLE follows ADD COLUMN IF NOT EXISTS is_close_friend BOOLEAN DEFAULT FALSE",
+    # Performance indexes for high-traffic queries
+    "CREATE INDEX IF NOT EXISTS idx_follows_follower_following ON follows(follower_id, following_id)",
+    "CREATE INDEX IF NOT EXISTS idx_device_tokens_user_active ON device_tokens(user_id, is_active) WHERE is_active = true",
+    # Admin dashboard
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS is_admin BOOLEAN NOT NULL DEFAULT FALSE",
+    "CREATE INDEX IF NOT EXISTS idx_users_is_admin ON users(is_admin) WHERE is_admin = TRUE",
+    # Bounce share link
+    "ALTER TABLE bounces ADD COLUMN IF NOT EXISTS share_token VARCHAR(64) UNIQUE",
+    "CREATE UNIQUE INDEX IF NOT EXISTS idx_bounces_share_token ON bounces(share_token)",
+    # Device token lifecycle
+    "ALTER TABLE device_tokens ADD COLUMN IF NOT EXISTS failure_score INTEGER NOT NULL DEFAULT 0",
+    "CREATE INDEX IF NOT EXISTS idx_device_tokens_token ON device_tokens(device_token)",
+    "CREATE INDEX IF NOT EXISTS idx_device_tokens_last_activity ON device_tokens((COALESCE(last_used_at, updated_at, created_at)))",
+]
+
+
+def upgrade() -> None:
+    # Offline (--sql) runs have nothing to inspect and emit the full schema
+    existing = set() if op.get_context().as_sql else set(sa.inspect(op.get_bind()).get_table_names())
+    op.execute(CREATE_CLOSE_FRIEND_STATUS)
+    for table, statements in TABLES:
+        if table in existing:
+            continue
+        for statement in statements:
+            op.execute(statement)
+    for statement in STATEMENTS:
+        op.execute(statement)
+
+
+def downgrade() -> None:
+    # Nothing older to go back to
+    pass
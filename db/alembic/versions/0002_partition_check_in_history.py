@@ -0,0 +1,119 @@
+"""partition check_in_history by month
+
+Converts check_in_history into a table range-partitioned on checked_in_at with
+one partition per calendar month (check_in_history_YYYY_MM, UTC bounds) plus
+check_in_history_default for anything outside the created months. Existing
+rows are copied across once and the id sequence is carried over.
+
+History reads page by (checked_in_at, id) on the new composite indexes, so a
+deep page costs the same as the first one.
+
+ensure_check_in_history_partitions(from, months_ahead) creates any missing
+monthly partitions; db.database.ensure_history_partitions() calls it on every
+deploy to keep PARTITION_MONTHS_AHEAD months ready.
+
+Revision ID: 0002
+Revises: 0001
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0002"
+down_revision: Union[str, None] = "0001"
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+ENSURE_PARTITIONS_FUNCTION = """
+CREATE OR REPLACE FUNCTION ensure_check_in_history_partitions(from_ts TIMESTAMPTZ, months_ahead INTEGER)
+RETURNS INTEGER LANGUAGE plpgsql AS $$
+DECLARE
+    month_start TIMESTAMP := date_trunc('month', LEAST(from_ts, NOW()) AT TIME ZONE 'UTC');
+    last_month TIMESTAMP := date_trunc('month', NOW() AT TIME ZONE 'UTC') + make_interval(months => months_ahead);
+    partition_name TEXT;
+    created INTEGER := 0;
+BEGIN
+    WHILE month_start <= last_month LOOP
+        partition_name := 'check_in_history_' || to_char(month_start, 'YYYY_MM');
+        IF to_regclass(partition_name) IS NULL THEN
+            EXECUTE format(
+                'CREATE TABLE %I PARTITION OF check_in_history FOR VALUES FROM (%L) TO (%L)',
+                partition_name,
+                month_start AT TIME ZONE 'UTC',
+                (month_start + INTERVAL '1 month') AT TIME ZONE 'UTC'
+            );
+            created := created + 1;
+        END IF;
+        month_start := month_start + INTERVAL '1 month';
+    END LOOP;
+    RETURN created;
+END $$
+"""
+
+# Old table is renamed aside, rows are copied into the partitioned table, then
+# it is dropped. Skipped when the table is already partitioned.
+CONVERT_TO_PARTITIONED = """
+DO $$
+DECLARE
+    oldest TIMESTAMPTZ;
+BEGIN
+    IF (SELECT relkind FROM pg_class WHERE oid = to_regclass('check_in_history')) = 'r' THEN
+        ALTER TABLE check_in_history RENAME TO check_in_history_unpartitioned;
+        ALTER INDEX check_in_history_pkey RENAME TO check_in_history_unpartitioned_pkey;
+
+        CREATE TABLE check_in_history (
+            id INTEGER NOT NULL DEFAULT nextval('check_in_history_id_seq'),
+            user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+            place_id VARCHAR(255) NOT NULL,
+            places_fk_id INTEGER REFERENCES places(id) ON DELETE SET NULL,
+            venue_name VARCHAR(255) NOT NULL,
+            venue_address VARCHAR(500),
+            latitude DOUBLE PRECISION NOT NULL,
+            longitude DOUBLE PRECISION NOT NULL,
+            checked_in_at TIMESTAMP WITH TIME ZONE NOT NULL DEFAULT NOW(),
+            checked_out_at TIMESTAMP WITH TIME ZONE,
+            PRIMARY KEY (id, checked_in_at)
+        ) PARTITION BY RANGE (checked_in_at);
+
+        SELECT MIN(checked_in_at) INTO oldest FROM check_in_history_unpartitioned;
+        PERFORM ensure_check_in_history_partitions(COALESCE(oldest, NOW()), 12);
+        CREATE TABLE IF NOT EXISTS check_in_history_default PARTITION OF check_in_history DEFAULT;
+
+        INSERT INTO check_in_history (id, user_id, place_id, places_fk_id, venue_name, venue_address,
+                                      latitude, longitude, checked_in_at, checked_out_at)
+        SELECT id, user_id, place_id, places_fk_id, venue_name, venue_address,
+               latitude, longitude, checked_in_at, checked_out_at
+        FROM check_in_history_unpartitioned;
+
+        -- Keep the sequence when its old owner goes away
+        ALTER SEQUENCE check_in_history_id_seq OWNED BY check_in_history.id;
+        DROP TABLE check_in_history_unpartitioned;
+    END IF;
+END $$
+"""
+
+STATEMENTS = [
+    "SELECT ensure_check_in_history_partitions(NOW(), 12)",
+    "CREATE TABLE IF NOT EXISTS check_in_history_default PARTITION OF check_in_history DEFAULT",
+    # Created on the parent, so every partition gets them
+    "CREATE INDEX IF NOT EXISTS ix_check_in_history_user_checked_in ON check_in_history(user_id, checked_in_at, id)",
+    "CREATE INDEX IF NOT EXISTS ix_check_in_history_place_checked_in ON check_in_history(place_id, checked_in_at, id)",
+    "CREATE INDEX IF NOT EXISTS ix_check_in_history_places_fk_id ON check_in_history(places_fk_id)",
+    "CREATE INDEX IF NOT EXISTS ix_check_in_history_checked_in_at ON check_in_history(checked_in_at)",
+]
+
+
+def upgrade() -> None:
+    op.execute(ENSURE_PARTITIONS_FUNCTION)
+    op.execute(CONVERT_TO_PARTITIONED)
+    for statement in STATEMENTS:
+        op.execute(statement)
+
+
+def downgrade() -> None:
+    # Partitioned -> plain table would be another full copy; not supported
+    raise NotImplementedError("check_in_history partitioning cannot be downgraded")
@@ -0,0 +1,30 @@
+"""follow list keyset indexes
+
+Composite (following_id, id) and (follower_id, id) indexes so paginated
+follower/following lists seek straight to the page instead of sorting every
+follow of a popular account.
+
+Revision ID: 0003
+Revises: 0002
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0003"
+down_revision: Union[str, None] = "0002"
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+def upgrade() -> None:
+    op.execute("CREATE INDEX IF NOT EXISTS ix_follows_following_id_id ON follows(following_id, id)")
+    op.execute("CREATE INDEX IF NOT EXISTS ix_follows_follower_id_id ON follows(follower_id, id)")
+
+
+def downgrade() -> None:
+    op.execute("DROP INDEX IF EXISTS ix_follows_follower_id_id")
+    op.execute("DROP INDEX IF EXISTS ix_follows_following_id_id")
@@ -0,0 +1,47 @@
+"""denormalized follow counters on users
+
+users.followers_count / users.following_count, kept in step by
+services/follow_graph.py, so profile reads never aggregate follows.
+Backfilled from follows here; scripts/reconcile_follow_counts.py repeats the
+backfill if the counters ever drift.
+
+Revision ID: 0004
+Revises: 0003
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0004"
+down_revision: Union[str, None] = "0003"
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+STATEMENTS = [
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS followers_count INTEGER NOT NULL DEFAULT 0",
+    "ALTER TABLE users ADD COLUMN IF NOT EXISTS following_count INTEGER NOT NULL DEFAULT 0",
+    """
+    UPDATE users u SET followers_count = c.n
+    FROM (SELECT following_id AS id, COUNT(*) AS n FROM follows GROUP BY following_id) c
+    WHERE u.id = c.id
+    """,
+    """
+    UPDATE users u SET following_count = c.n
+    FROM (SELECT follower_id AS id, COUNT(*) AS n FROM follows GROUP BY follower_id) c
+    WHERE u.id = c.id
+    """,
+]
+
+
+def upgrade() -> None:
+    for statement in STATEMENTS:
+        op.execute(statement)
+
+
+def downgrade() -> None:
+    op.execute("ALTER TABLE users DROP COLUMN IF EXISTS following_count")
+    op.execute("ALTER TABLE users DROP COLUMN IF EXISTS followers_count")
@@ -0,0 +1,49 @@
+"""unique bounce invites per user
+
+One invite per (bounce_id, user_id), so invites can be bulk inserted with
+ON CONFLICT DO NOTHING. Duplicate invites left by the old check-then-insert
+code are removed first, keeping the oldest row.
+
+Revision ID: 0005
+Revises: 0004
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0005"
+down_revision: Union[str, None] = "0004"
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+STATEMENTS = [
+    """
+    DELETE FROM bounce_invites a
+    USING bounce_invites b
+    WHERE a.bounce_id = b.bounce_id
+      AND a.user_id = b.user_id
+      AND a.id > b.id
+    """,
+    """
+    DO $$
+    BEGIN
+        IF NOT EXISTS (SELECT 1 FROM pg_constraint WHERE conname = 'uq_bounce_invite_user') THEN
+            ALTER TABLE bounce_invites
+                ADD CONSTRAINT uq_bounce_invite_user UNIQUE (bounce_id, user_id);
+        END IF;
+    END $$
+    """,
+]
+
+
+def upgrade() -> None:
+    for statement in STATEMENTS:
+        op.execute(statement)
+
+
+def downgrade() -> None:
+    op.execute("ALTER TABLE bounce_invites DROP CONSTRAINT IF EXISTS uq_bounce_invite_user")
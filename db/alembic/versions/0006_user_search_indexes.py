@@ -0,0 +1,55 @@
+"""user search prefix indexes
+
+Expression indexes on lower(nickname) and lower(instagram_handle) with
+text_pattern_ops, limited to active users, so /users/search prefix lookups
+are an index range scan instead of a scan of users.
+
+Built CONCURRENTLY outside the migration transaction so writes to users
+(logins, profile and counter updates) aren't blocked for the whole build. A
+build that fails midway leaves an INVALID index that IF NOT EXISTS would
+skip, so it is dropped first.
+
+Revision ID: 0006
+Revises: 0005
+Create Date: 2026-10-16 00:00:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+
+# revision identifiers, used by Alembic.
+revision: str = "0006"
+down_revision: Union[str, None] = "0005"
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+INDEXES = {
+    "ix_users_nickname_prefix": "users (lower(nickname) text_pattern_ops) WHERE is_active",
+    "ix_users_instagram_handle_prefix": "users (lower(instagram_handle) text_pattern_ops) WHERE is_active",
+}
+
+DROP_INVALID = """
+DO $$
+BEGIN
+    IF EXISTS (
+        SELECT 1 FROM pg_index WHERE indexrelid = to_regclass('{name}') AND NOT indisvalid
+    ) THEN
+        DROP INDEX {name};
+    END IF;
+END $$
+"""
+
+
+def upgrade() -> None:
+    with op.get_context().autocommit_block():
+        for name, definition in INDEXES.items():
+            op.execute(DROP_INVALID.format(name=name))
+            op.execute(f"CREATE INDEX CONCURRENTLY IF NOT EXISTS {name} ON {definition}")
+
+
+def downgrade() -> None:
+    with op.get_context().autocommit_block():
+        for name in reversed(list(INDEXES)):
+            op.execute(f"DROP INDEX CONCURRENTLY IF EXISTS {name}")
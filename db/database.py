@@ -1,12 +1,23 @@
+import logging
+from pathlib import Path
 from sqlalchemy.ext.asyncio import AsyncSession, create_async_engine
 from sqlalchemy.orm import sessionmaker, declarative_base
 from typing import AsyncGenerator
 from core.config import settings
 
+logger = logging.getLogger(__name__)
+
+ALEMBIC_INI = Path(__file__).resolve().parent.parent / "alembic.ini"
+
+# Monthly check_in_history partitions kept ready beyond the current month
+PARTITION_MONTHS_AHEAD = 12
+
 DATABASE_URL = settings.DATABASE_URL
 
 engine = None
 async_session_maker = None
+replica_engine = None
+replica_session_maker = None
 Base = declarative_base()
 
 
@@ -34,66 +45,97 @@ def get_session_maker():
     return async_session_maker
 
 
-async def create_db_and_tables():
-    from . import models
-    engine = get_engine()
-    async with engine.begin() as conn:
-        await conn.run_sync(Base.metadata.create_all)
+def _alembic_config():
+    from alembic.config import Config
+
+    config = Config(str(ALEMBIC_INI))
+    # Absolute, so scripts can run from any working directory
+    config.set_main_option("script_location", str(ALEMBIC_INI.parent / "db" / "alembic"))
+    return config
+
+
+def get_schema_head() -> str:
+    """Latest revision in db/alembic/versions - what the code expects the DB to be at"""
+    from alembic.script import ScriptDirectory
+
+    return ScriptDirectory.from_config(_alembic_config()).get_current_head()
+
+
+def upgrade_schema(revision: str = "head") -> None:
+    """
+    Apply pending Alembic migrations. Synchronous (Alembic drives its own event
+    loop) - from async code use `await asyncio.to_thread(upgrade_schema)`.
+    """
+    from alembic import command
 
-    # Run migrations for new columns
-    await run_migrations()
+    command.upgrade(_alembic_config(), revision)
 
 
-async def run_migrations():
-    """Run any pending column additions"""
+async def ensure_history_partitions(months_ahead: int = PARTITION_MONTHS_AHEAD) -> int:
+    """
+    Create any missing monthly check_in_history partitions up to months_ahead
+    from now. Run once per deploy next to the migrations. Returns partitions created.
+    """
+    from sqlalchemy import text
+    from sqlalchemy.pool import NullPool
+
+    # Own engine - this runs under a short-lived event loop in startup.py
+    maintenance_engine = create_async_engine(DATABASE_URL, poolclass=NullPool)
+    try:
+        async with maintenance_engine.begin() as conn:
+            result = await conn.execute(
+                text("SELECT ensure_check_in_history_partitions(NOW(), :months)"),
+                {"months": months_ahead}
+            )
+            return result.scalar() or 0
+    finally:
+        await maintenance_engine.dispose()
+
+
+async def check_schema_version() -> bool:
+    """
+    Compare the database's alembic_version stamp with the code's head revision.
+
+    Read-only: workers never run DDL. Migrations are applied once per deploy by
+    startup.py (or `alembic upgrade head`) before the server starts.
+    """
     from sqlalchemy import text
 
-    migrations = [
-        # Users table
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS instagram_handle VARCHAR(30)",
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS instagram_profile_pic TEXT",
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS linkedin_handle VARCHAR(100)",
-        # Profile pictures (base64 stored in DB)
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_1 TEXT",
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_2 TEXT",
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS profile_picture_3 TEXT",
-        # Places table
-        "ALTER TABLE places ADD COLUMN IF NOT EXISTS bounce_count INTEGER DEFAULT 0",
-        "ALTER TABLE places ADD COLUMN IF NOT EXISTS updated_at TIMESTAMP WITH TIME ZONE",
-        # Bounces table
-        "ALTER TABLE bounces ADD COLUMN IF NOT EXISTS place_id INTEGER REFERENCES places(id) ON DELETE SET NULL",
-        # Check-ins table
-        "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS place_id VARCHAR(255)",
-        "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS places_fk_id INTEGER REFERENCES places(id) ON DELETE SET NULL",
-        "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS last_seen_at TIMESTAMP WITH TIME ZONE DEFAULT NOW()",
-        "ALTER TABLE check_ins ADD COLUMN IF NOT EXISTS is_active BOOLEAN DEFAULT TRUE",
-        # Indexes
-        "CREATE INDEX IF NOT EXISTS ix_bounces_place_id ON bounces(place_id)",
-        "CREATE INDEX IF NOT EXISTS idx_checkins_place_id ON check_ins(place_id)",
-        "CREATE INDEX IF NOT EXISTS idx_checkins_places_fk ON check_ins(places_fk_id)",
-        "CREATE INDEX IF NOT EXISTS idx_checkins_last_seen ON check_ins(last_seen_at)",
-        "CREATE INDEX IF NOT EXISTS idx_checkins_active ON check_ins(is_active) WHERE is_active = true",
-        # Follows table - close friend feature
-        "ALTER TABLE follows ADD COLUMN IF NOT EXISTS is_close_friend BOOLEAN DEFAULT FALSE",
-        # Performance indexes for high-traffic queries
-        "CREATE INDEX IF NOT EXISTS idx_follows_follower_following ON follows(follower_id, following_id)",
-        "CREATE INDEX IF NOT EXISTS idx_device_tokens_user_active ON device_tokens(user_id, is_active) WHERE is_active = true",
-        # Admin dashboard
-        "ALTER TABLE users ADD COLUMN IF NOT EXISTS is_admin BOOLEAN NOT NULL DEFAULT FALSE",
-        "CREATE INDEX IF NOT EXISTS idx_users_is_admin ON users(is_admin) WHERE is_admin = TRUE",
-        # Bounce share link
-        "ALTER TABLE bounces ADD COLUMN IF NOT EXISTS share_token VARCHAR(64) UNIQUE",
-        "CREATE UNIQUE INDEX IF NOT EXISTS idx_bounces_share_token ON bounces(share_token)",
-    ]
-
-    engine = get_engine()
-    async with engine.begin() as conn:
-        for migration in migrations:
-            try:
-                await conn.execute(text(migration))
-            except Exception as e:
-                # Column might already exist or other non-critical error
-                pass
+    expected = get_schema_head()
+    async with get_engine().connect() as conn:
+        try:
+            current = (await conn.execute(text("SELECT version_num FROM alembic_version"))).scalar()
+        except Exception:
+            current = None
+
+    if current != expected:
+        logger.error(
+            f"Database schema is at revision {current or 'none'}, code expects {expected} "
+            f"- run `alembic upgrade head`"
+        )
+        return False
+    return True
+
+
+def get_replica_session_maker():
+    """Session maker for the read replica; the primary's when no replica is configured"""
+    global replica_engine, replica_session_maker
+    if not settings.DATABASE_REPLICA_URL:
+        return get_session_maker()
+    if replica_session_maker is None:
+        replica_engine = create_async_engine(
+            settings.DATABASE_REPLICA_URL,
+            echo=False,
+            pool_size=30,
+            max_overflow=20,
+            pool_timeout=30,
+            pool_recycle=3600,
+            pool_pre_ping=True
+        )
+        replica_session_maker = sessionmaker(
+            replica_engine, class_=AsyncSession, expire_on_commit=False
+        )
+    return replica_session_maker
 
 
 async def get_async_session() -> AsyncGenerator[AsyncSession, None]:
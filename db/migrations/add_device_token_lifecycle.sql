@@ -0,0 +1,12 @@
+-- Device token lifecycle: failure score, token lookup and pruning indexes
+-- Run this migration: psql $DATABASE_URL -f db/migrations/add_device_token_lifecycle.sql
+
+-- Consecutive transient APNs failures; token is deactivated at DEVICE_TOKEN_MAX_FAILURES
+ALTER TABLE device_tokens ADD COLUMN IF NOT EXISTS failure_score INTEGER NOT NULL DEFAULT 0;
+
+-- Bulk feedback updates and re-registration match on the token alone
+CREATE INDEX IF NOT EXISTS idx_device_tokens_token ON device_tokens(device_token);
+
+-- Stale token pruning scans by last activity
+CREATE INDEX IF NOT EXISTS idx_device_tokens_last_activity
+    ON device_tokens((COALESCE(last_used_at, updated_at, created_at)));
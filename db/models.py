@@ -1,6 +1,6 @@
-from sqlalchemy import Column, Integer, String, DateTime, Boolean, Float, ForeignKey, Text, UniqueConstraint, Enum as SQLEnum
+from sqlalchemy import Column, Integer, String, DateTime, Boolean, Float, ForeignKey, Text, UniqueConstraint, Index, Enum as SQLEnum
 from sqlalchemy.dialects.postgresql import UUID
-from sqlalchemy.sql import func
+from sqlalchemy.sql import func, text
 from sqlalchemy.orm import relationship
 from .database import Base
 import uuid
@@ -28,9 +28,9 @@ class User(Base):
     phone = Column(String(20), nullable=True)
     email = Column(String(255), nullable=True)
     profile_picture = Column(String, nullable=True)  # Legacy - kept for backwards compatibility
-    profile_picture_1 = Column(Text, nullable=True)  # Base64 encoded image
-    profile_picture_2 = Column(Text, nullable=True)  # Base64 encoded image
-    profile_picture_3 = Column(Text, nullable=True)  # Base64 encoded image
+    profile_picture_1 = Column(Text, nullable=True)  # /files/images/... URL (see services/image_store.py)
+    profile_picture_2 = Column(Text, nullable=True)  # /files/images/... URL
+    profile_picture_3 = Column(Text, nullable=True)  # /files/images/... URL
     instagram_handle = Column(String(30), nullable=True, index=True)
 
     # Privacy settings for Art Basel Miami access control
@@ -51,6 +51,10 @@ class User(Base):
     instagram_profile_pic = Column(Text, nullable=True)
     linkedin_handle = Column(String(100), nullable=True)
 
+    # Denormalized follow counts - maintained by services/follow_graph.py
+    followers_count = Column(Integer, default=0, server_default="0", nullable=False)
+    following_count = Column(Integer, default=0, server_default="0", nullable=False)
+
     # Legacy fields
     username = Column(String(50), nullable=True)
     bio = Column(String(500), nullable=True)
@@ -67,6 +71,12 @@ class User(Base):
     bounces_created = relationship("Bounce", back_populates="creator", cascade="all, delete-orphan")
     bounce_invites = relationship("BounceInvite", back_populates="user", cascade="all, delete-orphan")
 
+    __table_args__ = (
+        # Prefix search over active users (/users/search)
+        Index('ix_users_nickname_prefix', text('lower(nickname) text_pattern_ops'), postgresql_where=text('is_active')),
+        Index('ix_users_instagram_handle_prefix', text('lower(instagram_handle) text_pattern_ops'), postgresql_where=text('is_active')),
+    )
+
     @property
     def has_profile(self) -> bool:
         """Check if user has completed profile setup (nickname required)"""
@@ -90,6 +100,12 @@ class Follow(Base):
     following = relationship("User", foreign_keys=[following_id], back_populates="followers")
     close_friend_requester = relationship("User", foreign_keys=[close_friend_requester_id])
 
+    __table_args__ = (
+        # Keyset pagination of follower/following lists, newest follow first
+        Index('ix_follows_following_id_id', 'following_id', 'id'),
+        Index('ix_follows_follower_id_id', 'follower_id', 'id'),
+    )
+
 
 class DeviceToken(Base):
     """Store APNs device tokens for push notifications"""
@@ -105,6 +121,7 @@ class DeviceToken(Base):
     updated_at = Column(DateTime(timezone=True), onupdate=func.now())
     last_used_at = Column(DateTime(timezone=True), nullable=True)
     is_active = Column(Boolean, default=True, index=True)
+    failure_score = Column(Integer, default=0, nullable=False)  # Consecutive transient APNs failures
 
     user = relationship("User", backref="device_tokens", passive_deletes=True)
 
@@ -226,6 +243,10 @@ class BounceInvite(Base):
     bounce = relationship("Bounce", back_populates="invites")
     user = relationship("User", back_populates="bounce_invites")
 
+    __table_args__ = (
+        UniqueConstraint('bounce_id', 'user_id', name='uq_bounce_invite_user'),
+    )
+
 
 class BounceAttendee(Base):
     """
@@ -319,12 +340,16 @@ class CheckInHistory(Base):
     Permanent record of all user check-ins at venues.
     Query by user_id for user's check-in history.
     Query by place_id for venue's check-in history.
+
+    Range-partitioned by month on checked_in_at (check_in_history_YYYY_MM plus a
+    default partition), so the primary key includes checked_in_at. Partitions
+    are created ahead of time by ensure_history_partitions() on each deploy.
     """
     __tablename__ = "check_in_history"
 
-    id = Column(Integer, primary_key=True, index=True)
-    user_id = Column(Integer, ForeignKey("users.id", ondelete="CASCADE"), nullable=False, index=True)
-    place_id = Column(String(255), nullable=False, index=True)  # Google Places ID
+    id = Column(Integer, primary_key=True, autoincrement=True)
+    user_id = Column(Integer, ForeignKey("users.id", ondelete="CASCADE"), nullable=False)
+    place_id = Column(String(255), nullable=False)  # Google Places ID
     places_fk_id = Column(Integer, ForeignKey("places.id", ondelete="SET NULL"), nullable=True, index=True)
 
     # Denormalized venue info for historical record
@@ -334,13 +359,20 @@ class CheckInHistory(Base):
     longitude = Column(Float, nullable=False)
 
     # Timestamps
-    checked_in_at = Column(DateTime(timezone=True), server_default=func.now(), nullable=False, index=True)
+    checked_in_at = Column(DateTime(timezone=True), primary_key=True, server_default=func.now(), nullable=False, index=True)
     checked_out_at = Column(DateTime(timezone=True), nullable=True)
 
     # Relationships
     user = relationship("User")
     place = relationship("Place")
 
+    __table_args__ = (
+        # Keyset pagination: (checked_in_at, id) < cursor, newest first
+        Index('ix_check_in_history_user_checked_in', 'user_id', 'checked_in_at', 'id'),
+        Index('ix_check_in_history_place_checked_in', 'place_id', 'checked_in_at', 'id'),
+        {'postgresql_partition_by': 'RANGE (checked_in_at)'},
+    )
+
 
 class BounceGuestLocation(Base):
     """Tracks guest (non-app user) locations shared via bounce share link"""
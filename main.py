@@ -12,7 +12,7 @@ from slowapi.errors import RateLimitExceeded
 # Instagram 2FA - uncomment when ready to use
 # from api.routes import instagram_verify
 # from services.instagram_2fa import start_ig_poller, stop_ig_poller
-from api.dependencies import limiter
+from api.dependencies import limiter, SAFE_METHODS, user_id_from_request
 from api.routes import (
     admin,
     auth,
@@ -28,8 +28,13 @@ from api.routes import (
 from api.routes.close_friends import start_silent_push_loop, stop_silent_push_loop
 from api.routes.websocket import manager as ws_manager
 from core.config import settings
-from db.database import create_db_and_tables
-from services.redis import close_redis
+from db.database import check_schema_version
+from services.device_tokens import start_token_prune_loop, stop_token_prune_loop
+from services.http_clients import start_http_clients, close_http_clients
+from services.share_page import get_share_page
+from services.reaper import start_reaper_loop, stop_reaper_loop
+from services.places.fuzzy import start_fuzzy_index, stop_fuzzy_index
+from services.redis import close_redis, mark_recent_write
 
 # Configure logging
 logging.basicConfig(
@@ -53,14 +58,14 @@ async def lifespan(app: FastAPI):
 
     logger = logging.getLogger(__name__)
 
-    # Initialize database (with timeout so slow DB doesn't block startup)
+    # Check the schema version only - migrations run once per deploy in startup.py
     try:
-        await asyncio.wait_for(create_db_and_tables(), timeout=30)
-        logger.info("Database initialized")
+        if await asyncio.wait_for(check_schema_version(), timeout=10):
+            logger.info("Database schema is up to date")
     except asyncio.TimeoutError:
-        logger.error("Database initialization timed out after 30s — continuing anyway")
+        logger.error("Database schema check timed out after 10s — continuing anyway")
     except Exception as e:
-        logger.error(f"Database initialization failed: {e} — continuing anyway")
+        logger.error(f"Database schema check failed: {e} — continuing anyway")
 
     # Start WebSocket Redis subscriber (non-blocking)
     try:
@@ -71,8 +76,19 @@ async def lifespan(app: FastAPI):
     except Exception as e:
         logger.warning(f"Redis subscriber failed: {e}")
 
+    # Pooled clients for Google and other outbound integrations
+    await start_http_clients()
+    # Compile the share page template and its static assets once
+    get_share_page()
+
     # Start silent push loop for background location sharing
     await start_silent_push_loop()
+    # Prune device tokens that haven't been used in DEVICE_TOKEN_STALE_DAYS
+    await start_token_prune_loop()
+    # Expire stale attendees, check-ins and location shares
+    await start_reaper_loop()
+    # Typo-tolerant places index, loaded from Redis and kept in sync over pub/sub
+    await start_fuzzy_index()
     # Instagram 2FA poller - uncomment when ready to use
     # await start_ig_poller()
 
@@ -81,6 +97,10 @@ async def lifespan(app: FastAPI):
     # Cleanup
     # await stop_ig_poller()
     await stop_silent_push_loop()
+    await stop_token_prune_loop()
+    await stop_reaper_loop()
+    await stop_fuzzy_index()
+    await close_http_clients()
     await close_redis()
 
 
@@ -112,6 +132,20 @@ app.add_middleware(
     expose_headers=["*"],
 )
 
+@app.middleware("http")
+async def pin_recent_writers(request: Request, call_next):
+    """After a successful write, pin the caller's reads to the primary for a few seconds"""
+    response = await call_next(request)
+    if settings.DATABASE_REPLICA_URL and request.method not in SAFE_METHODS and response.status_code < 400:
+        user_id = user_id_from_request(request)
+        if user_id is not None:
+            try:
+                await mark_recent_write(user_id)
+            except Exception as e:
+                logging.getLogger(__name__).warning(f"Failed to mark recent write for user {user_id}: {e}")
+    return response
+
+
 # Create upload directory
 uploads_dir = Path(settings.UPLOAD_DIR)
 uploads_dir.mkdir(exist_ok=True)
@@ -143,14 +177,31 @@ async def root():
 
 @app.get("/health")
 async def health():
-    from services.redis import get_redis
+    from services.redis import get_redis, redis_available, redis_breaker_stats
 
-    redis_ok = False
-    try:
-        redis = await get_redis()
-        await redis.ping()
-        redis_ok = True
-    except Exception:
-        pass
+    redis_status = "degraded"
+    if redis_available():
+        try:
+            redis = await get_redis()
+            await redis.ping()
+            redis_status = "connected"
+        except Exception:
+            redis_status = "disconnected"
+
+    return {"status": "healthy", "redis": redis_status, "redis_breaker": redis_breaker_stats()}
+
+
+@app.get("/health/cache")
+async def cache_health():
+    """Per-prefix cache hit/miss counters and latencies for this worker"""
+    from services.cache import cache_stats
+
+    return cache_stats()
+
+
+@app.get("/health/http")
+async def http_clients_health():
+    """Per-host outbound request counters and latencies for this worker"""
+    from services.http_clients import http_client_stats
 
-    return {"status": "healthy", "redis": "connected" if redis_ok else "disconnected"}
+    return http_client_stats()
@@ -0,0 +1,165 @@
+"""
+Conditional GET benchmark for the polled JSON endpoints.
+
+Polls /bounces/map, /bounces/public, /checkins/area,
+/users/close-friends/locations and /users/{id}/profile in-process (httpx over
+ASGI, no network) as a client would while nothing changes: once always
+fetching the full body, once sending back the ETag it last received. Reports
+CPU time per request, latency and response bytes for both, i.e. what 304s
+save the server and the client.
+
+Needs the app's Postgres and Redis (DATABASE_URL / REDIS_URL) with some data
+in them - run scripts/seed_user_data.py first on an empty database.
+
+Run: python scripts/bench_etag.py
+
+Optional args:
+  --polls 500                  # Requests per endpoint and mode
+  --concurrency 20             # Concurrent pollers
+  --user-id 1                  # Caller (default: first active user)
+  --lat 25.7907 --lng -80.1300 # Map center (default: Miami Beach)
+"""
+
+import asyncio
+import argparse
+import logging
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import httpx
+from sqlalchemy import text
+
+from db.database import create_async_session
+from services.auth_service import create_access_token
+from services.redis import close_redis
+from bench_utils import percentile
+
+
+async def first_active_user_id() -> int:
+    async with create_async_session() as db:
+        result = await db.execute(text("SELECT id FROM users WHERE is_active = true ORDER BY id LIMIT 1"))
+        user_id = result.scalar()
+    if user_id is None:
+        raise SystemExit("No active users - seed the database first")
+    return user_id
+
+
+async def poll(client: httpx.AsyncClient, url: str, polls: int, concurrency: int, conditional: bool) -> dict:
+    """Poll url `polls` times; conditional pollers replay the last ETag they saw"""
+    latencies = []
+    statuses = {}
+    body_bytes = 0
+    remaining = polls
+
+    async def poller():
+        nonlocal remaining, body_bytes
+        etag = None
+        while remaining > 0:
+            remaining -= 1
+            headers = {"If-None-Match": etag} if conditional and etag else {}
+            started = time.perf_counter()
+            response = await client.get(url, headers=headers)
+            latencies.append(time.perf_counter() - started)
+            statuses[response.status_code] = statuses.get(response.status_code, 0) + 1
+            body_bytes += len(response.content)
+            etag = response.headers.get("etag") or etag
+
+    # Warm caches and connection pools so both modes start equal
+    await client.get(url)
+
+    cpu_started = time.process_time()
+    started = time.perf_counter()
+    await asyncio.gather(*(poller() for _ in range(concurrency)))
+    elapsed = time.perf_counter() - started
+    cpu = time.process_time() - cpu_started
+
+    latencies.sort()
+    return {
+        "statuses": statuses,
+        "elapsed": elapsed,
+        "cpu_ms": cpu / polls * 1000,
+        "p50_ms": percentile(latencies, 50) * 1000,
+        "p95_ms": percentile(latencies, 95) * 1000,
+        "bytes": body_bytes,
+    }
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark ETag / 304 polling against full responses")
+    parser.add_argument("--polls", type=int, default=500, help="Requests per endpoint and mode")
+    parser.add_argument("--concurrency", type=int, default=20, help="Concurrent pollers")
+    parser.add_argument("--user-id", type=int, default=None, help="Caller (default: first active user)")
+    parser.add_argument("--lat", type=float, default=25.7907, help="Map center latitude")
+    parser.add_argument("--lng", type=float, default=-80.1300, help="Map center longitude")
+    parser.add_argument("--verbose", action="store_true", help="Show app INFO logs")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO if args.verbose else logging.ERROR)
+
+    from main import app
+
+    user_id = args.user_id or await first_active_user_id()
+    token = create_access_token({"sub": str(user_id)})
+
+    endpoints = [
+        f"/bounces/map?lat={args.lat}&lng={args.lng}",
+        f"/bounces/public?lat={args.lat}&lng={args.lng}",
+        f"/checkins/area?lat={args.lat}&lng={args.lng}",
+        "/users/close-friends/locations",
+        f"/users/{user_id}/profile",
+    ]
+
+    print("=" * 60)
+    print("CONDITIONAL GET BENCHMARK")
+    print("=" * 60)
+    print(f"User: {user_id}  polls: {args.polls}  concurrency: {args.concurrency}")
+
+    transport = httpx.ASGITransport(app=app)
+    total_full_bytes = total_conditional_bytes = 0
+    total_full_cpu = total_conditional_cpu = 0.0
+
+    async with httpx.AsyncClient(
+        transport=transport,
+        base_url="http://bench",
+        headers={"Authorization": f"Bearer {token}"},
+    ) as client:
+        for url in endpoints:
+            full = await poll(client, url, args.polls, args.concurrency, conditional=False)
+            conditional = await poll(client, url, args.polls, args.concurrency, conditional=True)
+
+            total_full_bytes += full["bytes"]
+            total_conditional_bytes += conditional["bytes"]
+            total_full_cpu += full["cpu_ms"]
+            total_conditional_cpu += conditional["cpu_ms"]
+
+            print()
+            print(url)
+            for label, stats in (("full", full), ("if-none-match", conditional)):
+                print(
+                    f"  {label:<14} {stats['cpu_ms']:7.2f} ms CPU/req  "
+                    f"p50 {stats['p50_ms']:6.2f} ms  p95 {stats['p95_ms']:6.2f} ms  "
+                    f"{stats['bytes'] / args.polls:8.0f} B/req  statuses {stats['statuses']}"
+                )
+            if 304 not in conditional["statuses"]:
+                print("  (no 304s - is Redis reachable?)")
+
+    await close_redis()
+
+    print()
+    print("=" * 60)
+    print("TOTAL")
+    print("=" * 60)
+    if total_full_cpu:
+        print(f"CPU per request:   {total_full_cpu / len(endpoints):.2f} ms -> "
+              f"{total_conditional_cpu / len(endpoints):.2f} ms "
+              f"({(1 - total_conditional_cpu / total_full_cpu) * 100:.0f}% saved)")
+    if total_full_bytes:
+        print(f"Response bytes:    {total_full_bytes} -> {total_conditional_bytes} "
+              f"({(1 - total_conditional_bytes / total_full_bytes) * 100:.0f}% saved)")
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,118 @@
+"""
+Follow graph benchmark.
+
+Writes synthetic adjacency sets for one user with --followers followers and
+one venue with --checked-in people checked in (a third of them followers)
+straight into the graph:* keys, then times the queries the hot paths make:
+check-in recipients (followers at the venue + close friends), followers at
+a venue, profile follow flags and location sharers. The sets are marked
+loaded, so no database is needed.
+
+Writes to the Redis at REDIS_URL. The synthetic keys (user IDs from
+900000000, venue bench_graph_venue) are removed afterwards.
+
+Run: python scripts/bench_follow_graph.py
+
+Optional args:
+  --followers 100000           # Followers of the benchmarked user
+  --checked-in 500             # People checked in at the venue
+  --queries 2000               # Calls per query
+"""
+
+import asyncio
+import argparse
+import random
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from services.follow_graph import (
+    LOADED, LOAD_CHUNK, USER_SETS,
+    checkin_recipients, follow_relation, followers_at_place, location_sharers,
+)
+from services.redis import get_redis, close_redis
+from bench_utils import percentile
+
+USER_ID = 900000000
+PLACE_ID = "bench_graph_venue"
+
+
+def graph_keys() -> list:
+    return [f"graph:{name}:{USER_ID}" for name in USER_SETS] + [f"graph:checkins:{PLACE_ID}"]
+
+
+async def seed(redis, followers: int, checked_in: int, rng: random.Random) -> None:
+    follower_ids = list(range(USER_ID + 1, USER_ID + 1 + followers))
+    close_friends = rng.sample(follower_ids, min(50, followers))
+    venue = rng.sample(follower_ids, min(checked_in // 3, followers))
+    venue += list(range(USER_ID + followers + 1, USER_ID + followers + 1 + checked_in - len(venue)))
+
+    sets = {name: [] for name in USER_SETS}
+    sets["followers"] = follower_ids
+    sets["following"] = follower_ids[:200]
+    sets["close_friends"] = sets["close_friend_of"] = close_friends
+    sets["sharing_from"] = close_friends[:10]
+
+    await redis.delete(*graph_keys())
+    pipe = redis.pipeline(transaction=False)
+    for name, members in sets.items():
+        members = [LOADED] + members
+        for start in range(0, len(members), LOAD_CHUNK):
+            pipe.sadd(f"graph:{name}:{USER_ID}", *members[start:start + LOAD_CHUNK])
+    pipe.sadd(f"graph:checkins:{PLACE_ID}", LOADED, *venue)
+    await pipe.execute()
+
+
+async def time_calls(queries: int, call) -> dict:
+    latencies = []
+    for _ in range(queries):
+        started = time.perf_counter()
+        result = await call()
+        latencies.append(time.perf_counter() - started)
+    if result is None:
+        raise SystemExit("Graph query fell back to SQL - is Redis reachable?")
+    latencies.sort()
+    return {
+        "p50_us": percentile(latencies, 50) * 1e6,
+        "p95_us": percentile(latencies, 95) * 1e6,
+    }
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark follow graph set queries")
+    parser.add_argument("--followers", type=int, default=100000, help="Followers of the benchmarked user")
+    parser.add_argument("--checked-in", type=int, default=500, help="People checked in at the venue")
+    parser.add_argument("--queries", type=int, default=2000, help="Calls per query")
+    args = parser.parse_args()
+
+    rng = random.Random(1)
+    redis = await get_redis()
+
+    print("=" * 60)
+    print("FOLLOW GRAPH BENCHMARK")
+    print("=" * 60)
+
+    started = time.perf_counter()
+    await seed(redis, args.followers, args.checked_in, rng)
+    print(f"Seeded {args.followers} followers, {args.checked_in} checked in "
+          f"in {time.perf_counter() - started:.1f}s")
+
+    calls = {
+        "checkin_recipients": lambda: checkin_recipients(USER_ID, PLACE_ID),
+        "followers_at_place": lambda: followers_at_place(USER_ID, PLACE_ID),
+        "follow_relation": lambda: follow_relation(USER_ID, USER_ID + 1),
+        "location_sharers": lambda: location_sharers(USER_ID),
+    }
+    try:
+        for label, call in calls.items():
+            stats = await time_calls(args.queries, call)
+            print(f"  {label:<20} p50 {stats['p50_us']:8.1f} us  p95 {stats['p95_us']:8.1f} us")
+    finally:
+        await redis.delete(*graph_keys())
+        await close_redis()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,115 @@
+"""
+Fuzzy places index benchmark.
+
+Builds services/places/fuzzy.py's in-process index over synthetic venue
+names (no Redis needed) and times searches with the kinds of queries the
+autocomplete falls back to it for: a typo, swapped words, a left-out word.
+Reports build time and per-search latency.
+
+Run: python scripts/bench_fuzzy_places.py
+
+Optional args:
+  --places 20000               # Indexed places
+  --queries 2000               # Searches per query kind
+  --seed 1                     # Random seed
+"""
+
+import asyncio
+import argparse
+import random
+import string
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from services.places.fuzzy import FuzzyPlaceIndex
+from bench_utils import percentile
+
+KINDS = ["bar", "cafe", "club", "lounge", "bistro", "kitchen", "tavern", "house", "grill", "rooftop"]
+
+
+def random_word(rng: random.Random) -> str:
+    return "".join(rng.choice(string.ascii_lowercase) for _ in range(rng.randint(4, 9)))
+
+
+def make_name(rng: random.Random, words: list) -> str:
+    parts = rng.sample(words, rng.randint(1, 2)) + [rng.choice(KINDS)]
+    if rng.random() < 0.3:
+        parts.insert(0, "the")
+    return " ".join(parts).title()
+
+
+def typo(rng: random.Random, word: str) -> str:
+    i = rng.randrange(1, len(word))
+    return word[:i] + word[i + 1:]
+
+
+def make_query(rng: random.Random, name: str, kind: str) -> str:
+    tokens = name.lower().split()
+    longest = max(range(len(tokens)), key=lambda i: len(tokens[i]))
+    if kind == "typo":
+        tokens[longest] = typo(rng, tokens[longest])
+    elif kind == "swapped":
+        tokens.reverse()
+    elif kind == "missing" and len(tokens) > 2:
+        del tokens[1]
+    return " ".join(tokens)
+
+
+def time_queries(index: FuzzyPlaceIndex, queries: list) -> dict:
+    latencies = []
+    hits = 0
+    for query in queries:
+        started = time.perf_counter()
+        results = index.search(query, 25.79, -80.13, limit=10)
+        latencies.append(time.perf_counter() - started)
+        hits += bool(results)
+    latencies.sort()
+    return {
+        "p50_ms": percentile(latencies, 50) * 1000,
+        "p95_ms": percentile(latencies, 95) * 1000,
+        "max_ms": latencies[-1] * 1000,
+        "hit_rate": hits / len(queries),
+    }
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark the fuzzy places index")
+    parser.add_argument("--places", type=int, default=20000, help="Indexed places")
+    parser.add_argument("--queries", type=int, default=2000, help="Searches per query kind")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    words = [random_word(rng) for _ in range(max(100, args.places // 4))]
+    names = [make_name(rng, words) for _ in range(args.places)]
+
+    print("=" * 60)
+    print("FUZZY PLACES INDEX BENCHMARK")
+    print("=" * 60)
+
+    index = FuzzyPlaceIndex()
+    started = time.perf_counter()
+    for i, name in enumerate(names):
+        index.upsert(f"place_{i}", {
+            "name": name,
+            "address": "",
+            "lat": str(25.7 + rng.random() * 0.2),
+            "lng": str(-80.2 + rng.random() * 0.2),
+            "bounce_count": str(rng.randint(0, 20)),
+        })
+    print(f"Built index of {len(index)} places in {(time.perf_counter() - started) * 1000:.0f} ms")
+
+    for kind in ("exact", "typo", "swapped", "missing"):
+        queries = [make_query(rng, rng.choice(names), kind) for _ in range(args.queries)]
+        stats = time_queries(index, queries)
+        print(
+            f"  {kind:<8} p50 {stats['p50_ms']:6.3f} ms  p95 {stats['p95_ms']:6.3f} ms  "
+            f"max {stats['max_ms']:6.3f} ms  found {stats['hit_rate'] * 100:5.1f}%"
+        )
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
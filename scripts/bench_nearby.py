@@ -0,0 +1,151 @@
+"""
+Nearby venues benchmark.
+
+Indexes synthetic places (default 100k) spread over a metro area into the
+places:geo / places:meta:* structures, then times rank_nearby - GEOSEARCH,
+the pipelined metadata fetch and ranking - uncached, for a few radii, plus
+GEOSEARCH alone for comparison. Occupancy comes from a random in-memory map,
+so no database is needed.
+
+Writes to the Redis at REDIS_URL. The synthetic places (IDs bench_nearby_*)
+are removed afterwards unless --keep is given.
+
+Run: python scripts/bench_nearby.py
+
+Optional args:
+  --places 100000              # Synthetic places to index
+  --searches 200               # Searches per radius
+  --radii 500,2000,10000       # Radii in meters
+  --keep                       # Leave the synthetic places in Redis
+"""
+
+import asyncio
+import argparse
+import json
+import random
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from services.places.autocomplete import GEO_INDEX, META_PREFIX
+from services.places.nearby import NEARBY_MAX_CANDIDATES, rank_nearby
+from services.redis import get_redis, close_redis
+from bench_utils import percentile
+
+ID_PREFIX = "bench_nearby_"
+CENTER_LAT, CENTER_LNG = 25.7907, -80.1300  # Miami Beach
+SPREAD_DEGREES = 0.25  # ~28 km across
+BATCH_SIZE = 1000
+
+
+def random_point(rng: random.Random) -> tuple:
+    # Denser towards the center, like a real city
+    return (
+        CENTER_LAT + rng.gauss(0, SPREAD_DEGREES / 4),
+        CENTER_LNG + rng.gauss(0, SPREAD_DEGREES / 4),
+    )
+
+
+async def seed(redis, count: int, rng: random.Random) -> None:
+    for start in range(0, count, BATCH_SIZE):
+        pipe = redis.pipeline(transaction=False)
+        for i in range(start, min(start + BATCH_SIZE, count)):
+            place_id = f"{ID_PREFIX}{i}"
+            lat, lng = random_point(rng)
+            pipe.geoadd(GEO_INDEX, (lng, lat, place_id))
+            pipe.hset(f"{META_PREFIX}{place_id}", mapping={
+                "name": f"Bench Venue {i}",
+                "address": "Miami Beach, FL",
+                "lat": str(lat),
+                "lng": str(lng),
+                "bounce_count": str(rng.randint(0, 30)),
+                "checkin_count": str(rng.randint(0, 100)),
+                "types": json.dumps(["bar"]),
+            })
+        await pipe.execute()
+
+
+async def cleanup(redis, count: int) -> None:
+    for start in range(0, count, BATCH_SIZE):
+        place_ids = [f"{ID_PREFIX}{i}" for i in range(start, min(start + BATCH_SIZE, count))]
+        pipe = redis.pipeline(transaction=False)
+        pipe.zrem(GEO_INDEX, *place_ids)
+        pipe.delete(*(f"{META_PREFIX}{place_id}" for place_id in place_ids))
+        await pipe.execute()
+
+
+async def time_calls(searches: int, call) -> dict:
+    latencies = []
+    results = 0
+    for _ in range(searches):
+        started = time.perf_counter()
+        found = await call()
+        latencies.append(time.perf_counter() - started)
+        results += len(found)
+    latencies.sort()
+    return {
+        "p50_ms": percentile(latencies, 50) * 1000,
+        "p95_ms": percentile(latencies, 95) * 1000,
+        "avg_results": results / searches,
+    }
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark /places/nearby ranking against places:geo")
+    parser.add_argument("--places", type=int, default=100000, help="Synthetic places to index")
+    parser.add_argument("--searches", type=int, default=200, help="Searches per radius")
+    parser.add_argument("--radii", type=str, default="500,2000,10000", help="Comma-separated radii in meters")
+    parser.add_argument("--keep", action="store_true", help="Leave the synthetic places in Redis")
+    args = parser.parse_args()
+
+    rng = random.Random(1)
+    redis = await get_redis()
+
+    print("=" * 60)
+    print("NEARBY VENUES BENCHMARK")
+    print("=" * 60)
+
+    started = time.perf_counter()
+    await seed(redis, args.places, rng)
+    print(f"Indexed {args.places} places in {time.perf_counter() - started:.1f}s "
+          f"(candidates per search capped at {NEARBY_MAX_CANDIDATES})")
+
+    occupancy = {f"{ID_PREFIX}{i}": rng.randint(1, 40) for i in range(0, args.places, 7)}
+
+    async def occupancy_loader(place_ids):
+        return {place_id: occupancy[place_id] for place_id in place_ids if place_id in occupancy}
+
+    try:
+        for radius in [int(r) for r in args.radii.split(",")]:
+            points = [random_point(rng) for _ in range(args.searches)]
+            it = iter(points * 2)
+
+            async def geosearch_only():
+                lat, lng = next(it)
+                return await redis.geosearch(
+                    GEO_INDEX, longitude=lng, latitude=lat, radius=radius, unit="m",
+                    sort="ASC", count=NEARBY_MAX_CANDIDATES, withdist=True,
+                )
+
+            async def ranked():
+                lat, lng = next(it)
+                return await rank_nearby(lat, lng, radius, occupancy_loader)
+
+            geo = await time_calls(args.searches, geosearch_only)
+            full = await time_calls(args.searches, ranked)
+
+            print()
+            print(f"Radius {radius} m")
+            for label, stats in (("geosearch", geo), ("ranked", full)):
+                print(f"  {label:<10} p50 {stats['p50_ms']:7.2f} ms  p95 {stats['p95_ms']:7.2f} ms  "
+                      f"{stats['avg_results']:6.1f} places")
+    finally:
+        if not args.keep:
+            await cleanup(redis, args.places)
+        await close_redis()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,241 @@
+"""
+Push fan-out benchmark against the local mock APNs server.
+
+Seeds N throwaway users with one device token each, points APNsService at an
+in-process MockAPNsServer, then pushes one notification to all of them through
+enqueue_notifications_bulk - the same path bounce invites use. Reports
+throughput, per-push latency percentiles and HTTP/2 connection/stream usage.
+
+Send latency is timed around each APNs request on the client side (including
+waiting for a free stream); server time is the mock's received -> responded
+time, i.e. the configured latency plus scheduling delay in the mock.
+
+Needs the app's Postgres and Redis (DATABASE_URL / REDIS_URL).
+
+Run: python scripts/bench_push.py
+
+Optional args:
+  --count 10000                # Number of recipients
+  --latency-ms 20              # Mock APNs response latency
+  --jitter-ms 5                # Mock APNs random extra latency
+  --rate-410 0.01              # Fraction of tokens answered 410 Unregistered
+  --rate-429 0.0               # Fraction answered 429
+  --rate-5xx 0.0               # Fraction answered 500/503
+  --timeout 300                # Seconds to wait for the fan-out to finish
+  --keep                       # Leave seeded users in place
+"""
+
+import asyncio
+import argparse
+import base64
+import logging
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from cryptography.hazmat.primitives import serialization
+from cryptography.hazmat.primitives.asymmetric import ec
+from sqlalchemy import text
+
+from core.config import settings
+from db.database import create_async_session
+from services.redis import get_redis, close_redis, BADGE_KEY_PREFIX
+from mock_apns_server import MockAPNsServer
+from bench_utils import percentile
+
+BENCH_USER_PREFIX = "bench_push_"
+
+
+def use_ephemeral_apns_key():
+    """Sign provider tokens with a throwaway key - the mock never verifies them"""
+    key = ec.generate_private_key(ec.SECP256R1())
+    pem = key.private_bytes(
+        encoding=serialization.Encoding.PEM,
+        format=serialization.PrivateFormat.PKCS8,
+        encryption_algorithm=serialization.NoEncryption(),
+    )
+    settings.APNS_KEY_BASE64 = base64.b64encode(pem).decode()
+    settings.APNS_KEY_ID = "BENCHKEY01"
+    settings.APNS_TEAM_ID = "BENCHTEAM1"
+
+
+async def cleanup_bench_users():
+    async with create_async_session() as db:
+        result = await db.execute(
+            text("SELECT id FROM users WHERE apple_user_id LIKE :prefix"),
+            {"prefix": f"{BENCH_USER_PREFIX}%"},
+        )
+        user_ids = [row[0] for row in result.fetchall()]
+        if user_ids:
+            await db.execute(text("DELETE FROM device_tokens WHERE user_id = ANY(:ids)"), {"ids": user_ids})
+            await db.execute(text("DELETE FROM notification_preferences WHERE user_id = ANY(:ids)"), {"ids": user_ids})
+            await db.execute(text("DELETE FROM users WHERE id = ANY(:ids)"), {"ids": user_ids})
+            await db.commit()
+
+    if user_ids:
+        redis = await get_redis()
+        for i in range(0, len(user_ids), 1000):
+            await redis.delete(*[f"{BADGE_KEY_PREFIX}{uid}" for uid in user_ids[i:i + 1000]])
+    return len(user_ids)
+
+
+async def seed_bench_users(count: int) -> dict:
+    """Create `count` users with one active token each. Returns {token: user_id}"""
+    async with create_async_session() as db:
+        await db.execute(text("""
+            INSERT INTO users (apple_user_id, nickname, can_post, is_active, is_admin,
+                               phone_visible, email_visible)
+            SELECT :prefix || g, 'bench' || g, false, true, false, false, false
+            FROM generate_series(1, :count) AS g
+        """), {"prefix": BENCH_USER_PREFIX, "count": count})
+
+        # 64 hex chars, same shape as a real APNs token
+        await db.execute(text("""
+            INSERT INTO device_tokens (user_id, device_token, platform, is_sandbox, is_active)
+            SELECT id, md5(apple_user_id) || md5(apple_user_id || ':2'), 'ios', false, true
+            FROM users WHERE apple_user_id LIKE :pattern
+        """), {"pattern": f"{BENCH_USER_PREFIX}%"})
+        await db.commit()
+
+        result = await db.execute(text("""
+            SELECT dt.device_token, dt.user_id FROM device_tokens dt
+            JOIN users u ON u.id = dt.user_id
+            WHERE u.apple_user_id LIKE :pattern
+        """), {"pattern": f"{BENCH_USER_PREFIX}%"})
+        return {row[0]: row[1] for row in result.fetchall()}
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark push fan-out against a mock APNs server")
+    parser.add_argument("--count", type=int, default=10000, help="Number of recipients")
+    parser.add_argument("--latency-ms", type=float, default=20.0, help="Mock APNs response latency")
+    parser.add_argument("--jitter-ms", type=float, default=5.0, help="Mock APNs random extra latency")
+    parser.add_argument("--rate-410", type=float, default=0.01, help="Fraction answered 410 Unregistered")
+    parser.add_argument("--rate-429", type=float, default=0.0, help="Fraction answered 429")
+    parser.add_argument("--rate-5xx", type=float, default=0.0, help="Fraction answered 500/503")
+    parser.add_argument("--max-streams", type=int, default=1000, help="Mock APNs max concurrent streams")
+    parser.add_argument("--timeout", type=float, default=300.0, help="Seconds to wait for the fan-out")
+    parser.add_argument("--keep", action="store_true", help="Leave seeded users in place")
+    parser.add_argument("--verbose", action="store_true", help="Show app INFO logs")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO if args.verbose else logging.ERROR)
+
+    server = MockAPNsServer(
+        host="127.0.0.1",
+        port=0,
+        latency_ms=args.latency_ms,
+        jitter_ms=args.jitter_ms,
+        rate_410=args.rate_410,
+        rate_429=args.rate_429,
+        rate_5xx=args.rate_5xx,
+        max_concurrent_streams=args.max_streams,
+        capture_limit=args.count * 2,
+        seed=42,
+    )
+    await server.start()
+
+    settings.APNS_BASE_URL = server.base_url
+    use_ephemeral_apns_key()
+
+    # Imported after settings are patched so the APNs client targets the mock
+    from services.apns_service import get_apns_service, NotificationPayload, NotificationType
+    from services.tasks import enqueue_notifications_bulk, payload_to_dict
+
+    print("=" * 60)
+    print("PUSH FAN-OUT BENCHMARK")
+    print("=" * 60)
+    print(f"Mock APNs: {server.base_url} latency={args.latency_ms}ms +0..{args.jitter_ms}ms")
+    print(f"Errors: 410={args.rate_410} 429={args.rate_429} 5xx={args.rate_5xx}")
+
+    removed = await cleanup_bench_users()
+    if removed:
+        print(f"Removed {removed} leftover bench users")
+
+    print(f"Seeding {args.count} users with device tokens...")
+    token_to_user = await seed_bench_users(args.count)
+    user_ids = sorted(set(token_to_user.values()))
+    print(f"Seeded {len(user_ids)} users")
+
+    payload = NotificationPayload(
+        notification_type=NotificationType.BOUNCE_INVITE,
+        title="Bench Bounce",
+        body="bench invited you to a bounce",
+        actor_id=0,
+        actor_nickname="bench",
+        bounce_id=0,
+        bounce_venue_name="Bench Venue",
+    )
+    payload_dict = payload_to_dict(payload)
+
+    # Initialize the APNs client up front so key loading isn't timed
+    apns = await get_apns_service()
+    server.reset()
+
+    # Time every send as the fan-out makes it
+    send_latencies = []
+    send_to_token = apns._send_to_token
+
+    async def timed_send_to_token(*send_args, **send_kwargs):
+        send_started = time.perf_counter()
+        try:
+            return await send_to_token(*send_args, **send_kwargs)
+        finally:
+            send_latencies.append(time.perf_counter() - send_started)
+
+    apns._send_to_token = timed_send_to_token
+
+    before = asyncio.all_tasks()
+    started = time.perf_counter()
+    enqueue_notifications_bulk(user_ids, payload_dict)
+    enqueue_elapsed = time.perf_counter() - started
+    push_tasks = asyncio.all_tasks() - before
+
+    if push_tasks:
+        _, pending = await asyncio.wait(push_tasks, timeout=args.timeout)
+    else:
+        pending = set()
+    elapsed = time.perf_counter() - started
+
+    # Let the last in-flight responses land in the capture
+    await asyncio.sleep(0.1)
+
+    latencies = sorted(send_latencies)
+    server_times = sorted(r.responded_at - r.received_at for r in server.requests)
+    delivered = server.status_counts.get(200, 0)
+    stats = server.stats()
+    streams = [n for n in stats["streams_per_connection"].values() if n]
+
+    print()
+    print("=" * 60)
+    print("RESULTS")
+    print("=" * 60)
+    print(f"Recipients:            {len(user_ids)}")
+    print(f"Enqueue call:          {enqueue_elapsed * 1000:.1f}ms ({len(push_tasks)} task(s))")
+    print(f"Wall time:             {elapsed:.2f}s" + (f" ({len(pending)} task(s) timed out)" if pending else ""))
+    print(f"APNs requests:         {stats['requests']} ({len(user_ids) - stats['requests']} never sent)")
+    print(f"Status counts:         {stats['status_counts']}")
+    print(f"Throughput:            {stats['requests'] / elapsed:.1f} req/s, {delivered / elapsed:.1f} delivered/s")
+    print(f"Send p50/p95/p99:      {percentile(latencies, 50) * 1000:.0f}ms / "
+          f"{percentile(latencies, 95) * 1000:.0f}ms / {percentile(latencies, 99) * 1000:.0f}ms")
+    print(f"Server p50/p95/p99:    {percentile(server_times, 50) * 1000:.0f}ms / "
+          f"{percentile(server_times, 95) * 1000:.0f}ms / {percentile(server_times, 99) * 1000:.0f}ms")
+    print(f"Connections used:      {len(streams)} (opened {stats['connections_opened']})")
+    if streams:
+        print(f"Streams/connection:    min={min(streams)} max={max(streams)} avg={sum(streams) / len(streams):.0f}")
+    peak = stats["peak_concurrent_streams"]
+    print(f"Peak concurrent:       {peak} streams "
+          f"({peak / stats['max_concurrent_streams'] * 100:.1f}% of {stats['max_concurrent_streams']} allowed)")
+
+    if not args.keep:
+        removed = await cleanup_bench_users()
+        print(f"\nCleaned up {removed} bench users")
+
+    await server.stop()
+    await close_redis()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
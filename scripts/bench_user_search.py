@@ -0,0 +1,155 @@
+"""
+User search benchmark.
+
+Times /users/search in-process (httpx over ASGI, no network) with the
+prefixes a debounced search box sends - 1 to 4 characters - and reports
+p50 / p95 / p99 latency.
+
+With --seed N it first inserts N synthetic active users (apple_user_id
+bench_search_*, random hex nicknames, a third with Instagram handles) and
+has the caller follow --follows of them, so the index and graph paths are
+exercised at scale (e.g. --seed 1000000). --cleanup removes them again.
+The follows are inserted directly, so run scripts/reconcile_follow_counts.py
+after seeding and after cleanup.
+
+Needs the app's Postgres and Redis (DATABASE_URL / REDIS_URL), migrated to
+0006 (the prefix indexes).
+
+Run: python scripts/bench_user_search.py
+
+Optional args:
+  --searches 1000              # Searches to time
+  --user-id 1                  # Caller (default: first active user)
+  --seed 1000000               # Insert this many synthetic users first
+  --follows 500                # Synthetic users the caller follows (with --seed)
+  --cleanup                    # Delete the synthetic users and exit
+"""
+
+import asyncio
+import argparse
+import logging
+import random
+import time
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import httpx
+from sqlalchemy import text
+
+from db.database import create_async_session
+from services.auth_service import create_access_token
+from services.redis import close_redis
+from bench_utils import percentile
+
+APPLE_ID_PREFIX = "bench_search_"
+HEX = "0123456789abcdef"
+
+
+async def first_active_user_id() -> int:
+    async with create_async_session() as db:
+        result = await db.execute(text("SELECT id FROM users WHERE is_active = true ORDER BY id LIMIT 1"))
+        user_id = result.scalar()
+    if user_id is None:
+        raise SystemExit("No active users - seed the database first")
+    return user_id
+
+
+async def seed(count: int, user_id: int, follows: int) -> None:
+    async with create_async_session() as db:
+        await db.execute(text("""
+            INSERT INTO users (apple_user_id, nickname, instagram_handle,
+                               phone_visible, email_visible, can_post, is_admin, is_active)
+            SELECT :prefix || g,
+                   substr(md5('n' || g), 1, 12),
+                   CASE WHEN g % 3 = 0 THEN substr(md5('i' || g), 1, 12) END,
+                   false, false, false, false, true
+            FROM generate_series(1, :count) g
+            ON CONFLICT (apple_user_id) DO NOTHING
+        """), {"prefix": APPLE_ID_PREFIX, "count": count})
+        await db.execute(text("""
+            INSERT INTO follows (follower_id, following_id, is_close_friend, close_friend_status, is_sharing_location)
+            SELECT :user_id, id, false, 'none', false
+            FROM users
+            WHERE apple_user_id LIKE :pattern
+              AND id NOT IN (SELECT following_id FROM follows WHERE follower_id = :user_id)
+            ORDER BY random()
+            LIMIT :follows
+        """), {"user_id": user_id, "pattern": f"{APPLE_ID_PREFIX}%", "follows": follows})
+        await db.commit()
+        await db.execute(text("ANALYZE users"))
+        await db.execute(text("ANALYZE follows"))
+
+
+async def cleanup() -> int:
+    async with create_async_session() as db:
+        result = await db.execute(
+            text("DELETE FROM users WHERE apple_user_id LIKE :pattern"),
+            {"pattern": f"{APPLE_ID_PREFIX}%"}
+        )
+        await db.commit()
+        return result.rowcount
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Benchmark /users/search latency")
+    parser.add_argument("--searches", type=int, default=1000, help="Searches to time")
+    parser.add_argument("--user-id", type=int, default=None, help="Caller (default: first active user)")
+    parser.add_argument("--seed", type=int, default=0, help="Insert this many synthetic users first")
+    parser.add_argument("--follows", type=int, default=500, help="Synthetic users the caller follows")
+    parser.add_argument("--cleanup", action="store_true", help="Delete the synthetic users and exit")
+    parser.add_argument("--verbose", action="store_true", help="Show app INFO logs")
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.INFO if args.verbose else logging.ERROR)
+
+    print("=" * 60)
+    print("USER SEARCH BENCHMARK")
+    print("=" * 60)
+
+    if args.cleanup:
+        print(f"Deleted {await cleanup()} synthetic user(s)")
+        return
+
+    user_id = args.user_id or await first_active_user_id()
+    if args.seed:
+        started = time.perf_counter()
+        await seed(args.seed, user_id, args.follows)
+        print(f"Seeded {args.seed} users ({args.follows} followed) in {time.perf_counter() - started:.1f}s")
+
+    from main import app
+
+    token = create_access_token({"sub": str(user_id)})
+    rng = random.Random(1)
+    queries = ["".join(rng.choice(HEX) for _ in range(rng.randint(1, 4))) for _ in range(args.searches)]
+
+    latencies = []
+    result_counts = 0
+    transport = httpx.ASGITransport(app=app)
+    async with httpx.AsyncClient(
+        transport=transport,
+        base_url="http://bench",
+        headers={"Authorization": f"Bearer {token}"},
+    ) as client:
+        # Warm the connection pool and plans
+        for query in queries[:20]:
+            await client.get("/users/search", params={"q": query})
+
+        for query in queries:
+            started = time.perf_counter()
+            response = await client.get("/users/search", params={"q": query})
+            latencies.append(time.perf_counter() - started)
+            result_counts += len(response.json().get("results", []))
+
+    await close_redis()
+
+    latencies.sort()
+    print(f"User: {user_id}  searches: {args.searches}  avg results: {result_counts / args.searches:.1f}")
+    print(f"p50 {percentile(latencies, 50) * 1000:.2f} ms  "
+          f"p95 {percentile(latencies, 95) * 1000:.2f} ms  "
+          f"p99 {percentile(latencies, 99) * 1000:.2f} ms")
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
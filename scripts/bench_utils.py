@@ -0,0 +1,14 @@
+"""
+Helpers shared by the scripts/bench_*.py benchmarks.
+
+Not runnable on its own - imported as `from bench_utils import ...`, which
+works because Python puts the running script's directory (scripts/) on sys.path.
+"""
+
+
+def percentile(sorted_values: list, pct: float) -> float:
+    """Nearest-rank percentile of an already sorted list (0.0 when empty)"""
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(round(pct / 100 * (len(sorted_values) - 1))))
+    return sorted_values[index]
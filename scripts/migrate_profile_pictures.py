@@ -0,0 +1,118 @@
+"""
+Move base64 profile pictures out of users.profile_picture_1..3 into the image store.
+
+Each data: URI is decoded, written to the content-addressed store as full and
+thumbnail variants (services/image_store.py), and the column is rewritten to the
+short /files/images/... URL. Rows are processed in id order in small batches,
+so the script can be stopped and re-run safely - already migrated slots no
+longer start with "data:" and are skipped. Slots that can't be decoded are
+left as they are and listed at the end for manual review.
+
+UPLOAD_DIR must point at the same volume the API serves /files from.
+
+Run: python scripts/migrate_profile_pictures.py
+
+Optional args:
+  --batch-size 50              # Users per batch
+  --dry-run                    # Count base64 slots without writing
+"""
+
+import asyncio
+import argparse
+import base64
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from sqlalchemy import text
+from db.database import create_async_session
+from services.image_store import store_image, InvalidImageError
+
+SLOT_COLUMNS = ["profile_picture_1", "profile_picture_2", "profile_picture_3"]
+
+
+def decode_data_uri(value: str) -> bytes:
+    """data:image/jpeg;base64,... -> raw bytes"""
+    _, _, encoded = value.partition(",")
+    return base64.b64decode(encoded)
+
+
+async def migrate(batch_size: int, dry_run: bool):
+    migrated = 0
+    failed = []
+    last_id = 0
+
+    while True:
+        async with create_async_session() as db:
+            # Only ids first - the base64 payloads are fetched one column at a time below
+            result = await db.execute(text("""
+                SELECT id FROM users
+                WHERE id > :last_id
+                  AND (profile_picture_1 LIKE 'data:%'
+                       OR profile_picture_2 LIKE 'data:%'
+                       OR profile_picture_3 LIKE 'data:%')
+                ORDER BY id
+                LIMIT :batch_size
+            """), {"last_id": last_id, "batch_size": batch_size})
+            user_ids = [row[0] for row in result.fetchall()]
+            if not user_ids:
+                break
+
+            for user_id in user_ids:
+                for column in SLOT_COLUMNS:
+                    value = (await db.execute(
+                        text(f"SELECT {column} FROM users WHERE id = :id"), {"id": user_id}
+                    )).scalar()
+                    if not value or not value.startswith("data:"):
+                        continue
+
+                    if dry_run:
+                        migrated += 1
+                        continue
+
+                    try:
+                        stored = await store_image(decode_data_uri(value))
+                    except (InvalidImageError, ValueError) as e:
+                        # Keep the original value - never drop user data we can't read
+                        print(f"  User {user_id} {column}: could not decode ({e}), leaving as is")
+                        failed.append((user_id, column))
+                        continue
+
+                    await db.execute(
+                        text(f"UPDATE users SET {column} = :url WHERE id = :id"),
+                        {"url": stored.url, "id": user_id}
+                    )
+                    migrated += 1
+
+            if not dry_run:
+                await db.commit()
+            last_id = user_ids[-1]
+            print(f"  Processed users up to id {last_id} ({migrated} images migrated, {len(failed)} failed)")
+
+    return migrated, failed
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Move base64 profile pictures into the image store")
+    parser.add_argument("--batch-size", type=int, default=50, help="Users per batch")
+    parser.add_argument("--dry-run", action="store_true", help="Count base64 slots without writing")
+    args = parser.parse_args()
+
+    print("=" * 60)
+    print("PROFILE PICTURE MIGRATION")
+    print("=" * 60)
+    if args.dry_run:
+        print("DRY RUN - counting base64 slots only, nothing is written")
+
+    migrated, failed = await migrate(args.batch_size, args.dry_run)
+
+    print("=" * 60)
+    print(f"Done: {migrated} image(s) {'found' if args.dry_run else 'migrated'}, {len(failed)} unreadable")
+    for user_id, column in failed:
+        print(f"  Left unmigrated: user {user_id} {column}")
+    print("=" * 60)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,343 @@
+"""
+Local stand-in for the APNs HTTP/2 provider API.
+
+Speaks cleartext HTTP/2 (prior knowledge) on POST /3/device/{token} so the
+real APNsService can be pointed at it with APNS_BASE_URL=http://127.0.0.1:2197.
+Latency and error responses are configurable, and every request is captured
+so benchmarks can measure end-to-end latency and connection/stream usage.
+
+Run: python scripts/mock_apns_server.py
+
+Optional args:
+  --port 2197                  # Port to listen on
+  --latency-ms 20              # Fixed response latency
+  --jitter-ms 5                # Random extra latency (0..jitter)
+  --rate-410 0.01              # Fraction answered 410 Unregistered
+  --rate-429 0.01              # Fraction answered 429 TooManyRequests
+  --rate-5xx 0.01              # Fraction answered 500/503
+  --max-streams 1000           # SETTINGS_MAX_CONCURRENT_STREAMS advertised
+"""
+
+import asyncio
+import argparse
+import json
+import random
+import time
+import uuid
+import sys
+import os
+from dataclasses import dataclass, field
+from typing import Optional, Dict, List, Set
+
+import h2.config
+import h2.connection
+import h2.events
+import h2.settings
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+DEVICE_PATH_PREFIX = "/3/device/"
+
+
+@dataclass
+class CapturedRequest:
+    """One push as seen by the mock server"""
+    received_at: float  # time.perf_counter() when the request body completed
+    responded_at: float
+    connection_id: int
+    stream_id: int
+    device_token: str
+    headers: Dict[str, str]
+    payload: Optional[dict]
+    status: int
+    reason: Optional[str]
+
+
+@dataclass
+class ConnectionStats:
+    connection_id: int
+    opened_at: float
+    closed_at: Optional[float] = None
+    streams: int = 0
+    active_streams: int = 0
+    peak_streams: int = 0
+
+
+@dataclass
+class MockAPNsServer:
+    """In-process mock APNs server. Use start()/stop() or the CLI below."""
+    host: str = "127.0.0.1"
+    port: int = 2197
+    latency_ms: float = 0.0
+    jitter_ms: float = 0.0
+    rate_410: float = 0.0
+    rate_429: float = 0.0
+    rate_5xx: float = 0.0
+    max_concurrent_streams: int = 1000
+    capture_limit: int = 100_000
+    seed: Optional[int] = None
+    # Tokens that always come back 410 Unregistered (deterministic expiry)
+    unregistered_tokens: Set[str] = field(default_factory=set)
+
+    def __post_init__(self):
+        self.requests: List[CapturedRequest] = []
+        self.connections: Dict[int, ConnectionStats] = {}
+        self.status_counts: Dict[int, int] = {}
+        self.total_requests = 0
+        self._next_connection_id = 1
+        self._rng = random.Random(self.seed)
+        self._server: Optional[asyncio.AbstractServer] = None
+
+    async def start(self):
+        loop = asyncio.get_running_loop()
+        self._server = await loop.create_server(
+            lambda: _APNsProtocol(self), self.host, self.port
+        )
+        # Pick up the real port when started with port=0
+        self.port = self._server.sockets[0].getsockname()[1]
+
+    async def stop(self):
+        if self._server:
+            self._server.close()
+            await self._server.wait_closed()
+            self._server = None
+
+    @property
+    def base_url(self) -> str:
+        return f"http://{self.host}:{self.port}"
+
+    def reset(self):
+        """Clear captured requests and counters (connections stay open)"""
+        self.requests.clear()
+        self.status_counts.clear()
+        self.total_requests = 0
+        for conn in self.connections.values():
+            conn.streams = 0
+            conn.peak_streams = conn.active_streams
+
+    def _register_connection(self) -> ConnectionStats:
+        stats = ConnectionStats(self._next_connection_id, time.perf_counter())
+        self.connections[stats.connection_id] = stats
+        self._next_connection_id += 1
+        return stats
+
+    def _pick_response(self, device_token: str) -> tuple[int, Optional[str]]:
+        """Decide status/reason for a push, applying the injected error rates"""
+        if device_token in self.unregistered_tokens:
+            return 410, "Unregistered"
+        roll = self._rng.random()
+        if roll < self.rate_410:
+            return 410, "Unregistered"
+        roll -= self.rate_410
+        if roll < self.rate_429:
+            return 429, "TooManyRequests"
+        roll -= self.rate_429
+        if roll < self.rate_5xx:
+            return self._rng.choice([(500, "InternalServerError"), (503, "ServiceUnavailable")])
+        return 200, None
+
+    def _latency(self) -> float:
+        extra = self._rng.uniform(0, self.jitter_ms) if self.jitter_ms else 0.0
+        return (self.latency_ms + extra) / 1000.0
+
+    def _record(self, captured: CapturedRequest):
+        self.total_requests += 1
+        self.status_counts[captured.status] = self.status_counts.get(captured.status, 0) + 1
+        if len(self.requests) < self.capture_limit:
+            self.requests.append(captured)
+
+    def stats(self) -> dict:
+        """Connection and stream utilization summary"""
+        conns = list(self.connections.values())
+        return {
+            "requests": self.total_requests,
+            "status_counts": dict(sorted(self.status_counts.items())),
+            "connections_opened": len(conns),
+            "connections_open": sum(1 for c in conns if c.closed_at is None),
+            "streams_per_connection": {c.connection_id: c.streams for c in conns},
+            "peak_concurrent_streams": max((c.peak_streams for c in conns), default=0),
+            "max_concurrent_streams": self.max_concurrent_streams,
+        }
+
+
+class _APNsProtocol(asyncio.Protocol):
+    """One HTTP/2 connection"""
+
+    def __init__(self, server: MockAPNsServer):
+        self.server = server
+        self.conn = h2.connection.H2Connection(
+            config=h2.config.H2Configuration(client_side=False, header_encoding="utf-8")
+        )
+        self.conn.local_settings = h2.settings.Settings(
+            client=False,
+            initial_values={
+                h2.settings.SettingCodes.MAX_CONCURRENT_STREAMS: server.max_concurrent_streams,
+            },
+        )
+        self.transport: Optional[asyncio.Transport] = None
+        self.stats: Optional[ConnectionStats] = None
+        self._streams: Dict[int, dict] = {}
+        self._closed = False
+
+    def connection_made(self, transport):
+        self.transport = transport
+        self.stats = self.server._register_connection()
+        self.conn.initiate_connection()
+        self._flush()
+
+    def connection_lost(self, exc):
+        self._closed = True
+        self.stats.closed_at = time.perf_counter()
+        self.stats.active_streams = 0
+
+    def data_received(self, data: bytes):
+        try:
+            events = self.conn.receive_data(data)
+        except Exception:
+            self.transport.close()
+            return
+
+        for event in events:
+            if isinstance(event, h2.events.RequestReceived):
+                self._streams[event.stream_id] = {
+                    "headers": dict(event.headers),
+                    "body": bytearray(),
+                }
+                self.stats.streams += 1
+                self.stats.active_streams += 1
+                self.stats.peak_streams = max(self.stats.peak_streams, self.stats.active_streams)
+            elif isinstance(event, h2.events.DataReceived):
+                stream = self._streams.get(event.stream_id)
+                if stream is not None:
+                    stream["body"].extend(event.data)
+                self.conn.acknowledge_received_data(event.flow_controlled_length, event.stream_id)
+            elif isinstance(event, h2.events.StreamEnded):
+                stream = self._streams.get(event.stream_id)
+                if stream is not None:
+                    asyncio.get_running_loop().create_task(
+                        self._respond(event.stream_id, stream, time.perf_counter())
+                    )
+            elif isinstance(event, h2.events.StreamReset):
+                if self._streams.pop(event.stream_id, None) is not None:
+                    self.stats.active_streams -= 1
+            elif isinstance(event, h2.events.ConnectionTerminated):
+                self.transport.close()
+
+        self._flush()
+
+    async def _respond(self, stream_id: int, stream: dict, received_at: float):
+        headers = stream["headers"]
+        path = headers.get(":path", "")
+        device_token = path[len(DEVICE_PATH_PREFIX):] if path.startswith(DEVICE_PATH_PREFIX) else ""
+
+        if headers.get(":method") != "POST":
+            status, reason = 405, "MethodNotAllowed"
+        elif not device_token:
+            status, reason = 404, "BadPath"
+        else:
+            status, reason = self.server._pick_response(device_token)
+
+        latency = self.server._latency()
+        if latency:
+            await asyncio.sleep(latency)
+
+        if self._closed or self._streams.pop(stream_id, None) is None:
+            return
+        self.stats.active_streams -= 1
+
+        try:
+            payload = json.loads(bytes(stream["body"])) if stream["body"] else None
+        except ValueError:
+            payload = None
+
+        response_headers = [
+            (":status", str(status)),
+            ("apns-id", headers.get("apns-id") or str(uuid.uuid4()).upper()),
+        ]
+        body = b""
+        if reason:
+            error = {"reason": reason}
+            if status == 410:
+                error["timestamp"] = int(time.time() * 1000)
+            body = json.dumps(error).encode()
+            response_headers.append(("content-type", "application/json"))
+            response_headers.append(("content-length", str(len(body))))
+
+        try:
+            self.conn.send_headers(stream_id, response_headers, end_stream=not body)
+            if body:
+                self.conn.send_data(stream_id, body, end_stream=True)
+            self._flush()
+        except Exception:
+            return
+
+        self.server._record(CapturedRequest(
+            received_at=received_at,
+            responded_at=time.perf_counter(),
+            connection_id=self.stats.connection_id,
+            stream_id=stream_id,
+            device_token=device_token,
+            headers={k: v for k, v in headers.items() if not k.startswith(":")},
+            payload=payload,
+            status=status,
+            reason=reason,
+        ))
+
+    def _flush(self):
+        data = self.conn.data_to_send()
+        if data and not self._closed:
+            self.transport.write(data)
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Mock APNs HTTP/2 server")
+    parser.add_argument("--host", type=str, default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=2197)
+    parser.add_argument("--latency-ms", type=float, default=20.0, help="Fixed response latency")
+    parser.add_argument("--jitter-ms", type=float, default=5.0, help="Random extra latency")
+    parser.add_argument("--rate-410", type=float, default=0.0, help="Fraction answered 410 Unregistered")
+    parser.add_argument("--rate-429", type=float, default=0.0, help="Fraction answered 429 TooManyRequests")
+    parser.add_argument("--rate-5xx", type=float, default=0.0, help="Fraction answered 500/503")
+    parser.add_argument("--max-streams", type=int, default=1000, help="Advertised max concurrent streams")
+    parser.add_argument("--stats-interval", type=float, default=10.0, help="Seconds between stats lines")
+    args = parser.parse_args()
+
+    server = MockAPNsServer(
+        host=args.host,
+        port=args.port,
+        latency_ms=args.latency_ms,
+        jitter_ms=args.jitter_ms,
+        rate_410=args.rate_410,
+        rate_429=args.rate_429,
+        rate_5xx=args.rate_5xx,
+        max_concurrent_streams=args.max_streams,
+        capture_limit=0,  # Long-running: keep counters only
+    )
+    await server.start()
+
+    print("=" * 60)
+    print("MOCK APNs SERVER")
+    print("=" * 60)
+    print(f"Listening on {server.base_url} (h2c prior knowledge)")
+    print(f"Latency: {args.latency_ms}ms +0..{args.jitter_ms}ms")
+    print(f"Errors: 410={args.rate_410} 429={args.rate_429} 5xx={args.rate_5xx}")
+    print(f"Point the API at it with APNS_BASE_URL={server.base_url}")
+
+    try:
+        while True:
+            await asyncio.sleep(args.stats_interval)
+            stats = server.stats()
+            print(
+                f"  requests={stats['requests']} status={stats['status_counts']} "
+                f"connections={stats['connections_open']}/{stats['connections_opened']} "
+                f"peak_streams={stats['peak_concurrent_streams']}"
+            )
+    finally:
+        await server.stop()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -13,7 +13,8 @@ from pathlib import Path
 # Add parent directory to path to import from project
 sys.path.insert(0, str(Path(__file__).parent.parent))
 
-from db.database import get_engine, Base
+from sqlalchemy import text
+from db.database import get_engine, Base, upgrade_schema
 from db import models  # Import models to register them with Base
 
 
@@ -23,15 +24,14 @@ async def drop_all_tables():
     engine = get_engine()
     async with engine.begin() as conn:
         await conn.run_sync(Base.metadata.drop_all)
+        await conn.execute(text("DROP TABLE IF EXISTS alembic_version"))
     print("✓ All tables dropped")
 
 
 async def create_all_tables():
-    """Create all tables in the database."""
+    """Create all tables in the database by running every migration."""
     print("Creating all tables...")
-    engine = get_engine()
-    async with engine.begin() as conn:
-        await conn.run_sync(Base.metadata.create_all)
+    await asyncio.to_thread(upgrade_schema)
     print("✓ All tables created")
 
 
@@ -0,0 +1,90 @@
+"""
+Rebuild the places autocomplete completion sets (places:complete:{prefix}).
+
+First syncs every Place row into the Redis indexes with its bounce count and
+check-in count (active check-ins plus history), then rebuilds the top-K
+completion set of every prefix from places:meta:*. startup.py builds the
+sets from Redis alone when they are missing; run this to include places only
+in the database, and occasionally afterwards - sets are maintained
+incrementally, but a renamed or expired place can leave a prefix short of K.
+
+Run: python scripts/rebuild_place_completions.py
+
+Optional args:
+  --skip-db                    # Only rebuild from the places already in Redis
+"""
+
+import asyncio
+import argparse
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from sqlalchemy import text
+from db.database import create_async_session
+from services.places.autocomplete import (
+    get_indexed_place_count,
+    rebuild_completion_index,
+    sync_db_place_to_redis,
+)
+from services.redis import close_redis
+
+PLACES_WITH_COUNTS = """
+    SELECT p.place_id, p.name, p.address, p.latitude, p.longitude, p.types, p.bounce_count,
+           COALESCE(c.n, 0) + COALESCE(h.n, 0) AS checkin_count
+    FROM places p
+    LEFT JOIN (SELECT place_id, COUNT(*) AS n FROM check_ins WHERE place_id IS NOT NULL GROUP BY place_id) c
+        ON c.place_id = p.place_id
+    LEFT JOIN (SELECT place_id, COUNT(*) AS n FROM check_in_history GROUP BY place_id) h
+        ON h.place_id = p.place_id
+"""
+
+
+async def sync_db_places() -> int:
+    async with create_async_session() as db:
+        result = await db.execute(text(PLACES_WITH_COUNTS))
+        rows = result.fetchall()
+
+    synced = 0
+    for row in rows:
+        if row.latitude is None or row.longitude is None:
+            continue
+        if await sync_db_place_to_redis(
+            place_id=row.place_id,
+            name=row.name,
+            address=row.address,
+            lat=row.latitude,
+            lng=row.longitude,
+            types=row.types,
+            bounce_count=row.bounce_count or 0,
+            checkin_count=row.checkin_count,
+        ):
+            synced += 1
+    return synced
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Rebuild places autocomplete completion sets")
+    parser.add_argument("--skip-db", action="store_true", help="Only rebuild from the places already in Redis")
+    args = parser.parse_args()
+
+    print("=" * 60)
+    print("PLACES COMPLETION INDEX REBUILD")
+    print("=" * 60)
+
+    if not args.skip_db:
+        synced = await sync_db_places()
+        print(f"Synced {synced} place(s) from the database")
+
+    indexed = await rebuild_completion_index()
+    total = await get_indexed_place_count()
+    await close_redis()
+
+    print("=" * 60)
+    print(f"Done: {indexed} place(s) in completion sets ({total} in the lexical index)")
+    print("=" * 60)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,76 @@
+"""
+Recompute users.followers_count / users.following_count from the follows table.
+
+The counters are maintained by services/follow_graph.py on every follow write;
+this fixes any drift from writes that bypassed it (manual SQL, seed scripts).
+Only rows whose stored value differs are updated.
+
+Run: python scripts/reconcile_follow_counts.py
+
+Optional args:
+  --dry-run                    # Report drifted users without writing
+"""
+
+import asyncio
+import argparse
+import sys
+import os
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from sqlalchemy import text
+from db.database import create_async_session
+
+ACTUAL_COUNTS = """
+    SELECT u.id,
+           u.followers_count, COALESCE(f1.n, 0) AS actual_followers,
+           u.following_count, COALESCE(f2.n, 0) AS actual_following
+    FROM users u
+    LEFT JOIN (SELECT following_id AS id, COUNT(*) AS n FROM follows GROUP BY following_id) f1 ON f1.id = u.id
+    LEFT JOIN (SELECT follower_id AS id, COUNT(*) AS n FROM follows GROUP BY follower_id) f2 ON f2.id = u.id
+"""
+
+
+async def reconcile(dry_run: bool) -> int:
+    async with create_async_session() as db:
+        if dry_run:
+            result = await db.execute(text(f"""
+                SELECT * FROM ({ACTUAL_COUNTS}) c
+                WHERE followers_count <> actual_followers OR following_count <> actual_following
+                ORDER BY id
+            """))
+            rows = result.fetchall()
+            for row in rows:
+                print(f"  User {row.id}: followers {row.followers_count} -> {row.actual_followers}, "
+                      f"following {row.following_count} -> {row.actual_following}")
+            return len(rows)
+
+        result = await db.execute(text(f"""
+            UPDATE users u
+            SET followers_count = c.actual_followers, following_count = c.actual_following
+            FROM ({ACTUAL_COUNTS}) c
+            WHERE u.id = c.id
+              AND (c.followers_count <> c.actual_followers OR c.following_count <> c.actual_following)
+        """))
+        await db.commit()
+        return result.rowcount
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Recompute denormalized follow counters")
+    parser.add_argument("--dry-run", action="store_true", help="Report drifted users without writing")
+    args = parser.parse_args()
+
+    print("=" * 60)
+    print("FOLLOW COUNTER RECONCILIATION")
+    print("=" * 60)
+
+    fixed = await reconcile(args.dry_run)
+
+    print("=" * 60)
+    print(f"Done: {fixed} user(s) {'drifted' if args.dry_run else 'corrected'}")
+    print("=" * 60)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
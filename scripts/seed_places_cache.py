@@ -19,10 +19,9 @@ import os
 
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
-import aiohttp
-import ssl
-import certifi
+import httpx
 from core.config import settings
+from services.http_clients import GOOGLE, get_http_client, close_http_clients
 from services.places.autocomplete import index_place, get_indexed_place_count
 
 # Cities to seed with their center coordinates
@@ -61,17 +60,12 @@ VENUE_QUERIES = [
 GOOGLE_PLACES_TEXT_SEARCH_URL = "https://places.googleapis.com/v1/places:searchText"
 
 
-def get_ssl_context():
-    return ssl.create_default_context(cafile=certifi.where())
-
-
 async def text_search_places(
-    session: aiohttp.ClientSession,
+    client: httpx.AsyncClient,
     query: str,
     lat: float,
     lng: float,
     radius: float,
-    ssl_ctx,
     api_key: str,
 ) -> list[dict]:
     """
@@ -96,55 +90,53 @@ async def text_search_places(
     }
 
     try:
-        async with session.post(
+        resp = await client.post(
             GOOGLE_PLACES_TEXT_SEARCH_URL,
             headers=headers,
-            json=body,
-            ssl=ssl_ctx
-        ) as resp:
-            if resp.status != 200:
-                error = await resp.text()
-                print(f"    API error ({resp.status}): {error[:200]}")
-                return []
-
-            data = await resp.json()
-            places = []
-
-            for place in data.get("places", []):
-                place_id = place.get("id", "")
-                if not place_id:
-                    continue
-
-                display_name = place.get("displayName", {}).get("text", "")
-                address = place.get("formattedAddress", "")
-                location = place.get("location", {})
-                place_lat = location.get("latitude")
-                place_lng = location.get("longitude")
-                place_types = place.get("types", [])
-
-                # Build photo URL from first photo
-                photo_url = None
-                photos = place.get("photos", [])
-                if photos:
-                    photo_name = photos[0].get("name")
-                    if photo_name:
-                        photo_url = (
-                            f"https://places.googleapis.com/v1/{photo_name}/media"
-                            f"?maxWidthPx=800&key={api_key}"
-                        )
-
-                if place_lat is not None and place_lng is not None:
-                    places.append({
-                        "place_id": place_id,
-                        "name": display_name,
-                        "address": address,
-                        "lat": place_lat,
-                        "lng": place_lng,
-                        "types": place_types,
-                        "photo_url": photo_url,
-                    })
-
-            return places
+            json=body
+        )
+        if resp.status_code != 200:
+            print(f"    API error ({resp.status_code}): {resp.text[:200]}")
+            return []
+
+        data = resp.json()
+        places = []
+
+        for place in data.get("places", []):
+            place_id = place.get("id", "")
+            if not place_id:
+                continue
+
+            display_name = place.get("displayName", {}).get("text", "")
+            address = place.get("formattedAddress", "")
+            location = place.get("location", {})
+            place_lat = location.get("latitude")
+            place_lng = location.get("longitude")
+            place_types = place.get("types", [])
+
+            # Build photo URL from first photo
+            photo_url = None
+            photos = place.get("photos", [])
+            if photos:
+                photo_name = photos[0].get("name")
+                if photo_name:
+                    photo_url = (
+                        f"https://places.googleapis.com/v1/{photo_name}/media"
+                        f"?maxWidthPx=800&key={api_key}"
+                    )
+
+            if place_lat is not None and place_lng is not None:
+                places.append({
+                    "place_id": place_id,
+                    "name": display_name,
+                    "address": address,
+                    "lat": place_lat,
+                    "lng": place_lng,
+                    "types": place_types,
+                    "photo_url": photo_url,
+                })
+
+        return places
 
     except Exception as e:
         print(f"    Error: {e}")
@@ -152,10 +144,9 @@ async def text_search_places(
 
 
 async def seed_city(
-    session: aiohttp.ClientSession,
+    client: httpx.AsyncClient,
     city_name: str,
     city_config: dict,
-    ssl_ctx,
     api_key: str,
     dry_run: bool = False,
 ) -> int:
@@ -174,12 +165,11 @@ async def seed_city(
         print(f"\n  Searching: '{search_query}'")
 
         places = await text_search_places(
-            session,
+            client,
             search_query,
             city_config["lat"],
             city_config["lng"],
             city_config["radius"],
-            ssl_ctx,
             api_key,
         )
 
@@ -264,15 +254,17 @@ async def main():
         count_before = await get_indexed_place_count()
         print(f"Places in cache before: {count_before}")
 
-    ssl_ctx = get_ssl_context()
+    client = get_http_client(GOOGLE)
     total = 0
 
-    async with aiohttp.ClientSession() as session:
+    try:
         for city_name, city_config in cities_to_seed.items():
             count = await seed_city(
-                session, city_name, city_config, ssl_ctx, api_key, args.dry_run
+                client, city_name, city_config, api_key, args.dry_run
             )
             total += count
+    finally:
+        await close_http_clients()
 
     print("\n" + "=" * 60)
     print("SEEDING COMPLETE")
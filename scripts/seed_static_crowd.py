@@ -10,7 +10,6 @@ import random
 import uuid
 import sys
 import os
-import httpx
 
 # Add parent directory to path for imports
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -18,7 +17,9 @@ sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 from faker import Faker
 from sqlalchemy import text
 from db.database import create_async_session
+from reconcile_follow_counts import reconcile as reconcile_follow_counts
 from core.config import settings
+from services.http_clients import GOOGLE, get_http_client, close_http_clients
 
 
 async def search_place(query: str, lat: float, lon: float) -> dict | None:
@@ -28,59 +29,59 @@ async def search_place(query: str, lat: float, lon: float) -> dict | None:
         print(f"  WARNING: No Google API key, skipping {query}")
         return None
 
-    async with httpx.AsyncClient() as client:
-        # Text search with location bias
-        url = "https://maps.googleapis.com/maps/api/place/textsearch/json"
-        params = {
-            "query": query,
-            "location": f"{lat},{lon}",
-            "radius": 5000,
-            "key": api_key
-        }
-        response = await client.get(url, params=params)
-        data = response.json()
-
-        if data.get("status") != "OK" or not data.get("results"):
-            print(f"  WARNING: No results for {query}")
-            return None
-
-        place = data["results"][0]
-        place_id = place["place_id"]
-
-        # Get place details with photos
-        details_url = "https://maps.googleapis.com/maps/api/place/details/json"
-        details_params = {
-            "place_id": place_id,
-            "fields": "name,formatted_address,geometry,photos",
-            "key": api_key
-        }
-        details_response = await client.get(details_url, params=details_params)
-        details_data = details_response.json()
-
-        if details_data.get("status") != "OK":
-            return None
-
-        result = details_data.get("result", {})
-        location = result.get("geometry", {}).get("location", {})
-
-        # Get photo URL if available
-        photos = result.get("photos", [])
-        photo_url = None
-        photo_ref = None
-        if photos:
-            photo_ref = photos[0].get("photo_reference")
-            if photo_ref:
-                photo_url = f"https://maps.googleapis.com/maps/api/place/photo?maxwidth=400&photo_reference={photo_ref}&key={api_key}"
-
-        return {
-            "place_id": place_id,
-            "name": result.get("name", query),
-            "address": result.get("formatted_address", ""),
-            "lat": location.get("lat", lat),
-            "lon": location.get("lng", lon),
-            "photo_url": photo_url,
-            "photo_ref": photo_ref
-        }
+    client = get_http_client(GOOGLE)
+    # Text search with location bias
+    url = "https://maps.googleapis.com/maps/api/place/textsearch/json"
+    params = {
+        "query": query,
+        "location": f"{lat},{lon}",
+        "radius": 5000,
+        "key": api_key
+    }
+    response = await client.get(url, params=params)
+    data = response.json()
+
+    if data.get("status") != "OK" or not data.get("results"):
+        print(f"  WARNING: No results for {query}")
+        return None
+
+    place = data["results"][0]
+    place_id = place["place_id"]
+
+    # Get place details with photos
+    details_url = "https://maps.googleapis.com/maps/api/place/details/json"
+    details_params = {
+        "place_id": place_id,
+        "fields": "name,formatted_address,geometry,photos",
+        "key": api_key
+    }
+    details_response = await client.get(details_url, params=details_params)
+    details_data = details_response.json()
+
+    if details_data.get("status") != "OK":
+        return None
+
+    result = details_data.get("result", {})
+    location = result.get("geometry", {}).get("location", {})
+
+    # Get photo URL if available
+    photos = result.get("photos", [])
+    photo_url = None
+    photo_ref = None
+    if photos:
+        photo_ref = photos[0].get("photo_reference")
+        if photo_ref:
+            photo_url = f"https://maps.googleapis.com/maps/api/place/photo?maxwidth=400&photo_reference={photo_ref}&key={api_key}"
+
+    return {
+        "place_id": place_id,
+        "name": result.get("name", query),
+        "address": result.get("formatted_address", ""),
+        "lat": location.get("lat", lat),
+        "lon": location.get("lng", lon),
+        "photo_url": photo_url,
+        "photo_ref": photo_ref
+    }
 
 # Profile picture placeholders (random avatars)
 PROFILE_PICS = [
@@ -368,6 +369,8 @@ async def seed_static_crowd():
                 print(f"  Created {follow_count} follow relationships...")
 
         await db.commit()
+        # Raw INSERTs bypass services/follow_graph - recompute the follow counters
+        await reconcile_follow_counts(dry_run=False)
         print(f"Created {follow_count} follow relationships.")
 
         # 5. Set close friend status for mutual follows
@@ -424,6 +427,7 @@ async def seed_static_crowd():
         raise
     finally:
         await db.close()
+        await close_http_clients()
 
 
 if __name__ == "__main__":
@@ -16,6 +16,7 @@ sys.path.insert(0, str(Path(__file__).parent.parent))
 from faker import Faker
 from sqlalchemy import text
 from db.database import create_async_session
+from reconcile_follow_counts import reconcile as reconcile_follow_counts
 
 fake = Faker()
 
@@ -149,6 +150,8 @@ async def seed_user_data():
             )
 
         await db.commit()
+        # Raw INSERTs bypass services/follow_graph - recompute the follow counters
+        await reconcile_follow_counts(dry_run=False)
         print(f"   {len(follower_ids)} users now follow you")
         print(f"   You now follow {len(following_ids)} users")
 
@@ -5,9 +5,8 @@ from collections import deque
 from math import radians, sin, cos, sqrt, atan2
 from typing import Optional, Callable, Awaitable
 
-import httpx
-
 from core.config import settings
+from services.http_clients import GROQ, get_http_client
 
 logger = logging.getLogger(__name__)
 
@@ -119,26 +118,26 @@ class BounceCommentator:
         system = self._system_prompt()
         user = self._event_prompt(event)
 
-        async with httpx.AsyncClient(timeout=10) as client:
-            resp = await client.post(
-                "https://api.groq.com/openai/v1/chat/completions",
-                headers={
-                    "Authorization": f"Bearer {settings.GROQ_API_KEY}",
-                    "Content-Type": "application/json",
-                },
-                json={
-                    "model": "llama-3.1-8b-instant",
-                    "max_tokens": 150,
-                    "messages": [
-                        {"role": "system", "content": system},
-                        {"role": "user", "content": user},
-                    ],
-                },
-            )
-            if resp.status_code != 200:
-                logger.warning(f"Groq API {resp.status_code}: {resp.text[:200]}")
-                return None
-            return resp.json()["choices"][0]["message"]["content"].strip()
+        client = get_http_client(GROQ)
+        resp = await client.post(
+            "https://api.groq.com/openai/v1/chat/completions",
+            headers={
+                "Authorization": f"Bearer {settings.GROQ_API_KEY}",
+                "Content-Type": "application/json",
+            },
+            json={
+                "model": "llama-3.1-8b-instant",
+                "max_tokens": 150,
+                "messages": [
+                    {"role": "system", "content": system},
+                    {"role": "user", "content": user},
+                ],
+            },
+        )
+        if resp.status_code != 200:
+            logger.warning(f"Groq API {resp.status_code}: {resp.text[:200]}")
+            return None
+        return resp.json()["choices"][0]["message"]["content"].strip()
 
     def _system_prompt(self) -> str:
         names = [a["name"] for a in self.attendees.values()]
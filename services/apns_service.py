@@ -2,6 +2,7 @@
 Apple Push Notification Service (APNs) handler for Basel Radar
 Uses httpx with HTTP/2 to avoid uvloop compatibility issues with aioapns
 """
+import asyncio
 import base64
 import json
 import logging
@@ -9,7 +10,6 @@ import time
 from typing import Optional, Dict, Any, List
 from enum import Enum
 from dataclasses import dataclass
-from datetime import datetime, timezone
 
 import httpx
 import jwt
@@ -17,10 +17,11 @@ from cryptography.hazmat.primitives import serialization
 from cryptography.hazmat.backends import default_backend
 
 from sqlalchemy.ext.asyncio import AsyncSession
-from sqlalchemy import select, and_, update
+from sqlalchemy import select
 
 from core.config import settings
-from db.models import DeviceToken, NotificationPreference
+from db.models import NotificationPreference
+from services.device_tokens import ActiveToken, TokenFeedback, get_active_tokens, get_active_tokens_bulk
 
 logger = logging.getLogger(__name__)
 
@@ -28,6 +29,9 @@ logger = logging.getLogger(__name__)
 APNS_PRODUCTION_URL = "https://api.push.apple.com"
 APNS_SANDBOX_URL = "https://api.sandbox.push.apple.com"
 
+# In-flight requests per batch send - multiplexed as HTTP/2 streams on one connection
+MAX_CONCURRENT_SENDS = 200
+
 
 class NotificationType(str, Enum):
     NEW_FOLLOWER = "new_follower"
@@ -110,16 +114,28 @@ class APNsService:
                 backend=default_backend()
             )
 
-            # Create HTTP/2 client
-            self._client = httpx.AsyncClient(http2=True, timeout=30.0)
+            # Create HTTP/2 client. A plain http:// base URL (local mock server)
+            # has no TLS/ALPN, so speak HTTP/2 with prior knowledge there.
+            base_url = self._get_base_url()
+            self._client = httpx.AsyncClient(
+                http2=True,
+                http1=not base_url.startswith("http://"),
+                timeout=30.0,
+            )
 
             self._initialized = True
-            logger.info(f"APNs service initialized (sandbox={settings.APNS_USE_SANDBOX})")
+            logger.info(f"APNs service initialized (sandbox={settings.APNS_USE_SANDBOX}, url={base_url})")
         except Exception as e:
             logger.error(f"Failed to initialize APNs service: {e}")
             self._private_key = None
             self._initialized = True
 
+    def _get_base_url(self) -> str:
+        """APNs host to post to - APNS_BASE_URL override, else sandbox/production"""
+        if settings.APNS_BASE_URL:
+            return settings.APNS_BASE_URL.rstrip("/")
+        return APNS_SANDBOX_URL if settings.APNS_USE_SANDBOX else APNS_PRODUCTION_URL
+
     def _get_jwt_token(self) -> str:
         """Get or refresh JWT token for APNs authentication"""
         # Token is valid for 1 hour, refresh every 50 minutes
@@ -162,7 +178,7 @@ class APNsService:
         db: AsyncSession,
         user_id: int,
         notification_type: NotificationType
-    ) -> List[DeviceToken]:
+    ) -> List[ActiveToken]:
         """Get active device tokens for user if notification type is enabled"""
 
         # Check user's notification preferences
@@ -186,19 +202,8 @@ class APNsService:
                 logger.debug(f"Notification type {notification_type} disabled for user {user_id}")
                 return []
 
-        # Get active device tokens
-        tokens_result = await db.execute(
-            select(DeviceToken).where(
-                DeviceToken.user_id == user_id
-            )
-        )
-        all_user_tokens = tokens_result.scalars().all()
-        logger.info(f"APNs: User {user_id} has {len(all_user_tokens)} total token(s) in DB")
-        for t in all_user_tokens:
-            logger.info(f"APNs:   - Token: {t.device_token[:20]}... active={t.is_active} sandbox={t.is_sandbox}")
-
-        active_tokens = [t for t in all_user_tokens if t.is_active]
-        return active_tokens
+        # Active tokens come from the compact token index, not full DeviceToken rows
+        return await get_active_tokens(db, user_id)
 
     def _build_aps_payload(self, payload: NotificationPayload, badge_count: int = 1) -> Dict[str, Any]:
         """Build APNs payload with custom data"""
@@ -250,10 +255,9 @@ class APNsService:
             return False, "APNs not initialized"
 
         # Use server config to determine which APNs server to use
-        use_sandbox = settings.APNS_USE_SANDBOX
-        base_url = APNS_SANDBOX_URL if use_sandbox else APNS_PRODUCTION_URL
+        base_url = self._get_base_url()
         url = f"{base_url}/3/device/{token}"
-        logger.info(f"APNs: Sending to {'SANDBOX' if use_sandbox else 'PRODUCTION'} server")
+        logger.debug(f"APNs: Sending to {base_url}")
 
         headers = {
             "authorization": f"bearer {self._get_jwt_token()}",
@@ -284,6 +288,27 @@ class APNsService:
             logger.error(f"HTTP error sending to APNs: {e}")
             return False, str(e)
 
+    async def _filter_enabled_users(
+        self,
+        db: AsyncSession,
+        user_ids: List[int],
+        notification_type: NotificationType
+    ) -> List[int]:
+        """Drop users who disabled push or this notification type (one query per batch)"""
+        pref_field = self._notification_type_to_preference_field(notification_type)
+        result = await db.execute(
+            select(
+                NotificationPreference.user_id,
+                NotificationPreference.push_enabled,
+                getattr(NotificationPreference, pref_field),
+            ).where(NotificationPreference.user_id.in_(user_ids))
+        )
+        disabled = {
+            user_id for user_id, push_enabled, type_enabled in result.all()
+            if not push_enabled or type_enabled is False
+        }
+        return [user_id for user_id in user_ids if user_id not in disabled]
+
     async def send_notification(
         self,
         db: AsyncSession,
@@ -291,55 +316,75 @@ class APNsService:
         payload: NotificationPayload
     ) -> bool:
         """Send push notification to a user's devices"""
-        from services.redis import increment_badge_count
+        results = await self.send_notification_batch(db, [user_id], payload)
+        return results.get(user_id, False)
+
+    async def send_notification_batch(
+        self,
+        db: AsyncSession,
+        user_ids: List[int],
+        payload: NotificationPayload
+    ) -> Dict[int, bool]:
+        """
+        Send the same notification to many users.
 
+        Preferences, tokens and badge counts are each fetched once for the whole
+        batch (badges in a single pipelined INCR), every recipient's payload
+        carries its own badge count, and token feedback is flushed once.
+        """
+        from services.redis import increment_badge_counts, redis_available
+
+        results = {user_id: False for user_id in user_ids}
         if not self._private_key:
             logger.warning("APNs not initialized - skipping push")
-            return False
+            return results
 
-        device_tokens = await self._get_user_tokens(db, user_id, payload.notification_type)
-        logger.info(f"APNs: Found {len(device_tokens)} token(s) for user {user_id}")
+        enabled = await self._filter_enabled_users(db, list(results), payload.notification_type)
+        tokens_by_user = await get_active_tokens_bulk(db, enabled)
+        recipients = [user_id for user_id in enabled if tokens_by_user.get(user_id)]
 
-        if not device_tokens:
-            logger.warning(f"APNs: No active tokens for user {user_id} or notification disabled")
-            return False
+        if not recipients:
+            logger.info(f"APNs: No active tokens or notification disabled for {len(results)} user(s)")
+            return results
 
-        # Increment badge count for user
-        badge_count = await increment_badge_count(user_id)
-        aps_payload = self._build_aps_payload(payload, badge_count)
+        badge_counts = {}
+        if redis_available():  # Degraded: every payload falls back to badge 1
+            try:
+                badge_counts = await increment_badge_counts(recipients)
+            except Exception as e:
+                logger.warning(f"APNs: Badge count update failed: {e}")
 
-        success = False
-        for device_token in device_tokens:
-            sent, error = await self._send_to_token(
-                device_token.device_token,
-                device_token.is_sandbox,
-                aps_payload
-            )
+        feedback = TokenFeedback()
+        semaphore = asyncio.Semaphore(MAX_CONCURRENT_SENDS)
 
-            if sent:
-                logger.info(f"Push sent to user {user_id}, token {device_token.device_token[:20]}...")
-                success = True
-
-                # Update last_used_at
-                await db.execute(
-                    update(DeviceToken)
-                    .where(DeviceToken.device_token == device_token.device_token)
-                    .values(last_used_at=datetime.now(timezone.utc))
+        async def send(user_id: int, device_token: ActiveToken, aps_payload: Dict[str, Any]):
+            async with semaphore:
+                sent, error = await self._send_to_token(
+                    device_token.device_token,
+                    device_token.is_sandbox,
+                    aps_payload
                 )
+            feedback.record(device_token.device_token, sent, error)
+
+            if sent:
+                logger.debug(f"Push sent to user {user_id}, token {device_token.device_token[:20]}...")
+                results[user_id] = True
             else:
                 logger.warning(f"Push failed for user {user_id}: {error}")
 
-                # Handle invalid tokens
-                if error in ['BadDeviceToken', 'Unregistered', 'DeviceTokenNotForTopic']:
-                    await db.execute(
-                        update(DeviceToken)
-                        .where(DeviceToken.device_token == device_token.device_token)
-                        .values(is_active=False)
-                    )
-                    logger.info(f"Deactivated invalid token for user {user_id}")
+        sends = []
+        for user_id in recipients:
+            aps_payload = self._build_aps_payload(payload, badge_counts.get(user_id, 1))
+            for device_token in tokens_by_user[user_id]:
+                sends.append(send(user_id, device_token, aps_payload))
+        await asyncio.gather(*sends)
 
-        await db.commit()
-        return success
+        # last_used_at, failure scores and deactivations in one round of UPDATEs
+        await feedback.flush(db)
+
+        delivered = sum(1 for sent in results.values() if sent)
+        logger.info(f"APNs: {payload.notification_type.value} delivered to {delivered}/{len(results)} user(s)")
+        return results
 
     async def send_to_multiple_users(
         self,
@@ -348,10 +393,7 @@ class APNsService:
         payload: NotificationPayload
     ) -> Dict[int, bool]:
         """Send notification to multiple users"""
-        results = {}
-        for user_id in user_ids:
-            results[user_id] = await self.send_notification(db, user_id, payload)
-        return results
+        return await self.send_notification_batch(db, user_ids, payload)
 
     async def send_silent_push(self, db: AsyncSession, user_id: int) -> bool:
         """Send a silent push notification to wake the app in background for location broadcasting"""
@@ -359,13 +401,7 @@ class APNsService:
             return False
 
         # Get active device tokens directly (skip notification preference check)
-        tokens_result = await db.execute(
-            select(DeviceToken).where(
-                DeviceToken.user_id == user_id,
-                DeviceToken.is_active == True
-            )
-        )
-        device_tokens = tokens_result.scalars().all()
+        device_tokens = await get_active_tokens(db, user_id)
 
         if not device_tokens:
             return False
@@ -378,9 +414,9 @@ class APNsService:
         }
 
         success = False
+        feedback = TokenFeedback()
         for device_token in device_tokens:
-            base_url = APNS_SANDBOX_URL if settings.APNS_USE_SANDBOX else APNS_PRODUCTION_URL
-            url = f"{base_url}/3/device/{device_token.device_token}"
+            url = f"{self._get_base_url()}/3/device/{device_token.device_token}"
 
             headers = {
                 "authorization": f"bearer {self._get_jwt_token()}",
@@ -393,23 +429,18 @@ class APNsService:
                 response = await self._client.post(url, json=silent_payload, headers=headers)
                 if response.status_code == 200:
                     success = True
+                    feedback.record(device_token.device_token, True, None)
                 else:
                     try:
                         error_data = response.json()
                         reason = error_data.get("reason", "Unknown")
                     except:
                         reason = f"HTTP {response.status_code}"
-
-                    if reason in ['BadDeviceToken', 'Unregistered', 'DeviceTokenNotForTopic']:
-                        await db.execute(
-                            update(DeviceToken)
-                            .where(DeviceToken.device_token == device_token.device_token)
-                            .values(is_active=False)
-                        )
+                    feedback.record(device_token.device_token, False, reason)
             except Exception as e:
                 logger.error(f"Silent push error for user {user_id}: {e}")
 
-        await db.commit()
+        await feedback.flush(db)
         return success
 
 
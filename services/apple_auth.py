@@ -1,6 +1,6 @@
-import httpx
 import logging
 from core.config import settings
+from services.http_clients import APPLE, get_http_client
 
 logger = logging.getLogger(__name__)
 
@@ -29,14 +29,14 @@ async def verify_apple_token(code: str, redirect_uri: str) -> dict:
 
     logger.info(f"Sending request to Apple with client_id: {settings.APPLE_CLIENT_ID}")
 
-    async with httpx.AsyncClient() as client:
-        response = await client.post(url, data=data)
+    client = get_http_client(APPLE)
+    response = await client.post(url, data=data)
 
-        if response.status_code != 200:
-            logger.error(f"Apple auth failed with status {response.status_code}: {response.text}")
-            raise Exception(f"Apple auth failed: {response.text}")
+    if response.status_code != 200:
+        logger.error(f"Apple auth failed with status {response.status_code}: {response.text}")
+        raise Exception(f"Apple auth failed: {response.text}")
 
-        token_data = response.json()
+    token_data = response.json()
 
     # Decode id_token to get user info
     from jose import jwt
@@ -129,7 +129,7 @@ async def refresh_apple_token(refresh_token: str) -> dict:
         "refresh_token": refresh_token
     }
 
-    async with httpx.AsyncClient() as client:
-        response = await client.post(url, data=data)
-        response.raise_for_status()
-        return response.json()
+    client = get_http_client(APPLE)
+    response = await client.post(url, data=data)
+    response.raise_for_status()
+    return response.json()
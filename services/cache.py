@@ -1,30 +1,152 @@
-"""Redis caching service for high-traffic endpoints"""
+"""
+Two-tier cache for high-traffic endpoints.
 
+Values are stored as JSON in Redis, with a small in-process TTL/LRU in front
+so hot keys skip the network. Local entries live at most LOCAL_TTL seconds,
+which bounds how long another worker keeps serving a value after cache_delete
+(cache_get_or_load can raise this for values that are never invalidated).
+
+- cache_get slides the Redis TTL with a single GETEX instead of GET + EXPIRE.
+- cache_get_or_load runs one loader per key per process however many requests
+  miss at once (single-flight). With stale_ttl it also serves an expired value
+  for up to stale_ttl seconds while one background load refreshes it.
+- Hits, misses and latency are counted per key prefix (the part before the
+  first ":"), see cache_stats().
+- cache_delete bumps the key's generation (cache_gen:{key}); a load that read
+  an older generation before calling its loader doesn't write its result, so
+  a value loaded before a write can't land after the write's invalidation.
+
+Every call degrades to a miss if Redis is unavailable - caching is optional.
+While the Redis circuit breaker is open only the local tier is used.
+"""
+
+import asyncio
+import fnmatch
 import json
-from typing import Any, Optional
-from services.redis import get_redis
+import logging
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Any, Awaitable, Callable, Dict, Optional, Set
+
+from redis.exceptions import WatchError
+
+from services.redis import get_redis, redis_available
+
+logger = logging.getLogger(__name__)
 
 # 7 days in seconds
 DEFAULT_TTL = 604800
 
+LOCAL_TTL = 5  # seconds in-process
+LOCAL_MAX_ENTRIES = 10_000
 
-async def cache_get(key: str, reset_ttl: bool = True) -> Optional[Any]:
-    """Get value from cache, returns None if not found or Redis unavailable.
-    Resets TTL to 7 days on access by default."""
+# Generation keys must outlive the slowest loader
+GENERATION_PREFIX = "cache_gen:"
+GENERATION_TTL = 3600
+
+# Envelope fields for stale-while-revalidate entries
+VALUE_FIELD = "v"
+FRESH_UNTIL_FIELD = "fresh_until"
+
+
+@dataclass
+class PrefixStats:
+    local_hits: int = 0
+    redis_hits: int = 0
+    stale_hits: int = 0
+    misses: int = 0
+    bypassed: int = 0  # Lookups that skipped Redis because its breaker was open
+    loads: int = 0
+    load_errors: int = 0
+    redis_seconds: float = 0.0
+    load_seconds: float = 0.0
+
+
+_stats: Dict[str, PrefixStats] = {}
+
+# key -> (expires_at, value), oldest first
+_local_cache: "OrderedDict[str, tuple[float, Any]]" = OrderedDict()
+
+# key -> running loader, shared by every concurrent miss
+_inflight: Dict[str, asyncio.Task] = {}
+
+# Loaders that were running when their key was deleted - their result is dropped
+_invalidated_loads: Set[asyncio.Task] = set()
+
+_MISSING = object()
+
+
+def _generation_key(key: str) -> str:
+    return f"{GENERATION_PREFIX}{key}"
+
+
+def _prefix_stats(key: str) -> PrefixStats:
+    prefix = key.split(":", 1)[0]
+    stats = _stats.get(prefix)
+    if stats is None:
+        stats = _stats[prefix] = PrefixStats()
+    return stats
+
+
+def _local_get(key: str) -> Any:
+    entry = _local_cache.get(key)
+    if entry is None:
+        return _MISSING
+    expires_at, value = entry
+    if expires_at < time.monotonic():
+        _local_cache.pop(key, None)
+        return _MISSING
+    _local_cache.move_to_end(key)
+    return value
+
+
+def _local_put(key: str, value: Any, ttl: int, local_ttl: int = LOCAL_TTL) -> None:
+    _local_cache[key] = (time.monotonic() + min(local_ttl, ttl), value)
+    _local_cache.move_to_end(key)
+    while len(_local_cache) > LOCAL_MAX_ENTRIES:
+        _local_cache.popitem(last=False)
+
+
+async def _read(key: str, slide_ttl: Optional[int], local_ttl: int = LOCAL_TTL) -> Any:
+    """Local tier, then Redis (GETEX when sliding). Returns _MISSING on miss."""
+    stats = _prefix_stats(key)
+    value = _local_get(key)
+    if value is not _MISSING:
+        stats.local_hits += 1
+        return value
+
+    if not redis_available():
+        stats.bypassed += 1
+        stats.misses += 1
+        return _MISSING
+
+    start = time.perf_counter()
     try:
         redis = await get_redis()
-        value = await redis.get(key)
-        if value:
-            if reset_ttl:
-                await redis.expire(key, DEFAULT_TTL)
-            return json.loads(value)
-        return None
+        if slide_ttl:
+            raw = await redis.getex(key, ex=slide_ttl)
+        else:
+            raw = await redis.get(key)
     except Exception:
-        return None
+        raw = None
+    finally:
+        stats.redis_seconds += time.perf_counter() - start
 
+    if raw is None:
+        stats.misses += 1
+        return _MISSING
 
-async def cache_set(key: str, value: Any, ttl: int = DEFAULT_TTL) -> None:
-    """Set value in cache with TTL in seconds (default 7 days)"""
+    stats.redis_hits += 1
+    value = json.loads(raw)
+    _local_put(key, value, slide_ttl or local_ttl, local_ttl)
+    return value
+
+
+async def _write(key: str, value: Any, ttl: int, local_ttl: int = LOCAL_TTL) -> None:
+    _local_put(key, value, ttl, local_ttl)
+    if not redis_available():
+        return
     try:
         redis = await get_redis()
         await redis.setex(key, ttl, json.dumps(value))
@@ -32,17 +154,165 @@ async def cache_set(key: str, value: Any, ttl: int = DEFAULT_TTL) -> None:
         pass  # Fail silently - caching is optional
 
 
+async def _read_generation(key: str) -> Any:
+    """Current generation of key in Redis (None if never deleted), _MISSING if unknown"""
+    if not redis_available():
+        return _MISSING
+    try:
+        redis = await get_redis()
+        return await redis.get(_generation_key(key))
+    except Exception:
+        return _MISSING
+
+
+async def _write_if_current(key: str, value: Any, ttl: int, local_ttl: int, generation: Any) -> None:
+    """_write, unless cache_delete bumped key's generation since it was read"""
+    if generation is _MISSING or not redis_available():
+        await _write(key, value, ttl, local_ttl)
+        return
+    try:
+        redis = await get_redis()
+        async with redis.pipeline(transaction=True) as pipe:
+            await pipe.watch(_generation_key(key))
+            if await pipe.get(_generation_key(key)) != generation:
+                return
+            pipe.multi()
+            pipe.setex(key, ttl, json.dumps(value))
+            await pipe.execute()
+    except WatchError:
+        return
+    except Exception:
+        pass  # Fail silently - caching is optional
+    _local_put(key, value, ttl, local_ttl)
+
+
+async def cache_get(key: str, reset_ttl: bool = True, ttl: int = DEFAULT_TTL) -> Optional[Any]:
+    """Get value from cache, returns None if not found or Redis unavailable.
+    Slides the Redis TTL to ttl (default 7 days) on access by default."""
+    value = await _read(key, ttl if reset_ttl else None)
+    return None if value is _MISSING else value
+
+
+async def cache_set(key: str, value: Any, ttl: int = DEFAULT_TTL) -> None:
+    """Set value in cache with TTL in seconds (default 7 days)"""
+    await _write(key, value, ttl)
+
+
+async def _load(
+    key: str,
+    loader: Callable[[], Awaitable[Any]],
+    ttl: int,
+    stale_ttl: int,
+    local_ttl: int
+) -> Any:
+    stats = _prefix_stats(key)
+    generation = await _read_generation(key)
+    start = time.perf_counter()
+    try:
+        value = await loader()
+    except Exception:
+        stats.load_errors += 1
+        raise
+    finally:
+        stats.loads += 1
+        stats.load_seconds += time.perf_counter() - start
+
+    # Deleted in this process while loading - the value may predate the write
+    if value is not None and asyncio.current_task() not in _invalidated_loads:
+        if stale_ttl:
+            entry = {VALUE_FIELD: value, FRESH_UNTIL_FIELD: time.time() + ttl}
+            await _write_if_current(key, entry, ttl + stale_ttl, local_ttl, generation)
+        else:
+            await _write_if_current(key, value, ttl, local_ttl, generation)
+    return value
+
+
+def _finish_load(key: str, task: asyncio.Task) -> None:
+    if _inflight.get(key) is task:
+        del _inflight[key]
+    _invalidated_loads.discard(task)
+    # Retrieve the exception so background refreshes don't warn as unhandled
+    if not task.cancelled() and task.exception() is not None:
+        logger.warning(f"Cache loader for {key} failed: {task.exception()}")
+
+
+def _start_load(
+    key: str,
+    loader: Callable[[], Awaitable[Any]],
+    ttl: int,
+    stale_ttl: int,
+    local_ttl: int
+) -> asyncio.Task:
+    """Running loader for key, starting one if none is in flight"""
+    task = _inflight.get(key)
+    if task is None:
+        # Own task, so one caller disconnecting doesn't cancel the load for the rest
+        task = asyncio.create_task(_load(key, loader, ttl, stale_ttl, local_ttl))
+        _inflight[key] = task
+        task.add_done_callback(lambda t: _finish_load(key, t))
+    return task
+
+
+async def cache_get_or_load(
+    key: str,
+    loader: Callable[[], Awaitable[Any]],
+    ttl: int = DEFAULT_TTL,
+    stale_ttl: int = 0,
+    reset_ttl: bool = False,
+    local_ttl: int = LOCAL_TTL
+) -> Any:
+    """
+    Cached value for key, calling loader() on a miss. Concurrent misses in this
+    process share one loader call; its exception propagates to all of them.
+    A None result is returned but not cached.
+
+    stale_ttl > 0 enables stale-while-revalidate: for stale_ttl seconds after a
+    value expires it is still returned while a background load refreshes it.
+    Such keys hold an envelope - read them only through this function.
+    reset_ttl slides the TTL on hits and applies only without stale_ttl.
+    local_ttl is how long this process serves the value without asking Redis -
+    raise it only for values that are never invalidated.
+    """
+    if stale_ttl:
+        entry = await _read(key, None, local_ttl)
+        if entry is not _MISSING:
+            if entry[FRESH_UNTIL_FIELD] > time.time():
+                return entry[VALUE_FIELD]
+            _prefix_stats(key).stale_hits += 1
+            _start_load(key, loader, ttl, stale_ttl, local_ttl)
+            return entry[VALUE_FIELD]
+    else:
+        value = await _read(key, ttl if reset_ttl else None, local_ttl)
+        if value is not _MISSING:
+            return value
+
+    return await asyncio.shield(_start_load(key, loader, ttl, stale_ttl, local_ttl))
+
+
 async def cache_delete(key: str) -> None:
-    """Delete a single cache key"""
+    """Delete a single cache key and drop any load of it already in flight"""
+    _local_cache.pop(key, None)
+    # Later misses start a fresh load instead of joining one that may predate the write
+    task = _inflight.pop(key, None)
+    if task is not None:
+        _invalidated_loads.add(task)
+    if not redis_available():
+        return
     try:
         redis = await get_redis()
-        await redis.delete(key)
+        pipe = redis.pipeline(transaction=True)
+        pipe.delete(key)
+        pipe.incr(_generation_key(key))
+        pipe.expire(_generation_key(key), GENERATION_TTL)
+        await pipe.execute()
     except Exception:
         pass
 
 
 async def cache_delete_pattern(pattern: str) -> None:
-    """Delete all keys matching pattern (e.g., 'user_stats:*')"""
+    """Delete all keys matching pattern (e.g., 'place_details:*')"""
+    for key in [k for k in _local_cache if fnmatch.fnmatchcase(k, pattern)]:
+        _local_cache.pop(key, None)
     try:
         redis = await get_redis()
         cursor = 0
@@ -54,3 +324,25 @@ async def cache_delete_pattern(pattern: str) -> None:
                 break
     except Exception:
         pass
+
+
+def cache_stats() -> Dict[str, Dict[str, Any]]:
+    """Per-prefix hit/miss counters and average latencies for this process"""
+    report = {}
+    for prefix, stats in sorted(_stats.items()):
+        hits = stats.local_hits + stats.redis_hits  # stale_hits are a subset of these
+        lookups = hits + stats.misses
+        redis_reads = stats.redis_hits + stats.misses - stats.bypassed
+        report[prefix] = {
+            "local_hits": stats.local_hits,
+            "redis_hits": stats.redis_hits,
+            "stale_hits": stats.stale_hits,
+            "misses": stats.misses,
+            "bypassed": stats.bypassed,
+            "hit_rate": round(hits / lookups, 3) if lookups else None,
+            "loads": stats.loads,
+            "load_errors": stats.load_errors,
+            "avg_redis_ms": round(stats.redis_seconds / redis_reads * 1000, 2) if redis_reads else None,
+            "avg_load_ms": round(stats.load_seconds / stats.loads * 1000, 2) if stats.loads else None,
+        }
+    return report
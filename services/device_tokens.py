@@ -0,0 +1,331 @@
+"""
+Device token lifecycle for push notifications.
+
+- Active-token index: the push engine reads a user's live tokens from a compact
+  Redis hash (apns_tokens:{user_id} -> {token: "1" sandbox / "0" production})
+  rebuilt from device_tokens on miss and dropped whenever the user's tokens change.
+  Dropping also bumps apns_tokens:version:{user_id}; a rebuild only writes back
+  if that version is unchanged since before its DB read, so a list read just
+  before a token change can't overwrite the invalidation.
+- Feedback: APNs results are collected per send and written back in a few
+  set-based UPDATEs instead of one UPDATE per token.
+- Failure score: transient per-token failures bump failure_score, a success
+  resets it, and a token reaching DEVICE_TOKEN_MAX_FAILURES is deactivated.
+- Pruning: a background loop deletes tokens unused for DEVICE_TOKEN_STALE_DAYS.
+"""
+import asyncio
+import logging
+from dataclasses import dataclass, field
+from datetime import datetime, timezone, timedelta
+from typing import Optional, Dict, List, Iterable, Set
+
+from redis.exceptions import WatchError
+from sqlalchemy import select, update, text
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from core.config import settings
+from db.models import DeviceToken
+
+logger = logging.getLogger(__name__)
+
+TOKEN_INDEX_PREFIX = "apns_tokens:"
+TOKEN_VERSION_PREFIX = "apns_tokens:version:"
+TOKEN_INDEX_TTL = 3600  # 1 hour - index is invalidated on writes, TTL only bounds drift
+EMPTY_INDEX_FIELD = "_none"  # Caches "user has no active tokens"
+
+PRUNE_INTERVAL_SECONDS = 6 * 3600
+PRUNE_BATCH_SIZE = 1000
+PRUNE_LOCK_KEY = "apns_tokens:prune_lock"
+
+# APNs reasons meaning the token will never be deliverable again
+PERMANENT_FAILURE_REASONS = {"BadDeviceToken", "Unregistered", "DeviceTokenNotForTopic", "ExpiredToken"}
+
+# Per-token failures that may clear up - these count toward failure_score.
+# Provider-side errors (bad JWT, bad topic, payload too large) are not the token's fault.
+SCORED_FAILURE_REASONS = {"TooManyRequests", "InternalServerError", "ServiceUnavailable", "Shutdown"}
+
+
+@dataclass
+class ActiveToken:
+    """Slim view of an active DeviceToken row"""
+    device_token: str
+    is_sandbox: bool
+
+
+def _index_key(user_id: int) -> str:
+    return f"{TOKEN_INDEX_PREFIX}{user_id}"
+
+
+def _version_key(user_id: int) -> str:
+    return f"{TOKEN_VERSION_PREFIX}{user_id}"
+
+
+def _decode_index(entry: Dict[str, str]) -> List[ActiveToken]:
+    return [
+        ActiveToken(device_token=token, is_sandbox=flag == "1")
+        for token, flag in entry.items()
+        if token != EMPTY_INDEX_FIELD
+    ]
+
+
+async def _load_active_tokens(db: AsyncSession, user_ids: List[int]) -> Dict[int, List[ActiveToken]]:
+    """Read active tokens for users straight from the partial index on device_tokens"""
+    result = await db.execute(
+        select(DeviceToken.user_id, DeviceToken.device_token, DeviceToken.is_sandbox).where(
+            DeviceToken.user_id.in_(user_ids),
+            DeviceToken.is_active == True
+        )
+    )
+    tokens: Dict[int, List[ActiveToken]] = {user_id: [] for user_id in user_ids}
+    for user_id, device_token, is_sandbox in result.all():
+        tokens[user_id].append(ActiveToken(device_token=device_token, is_sandbox=bool(is_sandbox)))
+    return tokens
+
+
+async def get_active_tokens_bulk(db: AsyncSession, user_ids: Iterable[int]) -> Dict[int, List[ActiveToken]]:
+    """
+    Active tokens for many users: one pipelined HGETALL, one DB query for the
+    misses, one write-back guarded by the users' index versions.
+    """
+    from services.redis import get_redis
+
+    user_ids = list(dict.fromkeys(user_ids))
+    if not user_ids:
+        return {}
+
+    tokens: Dict[int, List[ActiveToken]] = {}
+    misses = user_ids
+    versions: Dict[int, Optional[str]] = {}
+    r = None
+    try:
+        r = await get_redis()
+        pipe = r.pipeline(transaction=False)
+        for user_id in user_ids:
+            pipe.hgetall(_index_key(user_id))
+            pipe.get(_version_key(user_id))
+        results = await pipe.execute()
+        misses = []
+        for i, user_id in enumerate(user_ids):
+            entry, version = results[2 * i], results[2 * i + 1]
+            if entry:
+                tokens[user_id] = _decode_index(entry)
+            else:
+                misses.append(user_id)
+                versions[user_id] = version
+    except Exception as e:
+        logger.warning(f"Token index read failed, falling back to DB: {e}")
+        r = None
+
+    if not misses:
+        return tokens
+
+    loaded = await _load_active_tokens(db, misses)
+    tokens.update(loaded)
+
+    if r is not None:
+        try:
+            async with r.pipeline(transaction=True) as pipe:
+                version_keys = [_version_key(user_id) for user_id in misses]
+                await pipe.watch(*version_keys)
+                current = await pipe.mget(version_keys)
+                pipe.multi()
+                for user_id, version in zip(misses, current):
+                    # Tokens changed since the DB read - leave the index to the next miss
+                    if version != versions[user_id]:
+                        continue
+                    key = _index_key(user_id)
+                    mapping = {t.device_token: "1" if t.is_sandbox else "0" for t in loaded[user_id]}
+                    pipe.delete(key)
+                    pipe.hset(key, mapping=mapping or {EMPTY_INDEX_FIELD: "1"})
+                    pipe.expire(key, TOKEN_INDEX_TTL)
+                await pipe.execute()
+        except WatchError:
+            pass
+        except Exception as e:
+            logger.warning(f"Token index write failed: {e}")
+
+    return tokens
+
+
+async def get_active_tokens(db: AsyncSession, user_id: int) -> List[ActiveToken]:
+    """Active tokens for one user via the index"""
+    tokens = await get_active_tokens_bulk(db, [user_id])
+    return tokens.get(user_id, [])
+
+
+async def invalidate_token_index(user_ids: Iterable[int]) -> None:
+    """Drop cached token index entries - call after committing token changes"""
+    from services.redis import get_redis
+
+    user_ids = set(user_ids)
+    if not user_ids:
+        return
+    try:
+        r = await get_redis()
+        pipe = r.pipeline(transaction=True)
+        for user_id in user_ids:
+            pipe.delete(_index_key(user_id))
+            pipe.incr(_version_key(user_id))
+            pipe.expire(_version_key(user_id), TOKEN_INDEX_TTL)
+        await pipe.execute()
+    except Exception as e:
+        logger.warning(f"Token index invalidation failed: {e}")
+
+
+@dataclass
+class TokenFeedback:
+    """
+    Collects APNs send results so they can be applied in bulk.
+
+    record() after every send, flush() once per batch.
+    """
+    delivered: Set[str] = field(default_factory=set)
+    permanent: Set[str] = field(default_factory=set)
+    scored: Set[str] = field(default_factory=set)
+
+    def record(self, device_token: str, sent: bool, reason: Optional[str]) -> None:
+        if sent:
+            self.delivered.add(device_token)
+        elif reason in PERMANENT_FAILURE_REASONS:
+            self.permanent.add(device_token)
+        elif reason in SCORED_FAILURE_REASONS:
+            self.scored.add(device_token)
+
+    async def flush(self, db: AsyncSession) -> None:
+        """Apply collected results (at most three UPDATEs), commit, refresh index"""
+        if not (self.delivered or self.permanent or self.scored):
+            return
+
+        now = datetime.now(timezone.utc)
+        deactivated_users: Set[int] = set()
+
+        if self.delivered:
+            await db.execute(
+                update(DeviceToken)
+                .where(DeviceToken.device_token.in_(list(self.delivered)))
+                .values(last_used_at=now, failure_score=0)
+                .execution_options(synchronize_session=False)
+            )
+
+        if self.permanent:
+            result = await db.execute(
+                update(DeviceToken)
+                .where(
+                    DeviceToken.device_token.in_(list(self.permanent)),
+                    DeviceToken.is_active == True
+                )
+                .values(is_active=False)
+                .returning(DeviceToken.user_id)
+                .execution_options(synchronize_session=False)
+            )
+            deactivated_users.update(row[0] for row in result.all())
+
+        if self.scored:
+            # Bump the score and deactivate in the same statement once it hits the limit
+            result = await db.execute(
+                update(DeviceToken)
+                .where(
+                    DeviceToken.device_token.in_(list(self.scored)),
+                    DeviceToken.is_active == True
+                )
+                .values(
+                    failure_score=DeviceToken.failure_score + 1,
+                    is_active=DeviceToken.failure_score + 1 < settings.DEVICE_TOKEN_MAX_FAILURES,
+                )
+                .returning(DeviceToken.user_id, DeviceToken.is_active)
+                .execution_options(synchronize_session=False)
+            )
+            deactivated_users.update(user_id for user_id, is_active in result.all() if not is_active)
+
+        await db.commit()
+
+        if deactivated_users:
+            logger.info(
+                f"Deactivated tokens for {len(deactivated_users)} user(s) "
+                f"({len(self.permanent)} permanent failure(s), {len(self.scored)} scored)"
+            )
+            await invalidate_token_index(deactivated_users)
+
+        self.delivered.clear()
+        self.permanent.clear()
+        self.scored.clear()
+
+
+async def prune_stale_tokens(db: AsyncSession, stale_days: Optional[int] = None) -> int:
+    """Delete tokens unused for stale_days, in batches. Returns rows deleted."""
+    stale_days = stale_days or settings.DEVICE_TOKEN_STALE_DAYS
+    cutoff = datetime.now(timezone.utc) - timedelta(days=stale_days)
+
+    total = 0
+    while True:
+        result = await db.execute(text("""
+            DELETE FROM device_tokens
+            WHERE id IN (
+                SELECT id FROM device_tokens
+                WHERE COALESCE(last_used_at, updated_at, created_at) < :cutoff
+                LIMIT :batch_size
+            )
+            RETURNING user_id
+        """), {"cutoff": cutoff, "batch_size": PRUNE_BATCH_SIZE})
+        user_ids = [row[0] for row in result.all()]
+        await db.commit()
+
+        if not user_ids:
+            break
+        total += len(user_ids)
+        await invalidate_token_index(user_ids)
+
+        if len(user_ids) < PRUNE_BATCH_SIZE:
+            break
+        await asyncio.sleep(0)  # Let request handlers in between batches
+
+    return total
+
+
+# Background task handle for token pruning
+_prune_task: Optional[asyncio.Task] = None
+
+
+async def start_token_prune_loop():
+    """Start background loop that prunes stale device tokens"""
+    global _prune_task
+    if _prune_task is not None:
+        return
+    _prune_task = asyncio.create_task(_token_prune_loop())
+    logger.info("Started device token prune loop")
+
+
+async def stop_token_prune_loop():
+    """Stop the token prune background loop"""
+    global _prune_task
+    if _prune_task is not None:
+        _prune_task.cancel()
+        _prune_task = None
+        logger.info("Stopped device token prune loop")
+
+
+async def _token_prune_loop():
+    """Prune stale tokens every PRUNE_INTERVAL_SECONDS; one worker per interval via a Redis lock"""
+    from db.database import get_session_maker
+    from services.redis import get_redis
+
+    while True:
+        try:
+            await asyncio.sleep(PRUNE_INTERVAL_SECONDS)
+
+            r = await get_redis()
+            if not await r.set(PRUNE_LOCK_KEY, "1", nx=True, ex=PRUNE_INTERVAL_SECONDS - 60):
+                continue
+
+            session_maker = get_session_maker()
+            async with session_maker() as db:
+                pruned = await prune_stale_tokens(db)
+
+            if pruned:
+                logger.info(f"Pruned {pruned} device token(s) unused for {settings.DEVICE_TOKEN_STALE_DAYS}+ days")
+
+        except asyncio.CancelledError:
+            break
+        except Exception as e:
+            logger.error(f"Token prune loop error: {e}")
+            await asyncio.sleep(60)
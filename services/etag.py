@@ -0,0 +1,158 @@
+"""
+Weak ETags for polled JSON endpoints, derived from version counters.
+
+Each cacheable resource has a counter in Redis (version:{scope}) that writers
+bump after committing. A read endpoint hashes the counters it depends on, the
+request parameters and the caller into a weak ETag, and answers a matching
+If-None-Match with 304 before running its query.
+
+Scopes:
+- bounces: any bounce, invite or attendee change (/bounces/map, /bounces/public)
+- checkins: any venue check-in or checkout (/checkins/area)
+- bounce:{id}: fields or status of that bounce (share page HTML cache, services/share_page.py)
+- user:{id}: profile fields, follow edges and can_post of that user (/users/{id}/profile)
+- close_friend_locations:{id}: location, check-in or sharing changes of anyone
+  sharing their location with that user (/users/close-friends/locations)
+
+Endpoints that issue ETags read from the primary, not the replica: the
+counters are bumped right after the primary commits, so a lagging replica
+would pair a new ETag with an old body and keep it 304-fresh until the next
+bump. Location parameters are rounded to ETAG_COORD_DECIMALS (round_coordinates)
+before the endpoint queries with them, so GPS jitter between polls still
+matches.
+
+Every ETag also includes a time bucket, so data that changes without a bump
+(a bounce time passing, a creator renaming themselves) and any bump lost while
+Redis was down are picked up within that bucket. Without Redis no ETag is
+issued and every request gets a full response.
+"""
+import hashlib
+import logging
+import time
+from typing import Iterable, List, Optional, Tuple
+
+from fastapi import Request, Response
+from sqlalchemy import select
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from db.models import Follow
+
+logger = logging.getLogger(__name__)
+
+VERSION_KEY_PREFIX = "version:"
+VERSION_TTL = 7 * 24 * 3600  # Counters idle this long are dropped; a reset only forces one full response
+
+BOUNCES_SCOPE = "bounces"
+CHECKINS_SCOPE = "checkins"
+
+ETAG_TIME_BUCKET_SECONDS = 300
+ETAG_COORD_DECIMALS = 3  # ~110 m
+
+
+def bounce_scope(bounce_id: int) -> str:
+    return f"bounce:{bounce_id}"
+
+
+def user_scope(user_id: int) -> str:
+    return f"user:{user_id}"
+
+
+def close_friend_locations_scope(viewer_id: int) -> str:
+    return f"close_friend_locations:{viewer_id}"
+
+
+async def bump_versions(*scopes: str) -> None:
+    """Bump version counters - call after committing a write that changes these resources"""
+    from services.redis import get_redis, redis_available
+
+    scopes = list(dict.fromkeys(scopes))
+    if not scopes or not redis_available():
+        return
+    try:
+        r = await get_redis()
+        pipe = r.pipeline(transaction=False)
+        for scope in scopes:
+            pipe.incr(f"{VERSION_KEY_PREFIX}{scope}")
+            pipe.expire(f"{VERSION_KEY_PREFIX}{scope}", VERSION_TTL)
+        await pipe.execute()
+    except Exception as e:
+        logger.warning(f"Version bump failed for {scopes}: {e}")
+
+
+async def bump_close_friend_viewers(db: AsyncSession, user_ids: Iterable[int]) -> None:
+    """Bump close-friend location versions of everyone these users share their location with"""
+    from services.follow_graph import location_viewers
+
+    user_ids = list(set(user_ids))
+    if not user_ids:
+        return
+    viewer_ids = await location_viewers(user_ids)
+    if viewer_ids is None:
+        result = await db.execute(
+            select(Follow.following_id).where(
+                Follow.follower_id.in_(user_ids),
+                Follow.close_friend_status == 'accepted',
+                Follow.is_sharing_location == True
+            )
+        )
+        viewer_ids = result.scalars().all()
+    await bump_versions(*(close_friend_locations_scope(viewer_id) for viewer_id in viewer_ids))
+
+
+async def get_versions(*scopes: str) -> Optional[List[int]]:
+    """Current counters for scopes (0 if never bumped), None if Redis is unavailable"""
+    from services.redis import get_redis, redis_available
+
+    if not redis_available():
+        return None
+    try:
+        r = await get_redis()
+        values = await r.mget([f"{VERSION_KEY_PREFIX}{scope}" for scope in scopes])
+    except Exception as e:
+        logger.warning(f"Version read failed for {scopes}: {e}")
+        return None
+    return [int(value) if value else 0 for value in values]
+
+
+def round_coordinates(lat: float, lng: float) -> Tuple[float, float]:
+    """Polled position at the precision ETags and their queries use"""
+    return round(lat, ETAG_COORD_DECIMALS), round(lng, ETAG_COORD_DECIMALS)
+
+
+def make_etag(*parts) -> str:
+    digest = hashlib.sha1("|".join(str(part) for part in parts).encode()).hexdigest()[:20]
+    return f'W/"{digest}"'
+
+
+def etag_matches(if_none_match: Optional[str], etag: str) -> bool:
+    """Weak comparison against an If-None-Match header"""
+    if not if_none_match:
+        return False
+    if if_none_match.strip() == "*":
+        return True
+    opaque = etag.removeprefix("W/")
+    return any(tag.strip().removeprefix("W/") == opaque for tag in if_none_match.split(","))
+
+
+async def not_modified(
+    request: Request,
+    response: Response,
+    scopes: List[str],
+    *parts,
+    bucket_seconds: int = ETAG_TIME_BUCKET_SECONDS
+) -> Optional[Response]:
+    """
+    Set the ETag for this request and return a 304 response if the client already has it.
+    parts are whatever else the body depends on (caller id, query parameters).
+    Returns None when the endpoint should build the full response.
+    """
+    versions = await get_versions(*scopes)
+    if versions is None:
+        return None
+
+    etag = make_etag(*scopes, *versions, *parts, int(time.time() // bucket_seconds))
+    headers = {"ETag": etag, "Cache-Control": "private, no-cache"}
+    if etag_matches(request.headers.get("if-none-match"), etag):
+        return Response(status_code=304, headers=headers)
+    response.headers.update(headers)
+    return None
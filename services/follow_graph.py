@@ -0,0 +1,394 @@
+"""
+Follow graph writes and adjacency sets.
+
+Every insert or delete of a follows row goes through here so the
+denormalized users.followers_count / users.following_count stay in step.
+The counter UPDATEs run in the caller's transaction - callers commit.
+
+scripts/reconcile_follow_counts.py recomputes the counters from follows if
+they ever drift (e.g. after manual SQL).
+
+Hot paths (check-in notifications, close-friend locations, profile flags)
+ask graph questions - "followers of X checked in at P" - as Redis set
+operations instead of joining follows:
+
+- Per user, one set per direction of each relation in RELATIONS
+  (graph:followers:{id}, graph:sharing_to:{id}, ...), and per venue the
+  users checked in there (graph:checkins:{place_id}).
+- Sets are loaded from the primary database on first use (never the
+  replica - a lagging load would pass the version check below and be kept
+  for the whole TTL) and expire after GRAPH_TTL_SECONDS. A loaded set always holds the member "0", so a set
+  that was never loaded or got evicted reads as not loaded, not empty.
+- Writers change follows rows through add_follow / remove_follow /
+  remove_user_follows, or mark_follows_changed for close-friend and sharing
+  updates, and call sync_follow_graph(db) after committing. Check-in moves
+  are applied with sync_checkins. Both bump a per-user / per-venue version
+  that loads check before writing, so a load racing a write is dropped
+  rather than cached stale.
+- Queries return None when Redis is unavailable or a load lost a race -
+  callers keep their SQL as the fallback. Updates that couldn't reach Redis
+  unload the affected sets once it is back.
+
+Raw SQL writes to follows or check_ins (seed scripts) bypass the sets - they
+catch up within GRAPH_TTL_SECONDS, or at once if the graph:* keys are deleted.
+"""
+import logging
+from collections import Counter
+from typing import Callable, Dict, Iterable, List, Optional, Set, Tuple
+
+from redis.exceptions import WatchError
+from sqlalchemy import case, delete, select, update, text, func, or_
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from db.database import get_session_maker
+from db.models import CheckIn, Follow, User
+from services.redis import get_redis, redis_available
+
+logger = logging.getLogger(__name__)
+
+GRAPH_TTL_SECONDS = 6 * 3600
+LOADED = "0"  # Member of every loaded set - user IDs start at 1
+LOAD_CHUNK = 1000  # Members per SADD when loading
+
+# (set of the follower, set of the followed user, whether a follows row is in
+# the relation given its close_friend_status and is_sharing_location)
+RELATIONS: Tuple[Tuple[str, str, Callable[[str, bool], bool]], ...] = (
+    ("following", "followers", lambda status, sharing: True),
+    ("close_friends", "close_friend_of", lambda status, sharing: status == 'accepted'),
+    ("sharing_to", "sharing_from", lambda status, sharing: status == 'accepted' and bool(sharing)),
+)
+USER_SETS = tuple(name for out_name, in_name, _ in RELATIONS for name in (out_name, in_name))
+
+PENDING_KEY = "follow_graph_pending"  # Session.info entry of follows changed since the last sync
+
+
+async def _bump_counts(db: AsyncSession, follower_id: int, following_id: int, delta: int) -> None:
+    # One statement for both rows, so crossing follows (A->B, B->A) can't deadlock
+    await db.execute(
+        update(User)
+        .where(User.id.in_([follower_id, following_id]))
+        .values(
+            following_count=case(
+                (User.id == follower_id, func.greatest(User.following_count + delta, 0)),
+                else_=User.following_count
+            ),
+            followers_count=case(
+                (User.id == following_id, func.greatest(User.followers_count + delta, 0)),
+                else_=User.followers_count
+            ),
+        )
+        .execution_options(synchronize_session=False)
+    )
+
+
+async def add_follow(db: AsyncSession, follower_id: int, following_id: int, **fields) -> Follow:
+    """Insert a follow and bump both users' counters (caller commits)"""
+    follow = Follow(follower_id=follower_id, following_id=following_id, **fields)
+    db.add(follow)
+    await _bump_counts(db, follower_id, following_id, 1)
+    mark_follows_changed(db, follow)
+    return follow
+
+
+async def remove_follow(db: AsyncSession, follow: Follow) -> None:
+    """Delete a follow and drop both users' counters (caller commits)"""
+    await db.delete(follow)
+    await _bump_counts(db, follow.follower_id, follow.following_id, -1)
+    _pending(db)[(follow.follower_id, follow.following_id)] = None
+
+
+async def _decrement_many(db: AsyncSession, column: str, user_ids: List[int]) -> None:
+    """Subtract each user's number of occurrences in user_ids from a counter, in one UPDATE"""
+    counts = Counter(user_ids)
+    if not counts:
+        return
+    await db.execute(text(f"""
+        UPDATE users u
+        SET {column} = GREATEST(u.{column} - d.n, 0)
+        FROM (SELECT unnest(CAST(:ids AS INTEGER[])) AS id, unnest(CAST(:ns AS INTEGER[])) AS n) d
+        WHERE u.id = d.id
+    """), {"ids": list(counts.keys()), "ns": list(counts.values())})
+
+
+async def remove_user_follows(db: AsyncSession, user_id: int) -> int:
+    """
+    Delete every follow to or from user_id (account deletion) and fix the
+    counters of everyone on the other side. Returns follows deleted.
+    """
+    result = await db.execute(
+        delete(Follow)
+        .where(or_(Follow.follower_id == user_id, Follow.following_id == user_id))
+        .returning(Follow.follower_id, Follow.following_id)
+        .execution_options(synchronize_session=False)
+    )
+    rows = result.all()
+
+    # Only the other side matters - the user's own row is about to be deleted
+    lost_follower = [following_id for follower_id, following_id in rows if follower_id == user_id and following_id != user_id]
+    lost_following = [follower_id for follower_id, following_id in rows if following_id == user_id and follower_id != user_id]
+    await _decrement_many(db, "followers_count", lost_follower)
+    await _decrement_many(db, "following_count", lost_following)
+    pending = _pending(db)
+    for follower_id, following_id in rows:
+        pending[(follower_id, following_id)] = None
+    return len(rows)
+
+
+# ============================================================================
+# ADJACENCY SETS
+# ============================================================================
+
+# Sets whose updates couldn't reach Redis - unloaded once it is back
+_stale_users: Set[int] = set()
+_stale_places: Set[str] = set()
+
+
+def _user_key(name: str, user_id) -> str:
+    return f"graph:{name}:{user_id}"
+
+
+def _place_key(place_id: str) -> str:
+    return f"graph:checkins:{place_id}"
+
+
+def _user_version_key(user_id) -> str:
+    return f"graph:version:{user_id}"
+
+
+def _place_version_key(place_id: str) -> str:
+    return f"graph:version:place:{place_id}"
+
+
+def _pending(db: AsyncSession) -> Dict[Tuple[int, int], Optional[Follow]]:
+    return db.info.setdefault(PENDING_KEY, {})
+
+
+def mark_follows_changed(db: AsyncSession, *follows: Optional[Follow]) -> None:
+    """Queue follows rows whose close-friend or sharing state changed for the next sync_follow_graph"""
+    pending = _pending(db)
+    for follow in follows:
+        if follow is not None:
+            pending[(follow.follower_id, follow.following_id)] = follow
+
+
+async def _graph_redis():
+    """Redis client for the graph, None while unavailable. Unloads sets left stale by failed updates first."""
+    if not redis_available():
+        return None
+    redis = await get_redis()
+    if _stale_users or _stale_places:
+        users, places = list(_stale_users), list(_stale_places)
+        pipe = redis.pipeline(transaction=False)
+        for user_id in users:
+            pipe.delete(*(_user_key(name, user_id) for name in USER_SETS))
+            pipe.incr(_user_version_key(user_id))
+        for place_id in places:
+            pipe.delete(_place_key(place_id))
+            pipe.incr(_place_version_key(place_id))
+        await pipe.execute()
+        _stale_users.difference_update(users)
+        _stale_places.difference_update(places)
+    return redis
+
+
+async def sync_follow_graph(db: AsyncSession) -> None:
+    """Apply the follows changed in this session to the adjacency sets. Call after commit."""
+    pending = db.info.pop(PENDING_KEY, None)
+    if not pending:
+        return
+    touched = {user_id for pair in pending for user_id in pair}
+    try:
+        redis = await _graph_redis()
+        if redis is None:
+            _stale_users.update(touched)
+            return
+        pipe = redis.pipeline(transaction=True)
+        for (follower_id, following_id), follow in pending.items():
+            for out_name, in_name, in_relation in RELATIONS:
+                member = follow is not None and in_relation(follow.close_friend_status, follow.is_sharing_location)
+                change = pipe.sadd if member else pipe.srem
+                change(_user_key(out_name, follower_id), following_id)
+                change(_user_key(in_name, following_id), follower_id)
+                pipe.expire(_user_key(out_name, follower_id), GRAPH_TTL_SECONDS)
+                pipe.expire(_user_key(in_name, following_id), GRAPH_TTL_SECONDS)
+        for user_id in touched:
+            pipe.incr(_user_version_key(user_id))
+            pipe.expire(_user_version_key(user_id), GRAPH_TTL_SECONDS)
+        await pipe.execute()
+    except Exception as e:
+        logger.warning(f"Follow graph sync failed for users {sorted(touched)}: {e}")
+        _stale_users.update(touched)
+
+
+async def sync_checkins(
+    joined: Iterable[Tuple[int, str]] = (),
+    left: Iterable[Tuple[int, str]] = ()
+) -> None:
+    """Apply committed check-ins and check-outs, as (user_id, place_id) pairs, to the venue sets"""
+    joined = [(user_id, place_id) for user_id, place_id in joined if place_id]
+    left = [(user_id, place_id) for user_id, place_id in left if place_id]
+    places = {place_id for _, place_id in joined + left}
+    if not places:
+        return
+    try:
+        redis = await _graph_redis()
+        if redis is None:
+            _stale_places.update(places)
+            return
+        pipe = redis.pipeline(transaction=True)
+        for user_id, place_id in left:
+            pipe.srem(_place_key(place_id), user_id)
+        for user_id, place_id in joined:
+            pipe.sadd(_place_key(place_id), user_id)
+        for place_id in places:
+            pipe.expire(_place_key(place_id), GRAPH_TTL_SECONDS)
+            pipe.incr(_place_version_key(place_id))
+            pipe.expire(_place_version_key(place_id), GRAPH_TTL_SECONDS)
+        await pipe.execute()
+    except Exception as e:
+        logger.warning(f"Check-in graph sync failed for places {sorted(places)}: {e}")
+        _stale_places.update(places)
+
+
+async def _store_sets(redis, version_key: str, version: Optional[str], sets: Dict[str, Set[int]]) -> None:
+    """Replace sets with loaded members unless version_key moved since version was read"""
+    try:
+        async with redis.pipeline(transaction=True) as pipe:
+            await pipe.watch(version_key)
+            if await pipe.get(version_key) != version:
+                return
+            pipe.multi()
+            for key, members in sets.items():
+                pipe.delete(key)
+                members = [LOADED] + sorted(members)
+                for start in range(0, len(members), LOAD_CHUNK):
+                    pipe.sadd(key, *members[start:start + LOAD_CHUNK])
+                pipe.expire(key, GRAPH_TTL_SECONDS)
+            await pipe.execute()
+    except WatchError:
+        pass
+
+
+async def _load_user(db: AsyncSession, redis, user_id: int) -> None:
+    version_key = _user_version_key(user_id)
+    version = await redis.get(version_key)
+    result = await db.execute(
+        select(Follow.follower_id, Follow.following_id, Follow.close_friend_status, Follow.is_sharing_location)
+        .where(or_(Follow.follower_id == user_id, Follow.following_id == user_id))
+    )
+    sets = {_user_key(name, user_id): set() for name in USER_SETS}
+    for follower_id, following_id, status, sharing in result.all():
+        for out_name, in_name, in_relation in RELATIONS:
+            if not in_relation(status, sharing):
+                continue
+            if follower_id == user_id:
+                sets[_user_key(out_name, user_id)].add(following_id)
+            if following_id == user_id:
+                sets[_user_key(in_name, user_id)].add(follower_id)
+    await _store_sets(redis, version_key, version, sets)
+
+
+async def _load_place(db: AsyncSession, redis, place_id: str) -> None:
+    version_key = _place_version_key(place_id)
+    version = await redis.get(version_key)
+    result = await db.execute(
+        select(CheckIn.user_id).where(CheckIn.place_id == place_id, CheckIn.is_active == True)
+    )
+    await _store_sets(redis, version_key, version, {_place_key(place_id): set(result.scalars().all())})
+
+
+async def _query(
+    user_ids: Iterable[int],
+    place_ids: Iterable[str],
+    commands: Callable[[object], None]
+) -> Optional[list]:
+    """
+    Run commands on a pipeline once the sets of user_ids and place_ids are
+    loaded, loading missing ones once from the primary. Returns the command
+    results, or None to fall back to SQL.
+    """
+    user_ids, place_ids = list(dict.fromkeys(user_ids)), list(dict.fromkeys(place_ids))
+    try:
+        redis = await _graph_redis()
+        if redis is None:
+            return None
+        for attempt in range(2):
+            pipe = redis.pipeline(transaction=False)
+            for user_id in user_ids:
+                for name in USER_SETS:
+                    pipe.sismember(_user_key(name, user_id), LOADED)
+            for place_id in place_ids:
+                pipe.sismember(_place_key(place_id), LOADED)
+            commands(pipe)
+            results = await pipe.execute()
+
+            checks = len(user_ids) * len(USER_SETS) + len(place_ids)
+            loaded = results[:checks]
+            if all(loaded):
+                return results[checks:]
+            if attempt:
+                return None
+
+            async with get_session_maker()() as db:
+                for i, user_id in enumerate(user_ids):
+                    if not all(loaded[i * len(USER_SETS):(i + 1) * len(USER_SETS)]):
+                        await _load_user(db, redis, user_id)
+                for i, place_id in enumerate(place_ids):
+                    if not loaded[len(user_ids) * len(USER_SETS) + i]:
+                        await _load_place(db, redis, place_id)
+    except Exception as e:
+        logger.warning(f"Follow graph query failed, using SQL: {e}")
+    return None
+
+
+def _ids(members: Iterable[str], exclude: Optional[int] = None) -> List[int]:
+    return [int(member) for member in members if member != LOADED and int(member) != exclude]
+
+
+async def checkin_recipients(user_id: int, place_id: str) -> Optional[Tuple[List[int], List[int]]]:
+    """(followers checked in at place_id, followers who have user_id as an accepted close friend), or None"""
+    results = await _query([user_id], [place_id], lambda pipe: (
+        pipe.sinter(_user_key("followers", user_id), _place_key(place_id)),
+        pipe.smembers(_user_key("close_friend_of", user_id)),
+    ))
+    if results is None:
+        return None
+    at_venue, close_friends = results
+    return _ids(at_venue, exclude=user_id), _ids(close_friends, exclude=user_id)
+
+
+async def followers_at_place(user_id: int, place_id: str) -> Optional[List[int]]:
+    """Followers of user_id checked in at place_id, or None"""
+    results = await _query([user_id], [place_id], lambda pipe: (
+        pipe.sinter(_user_key("followers", user_id), _place_key(place_id)),
+    ))
+    return None if results is None else _ids(results[0], exclude=user_id)
+
+
+async def location_viewers(user_ids: Iterable[int]) -> Optional[List[int]]:
+    """Close friends any of user_ids shares their location with, or None"""
+    user_ids = list(user_ids)
+    if not user_ids:
+        return []
+    results = await _query(user_ids, [], lambda pipe: (
+        pipe.sunion(*(_user_key("sharing_to", user_id) for user_id in user_ids)),
+    ))
+    return None if results is None else _ids(results[0])
+
+
+async def location_sharers(user_id: int) -> Optional[List[int]]:
+    """Close friends sharing their location with user_id, or None"""
+    results = await _query([user_id], [], lambda pipe: (
+        pipe.smembers(_user_key("sharing_from", user_id)),
+    ))
+    return None if results is None else _ids(results[0])
+
+
+async def follow_relation(viewer_id: int, user_id: int) -> Optional[Tuple[bool, bool, bool]]:
+    """(viewer follows user, user follows viewer, user is the viewer's accepted close friend), or None"""
+    results = await _query([viewer_id], [], lambda pipe: (
+        pipe.sismember(_user_key("following", viewer_id), user_id),
+        pipe.sismember(_user_key("followers", viewer_id), user_id),
+        pipe.sismember(_user_key("close_friends", viewer_id), user_id),
+    ))
+    return None if results is None else tuple(bool(result) for result in results)
@@ -1,18 +1,49 @@
 """Geocoding service using Google Maps API"""
 
+import hashlib
+import logging
 import os
-import ssl
-import certifi
+import re
 
-from geopy.exc import GeocoderServiceError, GeocoderTimedOut
-from geopy.geocoders import GoogleV3
+import httpx
+
+from services.cache import cache_get_or_load
+from services.http_clients import GOOGLE, get_http_client
 
 from .models import Address, Coordinates, LocationResult, ReverseGeocodeResult
 
+logger = logging.getLogger(__name__)
+
+GOOGLE_GEOCODE_URL = "https://maps.googleapis.com/maps/api/geocode/json"
+
+# Reverse lookups are cached per coordinate bucket: 4 decimals is ~11 m, so
+# everyone standing around the same venue shares one entry
+REVERSE_BUCKET_DECIMALS = 4
+
+GEOCODE_CACHE_TTL = 30 * 86400  # Addresses and their coordinates practically never change
+GEOCODE_LOCAL_TTL = 3600  # Served from process memory this long before asking Redis again
+
+
+def normalize_address(address: str) -> str:
+    """Case- and whitespace-insensitive form of an address, used as its cache key"""
+    address = address.casefold().replace(",", ", ")
+    address = re.sub(r"\s+", " ", address).strip()
+    return re.sub(r"\s+,", ",", address).strip(" ,")
+
+
+def reverse_bucket(latitude: float, longitude: float) -> str:
+    return f"{latitude:.{REVERSE_BUCKET_DECIMALS}f},{longitude:.{REVERSE_BUCKET_DECIMALS}f}"
+
 
 class GeocodingService:
     """
     Production geocoding service using Google Maps API
+
+    Calls the Geocoding API over the shared Google HTTP client, so lookups
+    never block the event loop. Results go through services.cache: forward
+    lookups keyed by normalized address, reverse lookups by coordinate bucket.
+    Concurrent identical lookups share one Google call, and repeats are
+    answered from process memory for GEOCODE_LOCAL_TTL.
     """
 
     def __init__(
@@ -36,46 +67,49 @@ class GeocodingService:
                 "environment variable or pass google_api_key parameter"
             )
 
-        # Create SSL context with certifi certificates to avoid certificate verification errors
-        ctx = ssl.create_default_context(cafile=certifi.where())
-        self.geocoder = GoogleV3(api_key=api_key, timeout=timeout, ssl_context=ctx)
+        self.api_key = api_key
         self.provider = "google"
 
-    def geocode(self, address: str, exactly_one: bool = True) -> LocationResult | None:
+    async def geocode(self, address: str) -> LocationResult | None:
         """
         Convert address to coordinates (forward geocoding)
 
         Args:
             address: Address string to geocode
-            exactly_one: Return only best match
 
         Returns:
             LocationResult with coordinates and parsed address
         """
-        try:
-            location = self.geocoder.geocode(address, exactly_one=exactly_one, timeout=self.timeout)
+        normalized = normalize_address(address)
+        if not normalized:
+            return None
 
-            if not location:
+        async def load() -> dict | None:
+            raw = await self._request({"address": normalized})
+            if raw is None:
                 return None
-
-            # Parse address components from Google
-            address_obj = self._parse_google_address(location)
-
-            return LocationResult(
-                coordinates=Coordinates(
-                    latitude=location.latitude,
-                    longitude=location.longitude,
-                ),
-                address=address_obj,
-                place_id=getattr(location.raw, "place_id", None),
-                location_type=self._get_location_type(location),
-                provider=self.provider,
-            )
-
-        except (GeocoderTimedOut, GeocoderServiceError):
+            location = raw.get("geometry", {}).get("location", {})
+            return {
+                "coordinates": {"latitude": location["lat"], "longitude": location["lng"]},
+                "address": self._parse_google_address(raw).model_dump(),
+                "place_id": raw.get("place_id"),
+                "location_type": self._get_location_type(raw),
+            }
+
+        key = f"geocode_fwd:{hashlib.sha1(normalized.encode()).hexdigest()}"
+        cached = await self._cached(key, load)
+        if not cached:
             return None
 
-    def reverse_geocode(self, latitude: float, longitude: float) -> ReverseGeocodeResult | None:
+        return LocationResult(
+            coordinates=Coordinates(**cached["coordinates"]),
+            address=Address(**cached["address"]),
+            place_id=cached["place_id"],
+            location_type=cached["location_type"],
+            provider=self.provider,
+        )
+
+    async def reverse_geocode(self, latitude: float, longitude: float) -> ReverseGeocodeResult | None:
         """
         Convert coordinates to address (reverse geocoding)
 
@@ -86,31 +120,55 @@ class GeocodingService:
         Returns:
             ReverseGeocodeResult with address information
         """
-        try:
-            coords = Coordinates(latitude=latitude, longitude=longitude)
-            location = self.geocoder.reverse(
-                f"{coords.latitude}, {coords.longitude}",
-                exactly_one=True,
-                timeout=self.timeout,
-            )
+        coords = Coordinates(latitude=latitude, longitude=longitude)
+        bucket = reverse_bucket(coords.latitude, coords.longitude)
 
-            if not location:
+        async def load() -> dict | None:
+            raw = await self._request({"latlng": bucket})
+            if raw is None:
                 return None
+            return {"address": self._parse_google_address(raw).model_dump()}
+
+        cached = await self._cached(f"geocode_rev:{bucket}", load)
+        if not cached:
+            return None
 
-            address_obj = self._parse_google_address(location)
+        return ReverseGeocodeResult(
+            address=Address(**cached["address"]),
+            coordinates=coords,
+            provider=self.provider,
+        )
+
+    async def _cached(self, key: str, load) -> dict | None:
+        try:
+            return await cache_get_or_load(key, load, ttl=GEOCODE_CACHE_TTL, local_ttl=GEOCODE_LOCAL_TTL)
+        except Exception as e:
+            logger.warning(f"Geocoding lookup failed for {key}: {e}")
+            return None
 
-            return ReverseGeocodeResult(
-                address=address_obj,
-                coordinates=coords,
-                provider=self.provider,
+    async def _request(self, params: dict) -> dict | None:
+        """First Geocoding API result, None if nothing matched or the call failed (not cached)"""
+        try:
+            response = await get_http_client(GOOGLE).get(
+                GOOGLE_GEOCODE_URL,
+                params={**params, "key": self.api_key},
+                timeout=self.timeout,
             )
+            data = response.json()
+        except (httpx.HTTPError, ValueError) as e:
+            logger.warning(f"Geocoding API request failed: {e}")
+            return None
 
-        except (GeocoderTimedOut, GeocoderServiceError):
+        status = data.get("status")
+        if status != "OK":
+            if status != "ZERO_RESULTS":
+                logger.warning(f"Geocoding API error: {status} {data.get('error_message', '')}")
             return None
+        results = data.get("results") or []
+        return results[0] if results else None
 
-    def _parse_google_address(self, location) -> Address:
-        """Parse Google Maps API response into Address model"""
-        raw = location.raw
+    def _parse_google_address(self, raw: dict) -> Address:
+        """Parse a Google Geocoding API result into Address model"""
         components = {}
 
         # Extract address components from Google response
@@ -132,10 +190,10 @@ class GeocodingService:
                     components["country_code"] = component["short_name"]
 
         return Address(
-            formatted_address=raw.get("formatted_address", location.address),
+            formatted_address=raw.get("formatted_address", ""),
             **components,
         )
 
-    def _get_location_type(self, location) -> str | None:
+    def _get_location_type(self, raw: dict) -> str | None:
         """Extract location type/precision indicator from Google"""
-        return location.raw.get("geometry", {}).get("location_type")
+        return raw.get("geometry", {}).get("location_type")
@@ -0,0 +1,165 @@
+"""
+Application-lifetime HTTP clients for outbound integrations.
+
+One pooled httpx.AsyncClient per integration, created in main.lifespan and
+closed on shutdown, so requests reuse keep-alive connections instead of
+paying a TCP + TLS handshake each. Each integration talks to its own hosts,
+so its pool limits act as a per-host concurrency cap, and it has its own
+timeouts.
+
+Every request is timed per client and host, see http_client_stats(). Hosts
+past the first MAX_STATS_HOSTS of a client are counted under "other" - the
+image proxy fetches arbitrary user-supplied URLs.
+
+APNs keeps its own HTTP/2 client in services/apns_service.py - it needs a
+provider-token connection of its own.
+"""
+import logging
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict
+
+import httpx
+
+logger = logging.getLogger(__name__)
+
+GOOGLE = "google"  # maps.googleapis.com / places.googleapis.com
+APPLE = "apple"  # appleid.apple.com
+GROQ = "groq"  # AI commentator
+SOCIAL = "social"  # Instagram / LinkedIn profile lookups
+IMAGES = "images"  # Share page image proxy
+
+
+@dataclass
+class ClientConfig:
+    timeout: float  # Seconds per read/write/pool wait
+    connect_timeout: float
+    max_connections: int  # Concurrent requests; more wait for a free connection
+    max_keepalive: int
+    http2: bool = False
+    follow_redirects: bool = False
+    headers: Dict[str, str] = field(default_factory=dict)
+
+
+CLIENT_CONFIGS: Dict[str, ClientConfig] = {
+    # Autocomplete fans out two searches plus a details call per prediction
+    GOOGLE: ClientConfig(timeout=10.0, connect_timeout=3.0, max_connections=100, max_keepalive=20, http2=True),
+    APPLE: ClientConfig(timeout=10.0, connect_timeout=3.0, max_connections=20, max_keepalive=5),
+    GROQ: ClientConfig(timeout=10.0, connect_timeout=3.0, max_connections=20, max_keepalive=5),
+    SOCIAL: ClientConfig(timeout=10.0, connect_timeout=3.0, max_connections=10, max_keepalive=5),
+    IMAGES: ClientConfig(
+        timeout=10.0, connect_timeout=5.0, max_connections=50, max_keepalive=20,
+        follow_redirects=True, headers={"User-Agent": "BounceImageProxy/1.0"}
+    ),
+}
+
+
+@dataclass
+class HostStats:
+    requests: int = 0
+    errors: int = 0  # Transport errors and timeouts
+    status_5xx: int = 0
+    in_flight: int = 0
+    total_seconds: float = 0.0  # Until response headers
+    max_seconds: float = 0.0
+
+
+MAX_STATS_HOSTS = 20  # Per client
+OTHER_HOSTS = "other"
+
+# client name -> host -> stats
+_stats: Dict[str, Dict[str, HostStats]] = {}
+
+_clients: Dict[str, httpx.AsyncClient] = {}
+
+
+class _MeteredTransport(httpx.AsyncHTTPTransport):
+    """Connection pool that times each request per host"""
+
+    def __init__(self, name: str, **kwargs):
+        super().__init__(**kwargs)
+        self._name = name
+
+    async def handle_async_request(self, request: httpx.Request) -> httpx.Response:
+        hosts = _stats.setdefault(self._name, {})
+        host = request.url.host
+        if host not in hosts and len(hosts) >= MAX_STATS_HOSTS:
+            host = OTHER_HOSTS
+        stats = hosts.get(host)
+        if stats is None:
+            stats = hosts[host] = HostStats()
+
+        stats.requests += 1
+        stats.in_flight += 1
+        start = time.perf_counter()
+        try:
+            response = await super().handle_async_request(request)
+        except Exception:
+            stats.errors += 1
+            raise
+        finally:
+            elapsed = time.perf_counter() - start
+            stats.in_flight -= 1
+            stats.total_seconds += elapsed
+            stats.max_seconds = max(stats.max_seconds, elapsed)
+
+        if response.status_code >= 500:
+            stats.status_5xx += 1
+        return response
+
+
+def _create_client(name: str) -> httpx.AsyncClient:
+    config = CLIENT_CONFIGS[name]
+    limits = httpx.Limits(
+        max_connections=config.max_connections,
+        max_keepalive_connections=config.max_keepalive,
+    )
+    return httpx.AsyncClient(
+        transport=_MeteredTransport(name, http2=config.http2, limits=limits),
+        timeout=httpx.Timeout(config.timeout, connect=config.connect_timeout),
+        follow_redirects=config.follow_redirects,
+        headers=config.headers,
+    )
+
+
+def get_http_client(name: str) -> httpx.AsyncClient:
+    """Shared client for an integration (created on first use outside the app, e.g. scripts)"""
+    client = _clients.get(name)
+    if client is None or client.is_closed:
+        client = _clients[name] = _create_client(name)
+    return client
+
+
+async def start_http_clients() -> None:
+    """Create every configured client (called from main.lifespan)"""
+    for name in CLIENT_CONFIGS:
+        get_http_client(name)
+    logger.info(f"Started HTTP clients: {', '.join(CLIENT_CONFIGS)}")
+
+
+async def close_http_clients() -> None:
+    """Close every client and its connections (called on shutdown and by scripts)"""
+    clients = list(_clients.values())
+    _clients.clear()
+    for client in clients:
+        try:
+            await client.aclose()
+        except Exception as e:
+            logger.warning(f"Error closing HTTP client: {e}")
+
+
+def http_client_stats() -> Dict[str, Dict[str, Dict[str, Any]]]:
+    """Per-client, per-host request counters and latencies for this process"""
+    report: Dict[str, Dict[str, Dict[str, Any]]] = {}
+    for name, hosts in sorted(_stats.items()):
+        report[name] = {}
+        for host, stats in sorted(hosts.items()):
+            report[name][host] = {
+                "requests": stats.requests,
+                "errors": stats.errors,
+                "status_5xx": stats.status_5xx,
+                "in_flight": stats.in_flight,
+                "avg_ms": round(stats.total_seconds / stats.requests * 1000, 2) if stats.requests else None,
+                "max_ms": round(stats.max_seconds * 1000, 2),
+            }
+    return report
@@ -0,0 +1,307 @@
+"""
+Caching proxy for external images shown on share pages (e.g. Instagram CDN avatars).
+
+- Upstream fetches use the shared IMAGES client (services/http_clients.py).
+- Concurrent requests for the same URL share one upstream fetch.
+- Upstream bodies are streamed to disk in chunks, never held in memory, and
+  responses are streamed back from the file.
+- Files live under IMAGE_PROXY_CACHE_DIR as {sha256(url)}.img with a
+  {sha256(url)}.json sidecar (content type, size, expiry). Their lifetime
+  follows the upstream Cache-Control (no-store / private are not kept,
+  max-age / s-maxage / Expires set the expiry, DEFAULT_TTL otherwise, at most
+  MAX_TTL). The directory is trimmed least recently used first to
+  IMAGE_PROXY_CACHE_MAX_BYTES; a hit refreshes the file's mtime.
+
+Workers share the directory. Each tracks usage in memory and rescans the
+directory every RESCAN_INTERVAL_SECONDS, so the size bound is approximate
+between rescans.
+"""
+import asyncio
+import email.utils
+import hashlib
+import json
+import logging
+import os
+import time
+from dataclasses import dataclass
+from pathlib import Path
+from typing import AsyncIterator, BinaryIO, Dict, Optional, Tuple
+
+import httpx
+
+from core.config import settings
+from services.http_clients import IMAGES, get_http_client
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_TTL = 86400  # Upstream sent no freshness information
+MAX_TTL = 7 * 86400
+MAX_IMAGE_BYTES = 10 * 1024 * 1024
+CHUNK_SIZE = 64 * 1024
+RESCAN_INTERVAL_SECONDS = 300
+UNCACHEABLE_GRACE_SECONDS = 30  # no-store bodies are deleted once waiting requests have opened them
+
+
+class ImageProxyError(Exception):
+    """Upstream fetch failed; status_code is what the proxy should answer"""
+
+    def __init__(self, status_code: int, detail: str):
+        super().__init__(detail)
+        self.status_code = status_code
+        self.detail = detail
+
+
+@dataclass
+class CachedImage:
+    path: Path
+    content_type: str
+    size: int
+    expires_at: float  # Unix time; <= now for bodies that must not be reused
+
+    @property
+    def max_age(self) -> int:
+        return max(0, int(self.expires_at - time.time()))
+
+
+# url hash -> running fetch, shared by every concurrent miss
+_inflight: Dict[str, asyncio.Task] = {}
+
+# url hash -> (size, last used), this worker's view of the cache directory
+_index: Dict[str, Tuple[int, float]] = {}
+_index_bytes = 0
+_last_scan = 0.0
+
+
+def _cache_dir() -> Path:
+    return Path(settings.IMAGE_PROXY_CACHE_DIR)
+
+
+def _paths(url_hash: str) -> Tuple[Path, Path]:
+    base = _cache_dir() / url_hash[:2]
+    return base / f"{url_hash}.img", base / f"{url_hash}.json"
+
+
+def cache_ttl(cache_control: Optional[str], expires: Optional[str]) -> Optional[int]:
+    """Seconds a shared cache may keep the response, None if it must not be stored"""
+    directives = {}
+    for part in (cache_control or "").lower().split(","):
+        name, _, value = part.strip().partition("=")
+        if name:
+            directives[name] = value.strip('"')
+
+    if "no-store" in directives or "private" in directives:
+        return None
+    if "no-cache" in directives:
+        return 0
+    for name in ("s-maxage", "max-age"):
+        if name in directives:
+            try:
+                return min(max(int(directives[name]), 0), MAX_TTL)
+            except ValueError:
+                return 0
+    if expires:
+        try:
+            expires_at = email.utils.parsedate_to_datetime(expires).timestamp()
+        except (TypeError, ValueError):
+            return 0
+        return min(max(int(expires_at - time.time()), 0), MAX_TTL)
+    return DEFAULT_TTL
+
+
+# ---------------------------------------------------------------------------
+# Disk LRU
+# ---------------------------------------------------------------------------
+
+def _scan_sync() -> Dict[str, Tuple[int, float]]:
+    index = {}
+    root = _cache_dir()
+    if not root.exists():
+        return index
+    for shard in os.scandir(root):
+        if not shard.is_dir():
+            continue
+        for entry in os.scandir(shard.path):
+            if entry.name.endswith(".img"):
+                try:
+                    stat = entry.stat()
+                except FileNotFoundError:
+                    continue
+                index[entry.name[:-4]] = (stat.st_size, stat.st_mtime)
+    return index
+
+
+async def _refresh_index(force: bool = False) -> None:
+    global _index, _index_bytes, _last_scan
+    if not force and time.time() - _last_scan < RESCAN_INTERVAL_SECONDS:
+        return
+    _last_scan = time.time()
+    _index = await asyncio.to_thread(_scan_sync)
+    _index_bytes = sum(size for size, _ in _index.values())
+
+
+def _remove_files(url_hash: str) -> None:
+    for path in _paths(url_hash):
+        try:
+            path.unlink()
+        except FileNotFoundError:
+            pass
+
+
+async def _evict() -> None:
+    """Delete least recently used files until the directory fits the budget"""
+    global _index_bytes
+    if _index_bytes <= settings.IMAGE_PROXY_CACHE_MAX_BYTES:
+        return
+    await _refresh_index(force=True)
+    victims = []
+    for url_hash, (size, _) in sorted(_index.items(), key=lambda item: item[1][1]):
+        if _index_bytes <= settings.IMAGE_PROXY_CACHE_MAX_BYTES:
+            break
+        victims.append(url_hash)
+        del _index[url_hash]
+        _index_bytes -= size
+    for url_hash in victims:
+        await asyncio.to_thread(_remove_files, url_hash)
+    if victims:
+        logger.info(f"Image proxy cache evicted {len(victims)} file(s)")
+
+
+def _read_cached_sync(url_hash: str) -> Optional[CachedImage]:
+    body_path, meta_path = _paths(url_hash)
+    try:
+        meta = json.loads(meta_path.read_text())
+        os.utime(body_path)  # LRU touch
+    except (FileNotFoundError, ValueError):
+        return None
+    if meta["expires_at"] <= time.time():
+        return None
+    return CachedImage(body_path, meta["content_type"], meta["size"], meta["expires_at"])
+
+
+async def _read_cached(url_hash: str) -> Optional[CachedImage]:
+    image = await asyncio.to_thread(_read_cached_sync, url_hash)
+    if image is not None:
+        _index[url_hash] = (image.size, time.time())
+    return image
+
+
+# ---------------------------------------------------------------------------
+# Upstream fetch
+# ---------------------------------------------------------------------------
+
+def _write_meta_sync(meta_path: Path, meta: dict) -> None:
+    tmp_path = meta_path.with_suffix(f".{os.getpid()}.tmp")
+    tmp_path.write_text(json.dumps(meta))
+    os.replace(tmp_path, meta_path)
+
+
+async def _fetch(url: str, url_hash: str) -> CachedImage:
+    """Stream url into the cache directory and return the stored file"""
+    global _index_bytes
+    body_path, meta_path = _paths(url_hash)
+    await asyncio.to_thread(body_path.parent.mkdir, parents=True, exist_ok=True)
+    tmp_path = body_path.with_suffix(f".{os.getpid()}.{id(asyncio.current_task())}.tmp")
+
+    client = get_http_client(IMAGES)
+    try:
+        async with client.stream("GET", url) as resp:
+            if resp.status_code != 200:
+                raise ImageProxyError(502, "Upstream error")
+            length = int(resp.headers.get("content-length") or 0)
+            if length > MAX_IMAGE_BYTES:
+                raise ImageProxyError(502, "Image too large")
+
+            size = 0
+            with open(tmp_path, "wb") as f:
+                async for chunk in resp.aiter_bytes(CHUNK_SIZE):
+                    size += len(chunk)
+                    if size > MAX_IMAGE_BYTES:
+                        raise ImageProxyError(502, "Image too large")
+                    await asyncio.to_thread(f.write, chunk)
+
+            content_type = resp.headers.get("content-type", "image/jpeg")
+            ttl = cache_ttl(resp.headers.get("cache-control"), resp.headers.get("expires"))
+    except httpx.TimeoutException:
+        await asyncio.to_thread(_unlink_quietly, tmp_path)
+        raise ImageProxyError(504, "Upstream timeout")
+    except ImageProxyError:
+        await asyncio.to_thread(_unlink_quietly, tmp_path)
+        raise
+    except Exception as e:
+        await asyncio.to_thread(_unlink_quietly, tmp_path)
+        logger.warning(f"Image proxy fetch failed for {url}: {e}")
+        raise ImageProxyError(502, "Failed to fetch image")
+
+    if ttl is None:
+        # Serve this body to the requests waiting on it, then drop it
+        asyncio.get_running_loop().call_later(UNCACHEABLE_GRACE_SECONDS, _unlink_quietly, tmp_path)
+        return CachedImage(tmp_path, content_type, size, time.time())
+
+    expires_at = time.time() + ttl
+    await asyncio.to_thread(os.replace, tmp_path, body_path)
+    await asyncio.to_thread(_write_meta_sync, meta_path, {
+        "url": url,
+        "content_type": content_type,
+        "size": size,
+        "expires_at": expires_at,
+    })
+
+    previous_size, _ = _index.get(url_hash, (0, 0.0))
+    _index[url_hash] = (size, time.time())
+    _index_bytes += size - previous_size
+    await _evict()
+    return CachedImage(body_path, content_type, size, expires_at)
+
+
+def _unlink_quietly(path: Path) -> None:
+    try:
+        path.unlink()
+    except FileNotFoundError:
+        pass
+
+
+def _finish_fetch(url_hash: str, task: asyncio.Task) -> None:
+    if _inflight.get(url_hash) is task:
+        del _inflight[url_hash]
+    # Retrieve the exception so fetches nobody awaits anymore don't warn as unhandled
+    if not task.cancelled():
+        task.exception()
+
+
+async def get_image(url: str) -> Tuple[CachedImage, BinaryIO]:
+    """
+    Cached image for url, fetching it on a miss. Returns the entry and an open
+    file positioned at the start of the body - stream it with iter_file.
+    Raises ImageProxyError if the upstream fetch fails.
+    """
+    url_hash = hashlib.sha256(url.encode()).hexdigest()
+    await _refresh_index()
+
+    image = await _read_cached(url_hash)
+    if image is None:
+        task = _inflight.get(url_hash)
+        if task is None:
+            # Own task, so one client disconnecting doesn't abort the fetch for the rest
+            task = asyncio.create_task(_fetch(url, url_hash))
+            _inflight[url_hash] = task
+            task.add_done_callback(lambda t: _finish_fetch(url_hash, t))
+        image = await asyncio.shield(task)
+
+    try:
+        f = await asyncio.to_thread(open, image.path, "rb")
+    except FileNotFoundError:
+        # Evicted or replaced between lookup and open
+        raise ImageProxyError(502, "Failed to fetch image")
+    return image, f
+
+
+async def iter_file(f: BinaryIO) -> AsyncIterator[bytes]:
+    """Stream an open file in chunks, closing it when done"""
+    try:
+        while True:
+            chunk = await asyncio.to_thread(f.read, CHUNK_SIZE)
+            if not chunk:
+                break
+            yield chunk
+    finally:
+        f.close()
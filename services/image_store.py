@@ -0,0 +1,124 @@
+"""
+Content-addressed image store on the local filesystem.
+
+Uploaded images are decoded once, re-encoded into a "full" and a "thumb" JPEG
+variant and written under UPLOAD_DIR/images/{hash[:2]}/{hash}_{variant}.jpg,
+where hash is the SHA-256 of the original upload. The files are served by the
+/files static mount, so the database only stores the short /files/... URL of
+the full variant; the thumbnail URL is derived from it.
+
+Identical uploads map to the same files, so blobs are never deleted when a
+user clears a slot - another user may reference the same hash.
+"""
+import asyncio
+import hashlib
+import io
+import logging
+import os
+import uuid
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Optional
+
+from PIL import Image, ImageOps
+
+from core.config import settings
+
+logger = logging.getLogger(__name__)
+
+IMAGES_SUBDIR = "images"
+FILES_URL_PREFIX = "/files"
+
+FULL_MAX_SIZE = 1080  # px, longest edge
+THUMB_MAX_SIZE = 256  # px, longest edge
+JPEG_QUALITY = 85
+
+# Decompression bomb limit. Pillow itself only warns between this and twice
+# it, so _store_image_sync checks the header size before decoding.
+Image.MAX_IMAGE_PIXELS = 40_000_000
+
+
+class InvalidImageError(ValueError):
+    """Upload could not be decoded as an image"""
+
+
+@dataclass
+class StoredImage:
+    content_hash: str
+    url: str  # Full variant
+    thumbnail_url: str
+
+
+def _relative_path(content_hash: str, variant: str) -> str:
+    return f"{IMAGES_SUBDIR}/{content_hash[:2]}/{content_hash}_{variant}.jpg"
+
+
+def _url_for(content_hash: str, variant: str) -> str:
+    return f"{FILES_URL_PREFIX}/{_relative_path(content_hash, variant)}"
+
+
+def thumbnail_url(url: Optional[str]) -> Optional[str]:
+    """Thumbnail URL for a stored image URL; other URLs are returned unchanged"""
+    if url and url.startswith(f"{FILES_URL_PREFIX}/{IMAGES_SUBDIR}/") and url.endswith("_full.jpg"):
+        return url[:-len("_full.jpg")] + "_thumb.jpg"
+    return url
+
+
+def _render_variant(image: Image.Image, max_size: int) -> bytes:
+    variant = image.copy()
+    variant.thumbnail((max_size, max_size), Image.LANCZOS)
+    buffer = io.BytesIO()
+    variant.save(buffer, format="JPEG", quality=JPEG_QUALITY, optimize=True, progressive=True)
+    return buffer.getvalue()
+
+
+def _write_atomic(path: Path, data: bytes) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    # Unique per call - identical uploads in one process write the same path concurrently
+    tmp_path = path.with_suffix(f".{uuid.uuid4().hex}.tmp")
+    tmp_path.write_bytes(data)
+    os.replace(tmp_path, path)
+
+
+def _store_image_sync(content: bytes) -> StoredImage:
+    content_hash = hashlib.sha256(content).hexdigest()
+    root = Path(settings.UPLOAD_DIR)
+    full_path = root / _relative_path(content_hash, "full")
+    thumb_path = root / _relative_path(content_hash, "thumb")
+
+    if not (full_path.exists() and thumb_path.exists()):
+        try:
+            image = Image.open(io.BytesIO(content))
+        except Exception as e:
+            raise InvalidImageError(f"Unreadable image: {e}") from e
+        if image.width * image.height > Image.MAX_IMAGE_PIXELS:
+            raise InvalidImageError(f"Image too large: {image.width}x{image.height}")
+        try:
+            image.load()
+        except Exception as e:
+            raise InvalidImageError(f"Unreadable image: {e}") from e
+
+        # Respect camera orientation, flatten alpha onto white for JPEG
+        image = ImageOps.exif_transpose(image)
+        if image.mode in ("RGBA", "LA", "P"):
+            image = image.convert("RGBA")
+            background = Image.new("RGB", image.size, (255, 255, 255))
+            background.paste(image, mask=image.split()[-1])
+            image = background
+        elif image.mode != "RGB":
+            image = image.convert("RGB")
+
+        _write_atomic(full_path, _render_variant(image, FULL_MAX_SIZE))
+        _write_atomic(thumb_path, _render_variant(image, THUMB_MAX_SIZE))
+
+    return StoredImage(
+        content_hash=content_hash,
+        url=_url_for(content_hash, "full"),
+        thumbnail_url=_url_for(content_hash, "thumb"),
+    )
+
+
+async def store_image(content: bytes) -> StoredImage:
+    """Resize and store an image, returning its URLs. Raises InvalidImageError."""
+    # Decoding/resizing is CPU-bound - keep it off the event loop
+    return await asyncio.to_thread(_store_image_sync, content)
@@ -5,7 +5,7 @@ import logging
 from dataclasses import dataclass
 from typing import Optional
 
-import httpx
+from services.http_clients import SOCIAL, get_http_client
 
 logger = logging.getLogger(__name__)
 
@@ -45,60 +45,60 @@ async def fetch_instagram_profile(handle: str) -> InstagramProfile:
     full_name = None
 
     try:
-        async with httpx.AsyncClient() as client:
-            # Method 1: Try the web profile info endpoint
+        client = get_http_client(SOCIAL)
+        # Method 1: Try the web profile info endpoint
+        response = await client.get(
+            f"https://www.instagram.com/api/v1/users/web_profile_info/?username={handle}",
+            headers=INSTAGRAM_HEADERS,
+            timeout=10.0
+        )
+
+        if response.status_code == 200:
+            try:
+                data = response.json()
+                user_data = data.get("data", {}).get("user", {})
+                profile_pic_url = user_data.get("profile_pic_url_hd") or user_data.get("profile_pic_url")
+                full_name = user_data.get("full_name")
+            except Exception:
+                pass
+
+        # Method 2: Fallback to scraping profile page
+        if not profile_pic_url:
             response = await client.get(
-                f"https://www.instagram.com/api/v1/users/web_profile_info/?username={handle}",
-                headers=INSTAGRAM_HEADERS,
+                f"https://www.instagram.com/{handle}/",
+                headers={
+                    "User-Agent": INSTAGRAM_HEADERS["User-Agent"],
+                    "Accept": "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+                    "Accept-Language": "en-US,en;q=0.9",
+                    "Cookie": "ig_cb=1",
+                },
+                follow_redirects=False,
                 timeout=10.0
             )
 
             if response.status_code == 200:
-                try:
-                    data = response.json()
-                    user_data = data.get("data", {}).get("user", {})
-                    profile_pic_url = user_data.get("profile_pic_url_hd") or user_data.get("profile_pic_url")
-                    full_name = user_data.get("full_name")
-                except Exception:
-                    pass
-
-            # Method 2: Fallback to scraping profile page
-            if not profile_pic_url:
-                response = await client.get(
-                    f"https://www.instagram.com/{handle}/",
-                    headers={
-                        "User-Agent": INSTAGRAM_HEADERS["User-Agent"],
-                        "Accept": "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
-                        "Accept-Language": "en-US,en;q=0.9",
-                        "Cookie": "ig_cb=1",
-                    },
-                    follow_redirects=False,
-                    timeout=10.0
-                )
-
-                if response.status_code == 200:
-                    html = response.text
-
-                    # Try to find profile_pic_url_hd in JSON data
-                    match = re.search(r'"profile_pic_url_hd":"([^"]+)"', html)
+                html = response.text
+
+                # Try to find profile_pic_url_hd in JSON data
+                match = re.search(r'"profile_pic_url_hd":"([^"]+)"', html)
+                if match:
+                    profile_pic_url = match.group(1).replace("\\u0026", "&").replace("\\/", "/")
+                else:
+                    # Try profile_pic_url
+                    match = re.search(r'"profile_pic_url":"([^"]+)"', html)
                     if match:
                         profile_pic_url = match.group(1).replace("\\u0026", "&").replace("\\/", "/")
                     else:
-                        # Try profile_pic_url
-                        match = re.search(r'"profile_pic_url":"([^"]+)"', html)
+                        # Fallback: og:image meta tag
+                        match = re.search(r'property="og:image"\s+content="([^"]+)"', html)
                         if match:
-                            profile_pic_url = match.group(1).replace("\\u0026", "&").replace("\\/", "/")
-                        else:
-                            # Fallback: og:image meta tag
-                            match = re.search(r'property="og:image"\s+content="([^"]+)"', html)
-                            if match:
-                                profile_pic_url = match.group(1)
-
-                    # Try to get full name
-                    if not full_name:
-                        match = re.search(r'"full_name":"([^"]*)"', html)
-                        if match:
-                            full_name = match.group(1)
+                            profile_pic_url = match.group(1)
+
+                # Try to get full name
+                if not full_name:
+                    match = re.search(r'"full_name":"([^"]*)"', html)
+                    if match:
+                        full_name = match.group(1)
 
     except Exception as e:
         logger.warning(f"Instagram lookup error for {handle}: {e}")
@@ -2,10 +2,13 @@ from .service import PlacesService, get_place_with_photos
 from .autocomplete import (
     index_place,
     increment_bounce_count,
+    increment_checkin_count,
     global_autocomplete_search,
     normalize_name,
     sync_db_place_to_redis,
-    get_indexed_place_count
+    get_indexed_place_count,
+    rebuild_completion_index,
+    ensure_completion_index
 )
 
 __all__ = [
@@ -13,8 +16,11 @@ __all__ = [
     "get_place_with_photos",
     "index_place",
     "increment_bounce_count",
+    "increment_checkin_count",
     "global_autocomplete_search",
     "normalize_name",
     "sync_db_place_to_redis",
-    "get_indexed_place_count"
+    "get_indexed_place_count",
+    "rebuild_completion_index",
+    "ensure_completion_index"
 ]
@@ -4,13 +4,27 @@ Global Places Autocomplete and Nearby Search Service
 Provides location-independent autocomplete against cached places using Redis,
 with prefix matching, popularity scoring, and distance re-ranking.
 
+Popularity is bounce_count * BOUNCE_WEIGHT + checkin_count. For every name
+prefix up to COMPLETION_MAX_PREFIX characters a completion set keeps the
+COMPLETION_TOP_K most popular places, updated by index_place and the
+increment_* functions, so a search reads one small set and re-ranks only
+those by distance. Longer queries use the lexical index, as do prefixes
+whose set holds fewer than the requested results or any query before the
+sets have been built once (places:completions_built, set by
+rebuild_completion_index - startup.py runs it on deploy when missing).
+
 Also provides global geo-index for nearby searches, replacing wasteful
 per-location caching with a single global index.
 
 Redis Data Structures:
 - places:autocomplete:index (sorted set) - prefix search via ZRANGEBYLEX
+- places:complete:{prefix} (sorted set) - top-K place IDs per prefix, scored by popularity
+- places:completions_built (string) - present once the completion sets were fully built
 - places:geo (geo set) - radius search via GEORADIUS
 - places:meta:{place_id} (hash) - shared metadata for both search types
+
+Every change is also published on places:updates so workers can keep
+in-process indexes (services/places/fuzzy.py) in sync.
 """
 
 import json
@@ -20,6 +34,8 @@ import time
 import unicodedata
 from typing import List, Optional, Tuple
 
+from redis.exceptions import WatchError
+
 from services.redis import get_redis
 
 logger = logging.getLogger(__name__)
@@ -28,8 +44,16 @@ logger = logging.getLogger(__name__)
 AUTOCOMPLETE_INDEX = "places:autocomplete:index"
 GEO_INDEX = "places:geo"
 META_PREFIX = "places:meta:"
+COMPLETION_PREFIX = "places:complete:"
+COMPLETION_BUILT_KEY = "places:completions_built"  # Outside COMPLETION_PREFIX, which rebuilds clear
+UPDATES_CHANNEL = "places:updates"  # {"place_id", "meta"} (changed fields) or {"place_id", "removed"}
 META_TTL = 30 * 24 * 3600  # 30 days
 
+COMPLETION_TOP_K = 50  # Places kept per prefix, and re-ranked per search
+COMPLETION_MAX_PREFIX = 12  # Longer queries are selective enough for the lexical index
+BOUNCE_WEIGHT = 3  # A bounce counts as much as this many check-ins
+INDEX_RETRIES = 5  # index_place attempts when a count changes under it
+
 
 def normalize_name(name: str) -> str:
     """
@@ -52,6 +76,27 @@ def normalize_name(name: str) -> str:
     return name.strip()
 
 
+def name_prefixes(normalized: str) -> List[str]:
+    """Completion prefixes of a normalized name (a query never ends in a space)"""
+    return [
+        normalized[:i]
+        for i in range(1, min(len(normalized), COMPLETION_MAX_PREFIX) + 1)
+        if normalized[i - 1] != " "
+    ]
+
+
+def popularity(bounce_count: int, checkin_count: int) -> int:
+    return bounce_count * BOUNCE_WEIGHT + checkin_count
+
+
+def _add_completions(pipe, place_id: str, normalized: str, score: int) -> None:
+    """Queue the place into each of its prefix sets, trimming them back to the top K"""
+    for prefix in name_prefixes(normalized):
+        key = f"{COMPLETION_PREFIX}{prefix}"
+        pipe.zadd(key, {place_id: score})
+        pipe.zremrangebyrank(key, 0, -(COMPLETION_TOP_K + 1))
+
+
 async def index_place(
     place_id: str,
     name: str,
@@ -60,15 +105,22 @@ async def index_place(
     lng: float,
     types: Optional[List[str]] = None,
     bounce_count: int = 0,
-    photo_url: Optional[str] = None
+    photo_url: Optional[str] = None,
+    checkin_count: int = 0
 ) -> bool:
     """
     Add or update a place in all global indexes.
 
     This function atomically updates:
     1. places:autocomplete:index (sorted set for prefix search)
-    2. places:geo (geo set for radius search)
-    3. places:meta:{place_id} (hash with full metadata)
+    2. places:complete:{prefix} (top-K completion sets)
+    3. places:geo (geo set for radius search)
+    4. places:meta:{place_id} (hash with full metadata)
+
+    Counts never go down: Google predictions are re-indexed with
+    bounce_count=0, so the larger of the given and stored counts is kept.
+    The merge runs under WATCH on the metadata hash, so an increment landing
+    between the read and the write retries it instead of being lost.
 
     Returns True on success, False on failure.
     """
@@ -83,36 +135,64 @@ async def index_place(
 
         # Build index entry: "normalized_name:place_id"
         index_entry = f"{normalized}:{place_id}"
-
-        # Use pipeline for atomic operations
-        pipe = redis.pipeline()
-
-        # 1. Add to prefix index (score=0 for lexicographic ordering)
-        pipe.zadd(AUTOCOMPLETE_INDEX, {index_entry: 0})
-
-        # 2. Add to geo index (GEOADD uses lng, lat order)
-        pipe.geoadd(GEO_INDEX, (lng, lat, place_id))
-
-        # 3. Store/update metadata
         meta_key = f"{META_PREFIX}{place_id}"
-        metadata = {
-            "name": name,
-            "address": address or "",
-            "lat": str(lat),
-            "lng": str(lng),
-            "bounce_count": str(bounce_count),
-            "types": json.dumps(types or []),
-            "indexed_at": str(int(time.time()))
-        }
-        if photo_url:
-            metadata["photo_url"] = photo_url
-
-        pipe.hset(meta_key, mapping=metadata)
-        pipe.expire(meta_key, META_TTL)
 
-        await pipe.execute()
-        logger.debug(f"Indexed place {place_id}: {name}")
-        return True
+        for _ in range(INDEX_RETRIES):
+            try:
+                async with redis.pipeline(transaction=True) as pipe:
+                    await pipe.watch(meta_key)
+                    old_name, old_bounce_count, old_checkin_count = await pipe.hmget(
+                        meta_key, "name", "bounce_count", "checkin_count"
+                    )
+                    merged_bounce_count = max(bounce_count, int(old_bounce_count or 0))
+                    merged_checkin_count = max(checkin_count, int(old_checkin_count or 0))
+
+                    pipe.multi()
+
+                    # Renamed: drop the entries only the old name had
+                    old_normalized = normalize_name(old_name) if old_name else normalized
+                    if old_normalized != normalized:
+                        pipe.zrem(AUTOCOMPLETE_INDEX, f"{old_normalized}:{place_id}")
+                        for prefix in set(name_prefixes(old_normalized)) - set(name_prefixes(normalized)):
+                            pipe.zrem(f"{COMPLETION_PREFIX}{prefix}", place_id)
+
+                    # 1. Add to prefix index (score=0 for lexicographic ordering)
+                    pipe.zadd(AUTOCOMPLETE_INDEX, {index_entry: 0})
+
+                    # 2. Add to completion sets
+                    _add_completions(
+                        pipe, place_id, normalized, popularity(merged_bounce_count, merged_checkin_count)
+                    )
+
+                    # 3. Add to geo index (GEOADD uses lng, lat order)
+                    pipe.geoadd(GEO_INDEX, (lng, lat, place_id))
+
+                    # 4. Store/update metadata
+                    metadata = {
+                        "name": name,
+                        "address": address or "",
+                        "lat": str(lat),
+                        "lng": str(lng),
+                        "bounce_count": str(merged_bounce_count),
+                        "checkin_count": str(merged_checkin_count),
+                        "types": json.dumps(types or []),
+                        "indexed_at": str(int(time.time()))
+                    }
+                    if photo_url:
+                        metadata["photo_url"] = photo_url
+
+                    pipe.hset(meta_key, mapping=metadata)
+                    pipe.expire(meta_key, META_TTL)
+                    pipe.publish(UPDATES_CHANNEL, json.dumps({"place_id": place_id, "meta": metadata}))
+
+                    await pipe.execute()
+                logger.debug(f"Indexed place {place_id}: {name}")
+                return True
+            except WatchError:
+                continue
+
+        logger.warning(f"Place {place_id} kept changing while indexing, gave up after {INDEX_RETRIES} tries")
+        return False
 
     except Exception as e:
         logger.error(f"Failed to index place {place_id}: {e}")
@@ -129,8 +209,11 @@ async def remove_place_from_index(place_id: str, normalized_name: str) -> bool:
 
         pipe = redis.pipeline()
         pipe.zrem(AUTOCOMPLETE_INDEX, index_entry)
+        for prefix in name_prefixes(normalized_name):
+            pipe.zrem(f"{COMPLETION_PREFIX}{prefix}", place_id)
         pipe.zrem(GEO_INDEX, place_id)
         pipe.delete(f"{META_PREFIX}{place_id}")
+        pipe.publish(UPDATES_CHANNEL, json.dumps({"place_id": place_id, "removed": True}))
         await pipe.execute()
 
         return True
@@ -139,32 +222,57 @@ async def remove_place_from_index(place_id: str, normalized_name: str) -> bool:
         return False
 
 
-async def increment_bounce_count(place_id: str) -> int:
-    """
-    Atomically increment bounce count for a place.
-    Returns the new count, or -1 on failure.
-    """
+async def _increment_count(place_id: str, field: str) -> int:
+    """Increment a popularity count and re-rank the place in its completion sets"""
     try:
         redis = await get_redis()
         meta_key = f"{META_PREFIX}{place_id}"
 
-        # Check if the place exists in cache
-        if not await redis.exists(meta_key):
+        # Only places already in the cache (their name gives the prefixes)
+        name = await redis.hget(meta_key, "name")
+        if name is None:
             return -1
 
         # Atomic increment + refresh TTL
         pipe = redis.pipeline()
-        pipe.hincrby(meta_key, "bounce_count", 1)
+        pipe.hincrby(meta_key, field, 1)
+        pipe.hmget(meta_key, "bounce_count", "checkin_count")
         pipe.expire(meta_key, META_TTL)
-        results = await pipe.execute()
+        new_count, (bounce_count, checkin_count), _ = await pipe.execute()
+
+        # Absolute scores, so a place trimmed from a prefix earlier re-enters once it ranks
+        pipe = redis.pipeline(transaction=False)
+        score = popularity(int(bounce_count or 0), int(checkin_count or 0))
+        _add_completions(pipe, place_id, normalize_name(name), score)
+        pipe.publish(UPDATES_CHANNEL, json.dumps({
+            "place_id": place_id,
+            "meta": {"bounce_count": bounce_count or "0", "checkin_count": checkin_count or "0"},
+        }))
+        await pipe.execute()
 
-        return results[0]  # New bounce count
+        return new_count
 
     except Exception as e:
-        logger.error(f"Failed to increment bounce count for {place_id}: {e}")
+        logger.error(f"Failed to increment {field} for {place_id}: {e}")
         return -1
 
 
+async def increment_bounce_count(place_id: str) -> int:
+    """
+    Atomically increment bounce count for a place.
+    Returns the new count, or -1 on failure.
+    """
+    return await _increment_count(place_id, "bounce_count")
+
+
+async def increment_checkin_count(place_id: str) -> int:
+    """
+    Atomically increment check-in count for a place.
+    Returns the new count, or -1 on failure.
+    """
+    return await _increment_count(place_id, "checkin_count")
+
+
 async def global_autocomplete_search(
     query: str,
     user_lat: Optional[float] = None,
@@ -174,8 +282,12 @@ async def global_autocomplete_search(
     """
     Search global cache for places matching query prefix.
 
-    Uses ZRANGEBYLEX for O(log N + M) prefix matching.
-    Results are scored by distance (if location provided) + popularity.
+    Queries up to COMPLETION_MAX_PREFIX characters read the top-K most popular
+    matches from their completion set; longer ones use ZRANGEBYLEX for
+    O(log N + M) prefix matching. A completion set with fewer than limit
+    entries, or one read before the sets were first built, is topped up from
+    ZRANGEBYLEX. Only those candidates are scored by distance (if location
+    provided) + popularity.
 
     Returns:
         Tuple of (list of place dicts with PlacePrediction-compatible fields, cache_hit bool)
@@ -188,29 +300,40 @@ async def global_autocomplete_search(
         if not normalized_query:
             return [], False
 
-        # Prefix search: get entries starting with query
-        # "[query" = inclusive lower bound, "[query\xff" = exclusive upper bound
-        min_lex = f"[{normalized_query}"
-        max_lex = f"[{normalized_query}\xff"
-
-        # Fetch more than limit to allow for scoring/filtering
-        raw_entries = await redis.zrangebylex(
-            AUTOCOMPLETE_INDEX,
-            min_lex,
-            max_lex,
-            start=0,
-            num=limit * 5  # Fetch extra for filtering
-        )
-
-        if not raw_entries:
-            return [], False
-
-        # Extract place_ids from entries (format: "normalized_name:place_id")
+        completion_key = None
         place_ids = []
-        for entry in raw_entries:
-            parts = entry.rsplit(":", 1)
-            if len(parts) == 2:
-                place_ids.append(parts[1])
+        complete = False
+        if len(normalized_query) <= COMPLETION_MAX_PREFIX:
+            completion_key = f"{COMPLETION_PREFIX}{normalized_query}"
+            pipe = redis.pipeline(transaction=False)
+            pipe.exists(COMPLETION_BUILT_KEY)
+            pipe.zrevrange(completion_key, 0, COMPLETION_TOP_K - 1)
+            built, place_ids = await pipe.execute()
+            # Before the first build a set only holds places indexed since deploy
+            complete = bool(built) and len(place_ids) >= limit
+
+        if not complete:
+            # Long query, short completion set, or sets not built yet
+            # "[query" = inclusive lower bound, "[query\xff" = exclusive upper bound
+            min_lex = f"[{normalized_query}"
+            max_lex = f"[{normalized_query}\xff"
+
+            # Fetch more than limit to allow for scoring/filtering
+            raw_entries = await redis.zrangebylex(
+                AUTOCOMPLETE_INDEX,
+                min_lex,
+                max_lex,
+                start=0,
+                num=limit * 5  # Fetch extra for filtering
+            )
+
+            # Extract place_ids from entries (format: "normalized_name:place_id")
+            seen = set(place_ids)
+            for entry in raw_entries:
+                parts = entry.rsplit(":", 1)
+                if len(parts) == 2 and parts[1] not in seen:
+                    seen.add(parts[1])
+                    place_ids.append(parts[1])
 
         if not place_ids:
             return [], False
@@ -221,45 +344,17 @@ async def global_autocomplete_search(
             pipe.hgetall(f"{META_PREFIX}{pid}")
         metadata_results = await pipe.execute()
 
-        # Build results with scores
-        results = []
-        for i, meta in enumerate(metadata_results):
-            if not meta:
-                continue
-
-            place_id = place_ids[i]
-            lat = float(meta.get("lat", 0))
-            lng = float(meta.get("lng", 0))
-            bounce_count = int(meta.get("bounce_count", 0))
-
-            # Calculate distance if user location provided
-            distance_meters = None
-            if user_lat is not None and user_lng is not None:
-                distance_meters = haversine_distance_meters(user_lat, user_lng, lat, lng)
+        # Metadata expired: drop the ID so it stops taking a top-K slot
+        expired = [pid for pid, meta in zip(place_ids, metadata_results) if not meta]
+        if expired and completion_key:
+            await redis.zrem(completion_key, *expired)
 
-            # Calculate combined score
-            score = calculate_score(bounce_count, distance_meters)
-
-            # Parse types
-            types_str = meta.get("types", "[]")
-            try:
-                types = json.loads(types_str)
-            except:
-                types = []
-
-            results.append({
-                "place_id": place_id,
-                "name": meta.get("name", ""),
-                "address": meta.get("address", ""),
-                "full_description": f"{meta.get('name', '')} - {meta.get('address', '')}" if meta.get("address") else meta.get("name", ""),
-                "latitude": lat,
-                "longitude": lng,
-                "distance_meters": distance_meters,
-                "bounce_count": bounce_count,
-                "photo_url": meta.get("photo_url"),
-                "types": types,
-                "_score": score  # Internal, for sorting
-            })
+        # Build results with scores
+        results = [
+            place_result(place_ids[i], meta, user_lat, user_lng)
+            for i, meta in enumerate(metadata_results)
+            if meta
+        ]
 
         # Sort by score (higher = better)
         results.sort(key=lambda x: x["_score"], reverse=True)
@@ -275,6 +370,47 @@ async def global_autocomplete_search(
         return [], False
 
 
+def place_result(
+    place_id: str,
+    meta: dict,
+    user_lat: Optional[float] = None,
+    user_lng: Optional[float] = None
+) -> dict:
+    """
+    PlacePrediction-compatible dict for a places:meta hash, with an internal
+    "_score" (distance if location provided + popularity) for sorting.
+    """
+    lat = float(meta.get("lat", 0))
+    lng = float(meta.get("lng", 0))
+    bounce_count = int(meta.get("bounce_count", 0))
+    checkin_count = int(meta.get("checkin_count", 0))
+
+    # Calculate distance if user location provided
+    distance_meters = None
+    if user_lat is not None and user_lng is not None:
+        distance_meters = haversine_distance_meters(user_lat, user_lng, lat, lng)
+
+    # Parse types
+    types_str = meta.get("types", "[]")
+    try:
+        types = json.loads(types_str)
+    except:
+        types = []
+
+    return {
+        "place_id": place_id,
+        "name": meta.get("name", ""),
+        "address": meta.get("address", ""),
+        "full_description": f"{meta.get('name', '')} - {meta.get('address', '')}" if meta.get("address") else meta.get("name", ""),
+        "latitude": lat,
+        "longitude": lng,
+        "distance_meters": distance_meters,
+        "bounce_count": bounce_count,
+        "photo_url": meta.get("photo_url"),
+        "types": types,
+        "_score": calculate_score(popularity(bounce_count, checkin_count), distance_meters)  # Internal, for sorting
+    }
+
 
 def haversine_distance_meters(lat1: float, lon1: float, lat2: float, lon2: float) -> int:
     """Calculate distance between two points in meters using Haversine formula."""
@@ -289,18 +425,18 @@ def haversine_distance_meters(lat1: float, lon1: float, lat2: float, lon2: float
     return int(R * c)
 
 
-def calculate_score(bounce_count: int, distance_meters: Optional[int]) -> float:
+def calculate_score(place_popularity: int, distance_meters: Optional[int]) -> float:
     """
     Calculate ranking score combining popularity and distance.
     Higher score = better match.
 
     - Distance score: 100 (< 1km) -> 5 (> 1000km)
-    - Popularity score: log1p(bounce_count) * 10
+    - Popularity score: log1p(popularity) * 10
     - Combined: (distance * 0.6) + (popularity * 0.4)
     - No location: popularity only (doubled weight)
     """
     # Popularity component (log scale to prevent dominance by super-popular venues)
-    popularity_score = math.log1p(bounce_count) * 10  # 0-50 range typical
+    popularity_score = math.log1p(place_popularity) * 10  # 0-50 range typical
 
     # Distance component
     if distance_meters is None:
@@ -335,6 +471,58 @@ async def get_indexed_place_count() -> int:
         return -1
 
 
+async def rebuild_completion_index(batch_size: int = 500) -> int:
+    """
+    Rebuild every completion set from places:meta:*. Entries only leave a set
+    when a more popular place pushes them out, so a rename or removal can
+    leave a prefix short of K until this runs. Returns the places indexed.
+    """
+    redis = await get_redis()
+
+    async for key in redis.scan_iter(match=f"{COMPLETION_PREFIX}*", count=batch_size):
+        await redis.delete(key)
+
+    indexed = 0
+    meta_keys = []
+
+    async def flush() -> int:
+        pipe = redis.pipeline(transaction=False)
+        for meta_key in meta_keys:
+            pipe.hmget(meta_key, "name", "bounce_count", "checkin_count")
+        rows = await pipe.execute()
+
+        pipe = redis.pipeline(transaction=False)
+        count = 0
+        for meta_key, (name, bounce_count, checkin_count) in zip(meta_keys, rows):
+            normalized = normalize_name(name or "")
+            if not normalized:
+                continue
+            score = popularity(int(bounce_count or 0), int(checkin_count or 0))
+            _add_completions(pipe, meta_key[len(META_PREFIX):], normalized, score)
+            count += 1
+        await pipe.execute()
+        meta_keys.clear()
+        return count
+
+    async for meta_key in redis.scan_iter(match=f"{META_PREFIX}*", count=batch_size):
+        meta_keys.append(meta_key)
+        if len(meta_keys) >= batch_size:
+            indexed += await flush()
+    if meta_keys:
+        indexed += await flush()
+
+    await redis.set(COMPLETION_BUILT_KEY, str(int(time.time())))
+    return indexed
+
+
+async def ensure_completion_index() -> Optional[int]:
+    """Build the completion sets if they never were. Returns places indexed, None if already built."""
+    redis = await get_redis()
+    if await redis.exists(COMPLETION_BUILT_KEY):
+        return None
+    return await rebuild_completion_index()
+
+
 async def sync_db_place_to_redis(
     place_id: str,
     name: str,
@@ -342,7 +530,8 @@ async def sync_db_place_to_redis(
     lat: float,
     lng: float,
     types: Optional[str],  # JSON string from DB
-    bounce_count: int
+    bounce_count: int,
+    checkin_count: int = 0
 ) -> bool:
     """
     Sync a single database Place record to Redis.
@@ -362,5 +551,6 @@ async def sync_db_place_to_redis(
         lat=lat,
         lng=lng,
         types=types_list,
-        bounce_count=bounce_count
+        bounce_count=bounce_count,
+        checkin_count=checkin_count
     )
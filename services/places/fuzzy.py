@@ -0,0 +1,322 @@
+"""
+In-process fuzzy index over the cached places (places:meta:*).
+
+The Redis autocomplete index only matches exact normalized name prefixes.
+This one catches what it misses - typos ("hootrs"), other word orders
+("hart the") and left-out words ("the hart" for The White Hart) - so the
+Google fallback only runs for venues we have never seen.
+
+- Every worker holds the cached places in memory, with a posting set per
+  trigram of each name token. Tokens are padded at the start only, so a
+  query token that is a prefix of a name token shares its grams.
+- A search counts shared grams per place (skipping grams that more than
+  COMMON_GRAM_FRACTION of places have, while rarer ones exist), checks the
+  MAX_CANDIDATES best that share enough grams to be within reach, and keeps
+  those where every query token is within max_edits() of some name token's
+  prefix. Results rank by total edits, then by the usual distance +
+  popularity score.
+- Loaded from places:meta:* on start and kept current from the
+  places:updates channel (services/places/autocomplete.py publishes every
+  change). A lost subscription reloads the whole index on reconnect.
+
+Until the first load completes searches return nothing.
+"""
+import asyncio
+import json
+import logging
+from collections import Counter
+from typing import Dict, FrozenSet, List, Optional, Set, Tuple
+
+from services.places.autocomplete import META_PREFIX, UPDATES_CHANNEL, normalize_name, place_result
+from services.redis import get_redis, redis_available, REDIS_PROBE_INTERVAL_SECONDS
+
+logger = logging.getLogger(__name__)
+
+MAX_CANDIDATES = 30  # Places verified by edit distance per search
+COMMON_GRAM_FRACTION = 0.05
+GRAMS_PER_EDIT = 4  # Trigrams one edit can change (a swap of adjacent characters touches four)
+LOAD_BATCH_SIZE = 500
+
+# Only what place_result needs, not the whole hash
+META_FIELDS = ("name", "address", "lat", "lng", "bounce_count", "checkin_count", "types", "photo_url")
+
+
+def token_grams(token: str) -> List[str]:
+    padded = f"  {token}"
+    return [padded[i:i + 3] for i in range(len(padded) - 2)]
+
+
+def max_edits(token: str) -> int:
+    """Typos tolerated in a query token of this length"""
+    if len(token) <= 3:
+        return 0
+    if len(token) <= 6:
+        return 1
+    return 2
+
+
+def prefix_edit_distance(query: str, token: str, limit: int) -> int:
+    """
+    Fewest edits (insert, delete, substitute, swap adjacent characters) that
+    turn query into a prefix of token, or limit + 1 if it takes more.
+    """
+    if token.startswith(query):
+        return 0
+    if limit == 0:
+        return 1
+    # Longer prefixes of token are out of reach
+    token = token[:len(query) + limit]
+    # Each query character missing from the prefix costs an edit - cheap rejection
+    if sum(char not in token for char in query) > limit:
+        return limit + 1
+
+    # prev[j] = edits between the query so far and token[:j]
+    before_prev = None
+    prev = list(range(len(token) + 1))
+    for i in range(1, len(query) + 1):
+        char = query[i - 1]
+        row = [i] + [0] * len(token)
+        for j in range(1, len(token) + 1):
+            cost = prev[j - 1] + (char != token[j - 1])
+            if prev[j] + 1 < cost:
+                cost = prev[j] + 1
+            if row[j - 1] + 1 < cost:
+                cost = row[j - 1] + 1
+            if (before_prev is not None and j > 1 and char == token[j - 2]
+                    and query[i - 2] == token[j - 1] and before_prev[j - 2] + 1 < cost):
+                cost = before_prev[j - 2] + 1
+            row[j] = cost
+        if min(row) > limit:
+            return limit + 1
+        before_prev, prev = prev, row
+    return min(min(prev), limit + 1)
+
+
+def _match_edits(checks: List[Tuple[str, int]], tokens: Tuple[str, ...]) -> Optional[int]:
+    """Total edits matching each (query token, allowed edits) to a name token prefix, None if one can't"""
+    total = 0
+    for query_token, allowed in checks:
+        if any(token.startswith(query_token) for token in tokens):
+            continue
+        if allowed == 0:
+            return None
+        best = allowed + 1
+        for token in tokens:
+            if len(token) >= len(query_token) - allowed:
+                best = min(best, prefix_edit_distance(query_token, token, best - 1))
+        if best > allowed:
+            return None
+        total += best
+    return total
+
+
+class _Place:
+    __slots__ = ("tokens", "grams", "meta")
+
+    def __init__(self, tokens: Tuple[str, ...], grams: FrozenSet[str], meta: Dict[str, str]):
+        self.tokens = tokens
+        self.grams = grams
+        self.meta = meta
+
+
+class FuzzyPlaceIndex:
+    """Trigram index over place names with edit-distance verification"""
+
+    def __init__(self):
+        self._places: Dict[str, _Place] = {}
+        self._postings: Dict[str, Set[str]] = {}  # gram -> place IDs
+
+    def __len__(self) -> int:
+        return len(self._places)
+
+    def upsert(self, place_id: str, meta: Dict[str, str]) -> None:
+        """Add a place or merge changed fields into it (partial updates for unknown places are ignored)"""
+        existing = self._places.get(place_id)
+        if existing is not None:
+            meta = {**existing.meta, **meta}
+        name = meta.get("name")
+        if not name:
+            return
+
+        tokens = tuple(normalize_name(name).split())
+        grams = frozenset(gram for token in tokens for gram in token_grams(token))
+        old_grams = existing.grams if existing is not None else frozenset()
+        for gram in old_grams - grams:
+            self._discard_posting(gram, place_id)
+        for gram in grams - old_grams:
+            self._postings.setdefault(gram, set()).add(place_id)
+
+        slim = {field: meta[field] for field in META_FIELDS if field in meta}
+        self._places[place_id] = _Place(tokens, grams, slim)
+
+    def remove(self, place_id: str) -> None:
+        place = self._places.pop(place_id, None)
+        if place is not None:
+            for gram in place.grams:
+                self._discard_posting(gram, place_id)
+
+    def _discard_posting(self, gram: str, place_id: str) -> None:
+        posting = self._postings.get(gram)
+        if posting is not None:
+            posting.discard(place_id)
+            if not posting:
+                del self._postings[gram]
+
+    def search(
+        self,
+        query: str,
+        user_lat: Optional[float] = None,
+        user_lng: Optional[float] = None,
+        limit: int = 10
+    ) -> List[dict]:
+        """Places matching every query token up to typos, in any order"""
+        query_tokens = normalize_name(query).split()
+        if not query_tokens:
+            return []
+
+        query_grams = {gram for token in query_tokens for gram in token_grams(token)}
+        postings = sorted(
+            (self._postings[gram] for gram in query_grams if gram in self._postings),
+            key=len
+        )
+        if not postings:
+            return []
+
+        # Grams like "  t" match a large share of places and say little
+        common = COMMON_GRAM_FRACTION * len(self._places)
+        selective = [posting for posting in postings if len(posting) <= common] or postings[:1]
+        counts: Counter = Counter()
+        for posting in selective:
+            counts.update(posting)
+
+        # An edit destroys at most GRAMS_PER_EDIT of the query's grams, so a
+        # place sharing fewer than this can't be within the allowed edits
+        allowed_edits = sum(max_edits(token) for token in query_tokens)
+        min_shared = len(selective) - GRAMS_PER_EDIT * allowed_edits
+
+        # Exact-only tokens first: they reject a candidate without any edit distance work
+        checks = sorted(((token, max_edits(token)) for token in query_tokens), key=lambda check: check[1])
+
+        matches = []
+        for place_id, shared in counts.most_common(MAX_CANDIDATES):
+            if shared < min_shared:
+                break
+            place = self._places[place_id]
+            total_edits = _match_edits(checks, place.tokens)
+            if total_edits is not None:
+                result = place_result(place_id, place.meta, user_lat, user_lng)
+                matches.append((total_edits, -result.pop("_score"), result))
+
+        matches.sort(key=lambda match: match[:2])
+        return [result for _, _, result in matches[:limit]]
+
+
+_index = FuzzyPlaceIndex()
+_ready = False
+
+# Background task handle for the index sync
+_sync_task: Optional[asyncio.Task] = None
+
+
+def fuzzy_search(
+    query: str,
+    user_lat: Optional[float] = None,
+    user_lng: Optional[float] = None,
+    limit: int = 10
+) -> List[dict]:
+    """Typo-tolerant search of this worker's index, PlacePrediction-compatible dicts"""
+    if not _ready:
+        return []
+    return _index.search(query, user_lat, user_lng, limit)
+
+
+def fuzzy_index_size() -> int:
+    return len(_index) if _ready else -1
+
+
+def _apply_update(message: dict) -> None:
+    place_id = message.get("place_id")
+    if not place_id:
+        return
+    if message.get("removed"):
+        _index.remove(place_id)
+    else:
+        _index.upsert(place_id, message.get("meta") or {})
+
+
+async def _load_index(redis) -> FuzzyPlaceIndex:
+    index = FuzzyPlaceIndex()
+    meta_keys = []
+
+    async def flush():
+        pipe = redis.pipeline(transaction=False)
+        for meta_key in meta_keys:
+            pipe.hmget(meta_key, *META_FIELDS)
+        rows = await pipe.execute()
+        for meta_key, values in zip(meta_keys, rows):
+            meta = {field: value for field, value in zip(META_FIELDS, values) if value is not None}
+            index.upsert(meta_key[len(META_PREFIX):], meta)
+        meta_keys.clear()
+
+    async for meta_key in redis.scan_iter(match=f"{META_PREFIX}*", count=LOAD_BATCH_SIZE):
+        meta_keys.append(meta_key)
+        if len(meta_keys) >= LOAD_BATCH_SIZE:
+            await flush()
+    if meta_keys:
+        await flush()
+    return index
+
+
+async def start_fuzzy_index():
+    """Start background task that loads the index and follows places:updates"""
+    global _sync_task
+    if _sync_task is not None:
+        return
+    _sync_task = asyncio.create_task(_sync_loop())
+    logger.info("Started fuzzy places index sync")
+
+
+async def stop_fuzzy_index():
+    """Stop the index sync task"""
+    global _sync_task
+    if _sync_task is not None:
+        _sync_task.cancel()
+        _sync_task = None
+        logger.info("Stopped fuzzy places index sync")
+
+
+async def _sync_loop():
+    global _index, _ready
+    while True:
+        if not redis_available():
+            await asyncio.sleep(REDIS_PROBE_INTERVAL_SECONDS)
+            continue
+        pubsub = None
+        try:
+            redis = await get_redis()
+            pubsub = redis.pubsub()
+            # Subscribe before loading so changes made during the load are replayed after it
+            await pubsub.subscribe(UPDATES_CHANNEL)
+            _index = await _load_index(redis)
+            _ready = True
+            logger.info(f"Fuzzy places index loaded: {len(_index)} places")
+
+            async for msg in pubsub.listen():
+                if msg["type"] != "message":
+                    continue
+                try:
+                    _apply_update(json.loads(msg["data"]))
+                except Exception as e:
+                    logger.error(f"Error applying places update: {e}")
+
+        except asyncio.CancelledError:
+            break
+        except Exception as e:
+            logger.error(f"Fuzzy places index sync error, reloading: {e}")
+            await asyncio.sleep(1)
+        finally:
+            if pubsub is not None:
+                try:
+                    await pubsub.aclose()
+                except Exception:
+                    pass
@@ -0,0 +1,156 @@
+"""
+Nearby venues from the global places:geo index.
+
+GEOSEARCH returns the NEARBY_MAX_CANDIDATES closest places within the radius
+(nearest first, with distances). Their metadata comes from places:meta:* in
+one pipelined round trip and their live occupancy (active check-ins) from
+one grouped query. Candidates are then ranked by nearby_score and pages are
+slices of that ranking.
+
+Rankings are cached per location bucket (NEARBY_BUCKET_DECIMALS, ~110 m) and
+radius for NEARBY_CACHE_TTL seconds, so paging through them is cheap and
+consistent. Distances in results are exact for the caller.
+"""
+import logging
+import math
+from typing import Awaitable, Callable, Dict, List, Tuple
+
+from sqlalchemy import func, select
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from db.database import get_session_maker
+from db.models import CheckIn
+from services.cache import cache_get_or_load
+from services.places.autocomplete import GEO_INDEX, META_PREFIX, haversine_distance_meters, place_result, popularity
+from services.redis import get_redis
+
+logger = logging.getLogger(__name__)
+
+NEARBY_MAX_RADIUS_METERS = 50000
+NEARBY_MAX_CANDIDATES = 200  # Closest places ranked per request; pages are cut from these
+NEARBY_CACHE_TTL = 30  # Occupancy moves, keep rankings short-lived
+NEARBY_BUCKET_DECIMALS = 3
+
+META_FIELDS = ("name", "address", "lat", "lng", "bounce_count", "checkin_count", "types", "photo_url")
+
+OccupancyLoader = Callable[[List[str]], Awaitable[Dict[str, int]]]
+
+
+def nearby_score(distance_meters: float, radius_meters: int, place_popularity: int, occupancy: int) -> float:
+    """
+    Rank a place found within radius_meters. Higher score = better.
+
+    - Distance score: 100 at the center, falling linearly to 0 at the radius
+    - Popularity score: log1p(popularity) * 10, as in autocomplete
+    - Occupancy score: log1p(people checked in now) * 20
+    - Combined: (distance * 0.5) + (popularity * 0.2) + (occupancy * 0.3)
+    """
+    distance_score = max(0.0, 1 - distance_meters / radius_meters) * 100
+    popularity_score = math.log1p(place_popularity) * 10
+    occupancy_score = math.log1p(occupancy) * 20
+    return (distance_score * 0.5) + (popularity_score * 0.2) + (occupancy_score * 0.3)
+
+
+async def active_checkin_counts(db: AsyncSession, place_ids: List[str]) -> Dict[str, int]:
+    """Active check-ins per place, one grouped query (places without any are left out)"""
+    if not place_ids:
+        return {}
+    result = await db.execute(
+        select(CheckIn.place_id, func.count(CheckIn.id))
+        .where(CheckIn.place_id.in_(place_ids), CheckIn.is_active == True)
+        .group_by(CheckIn.place_id)
+    )
+    return {place_id: count for place_id, count in result.all()}
+
+
+async def rank_nearby(lat: float, lng: float, radius_meters: int, occupancy_loader: OccupancyLoader) -> List[dict]:
+    """All candidates around (lat, lng), best first, with "occupancy" and "_score" set"""
+    redis = await get_redis()
+    found = await redis.geosearch(
+        GEO_INDEX,
+        longitude=lng,
+        latitude=lat,
+        radius=radius_meters,
+        unit="m",
+        sort="ASC",
+        count=NEARBY_MAX_CANDIDATES,
+        withdist=True,
+    )
+    if not found:
+        return []
+
+    pipe = redis.pipeline(transaction=False)
+    for place_id, _ in found:
+        pipe.hmget(f"{META_PREFIX}{place_id}", *META_FIELDS)
+    rows = await pipe.execute()
+
+    candidates = []
+    expired = []
+    for (place_id, distance), values in zip(found, rows):
+        meta = {field: value for field, value in zip(META_FIELDS, values) if value is not None}
+        if not meta.get("name"):
+            expired.append(place_id)
+            continue
+        candidates.append((place_id, distance, meta))
+
+    # Metadata expired: drop the place from the geo index too
+    if expired:
+        await redis.zrem(GEO_INDEX, *expired)
+
+    occupancy = await occupancy_loader([place_id for place_id, _, _ in candidates])
+
+    results = []
+    for place_id, distance, meta in candidates:
+        result = place_result(place_id, meta)
+        result["occupancy"] = occupancy.get(place_id, 0)
+        result["_score"] = nearby_score(
+            distance,
+            radius_meters,
+            popularity(result["bounce_count"], int(meta.get("checkin_count", 0))),
+            result["occupancy"],
+        )
+        results.append(result)
+
+    results.sort(key=lambda r: r["_score"], reverse=True)
+    return results
+
+
+async def nearby_places(
+    lat: float,
+    lng: float,
+    radius_meters: int,
+    offset: int = 0,
+    limit: int = 20
+) -> Tuple[List[dict], int]:
+    """
+    One page of ranked nearby places (PlacePrediction-compatible dicts with
+    distance_meters and occupancy) and the number of ranked places.
+
+    The ranking load is shared by concurrent requests and can outlive the one
+    that started it, so it reads occupancy through a primary session of its own
+    (occupancy changes with every check-in; a lagging replica would cache stale
+    counts for NEARBY_CACHE_TTL).
+    """
+    bucket_lat = round(lat, NEARBY_BUCKET_DECIMALS)
+    bucket_lng = round(lng, NEARBY_BUCKET_DECIMALS)
+
+    async def load() -> List[dict]:
+        async with get_session_maker()() as db:
+            return await rank_nearby(
+                bucket_lat, bucket_lng, radius_meters,
+                lambda place_ids: active_checkin_counts(db, place_ids)
+            )
+
+    key = f"places_nearby:{bucket_lat},{bucket_lng}:{radius_meters}"
+    try:
+        ranked = await cache_get_or_load(key, load, ttl=NEARBY_CACHE_TTL)
+    except Exception as e:
+        logger.error(f"Nearby places search failed: {e}")
+        return [], 0
+
+    page = []
+    for result in ranked[offset:offset + limit]:
+        result = {k: v for k, v in result.items() if k != "_score"}
+        result["distance_meters"] = haversine_distance_meters(lat, lng, result["latitude"], result["longitude"])
+        page.append(result)
+    return page, len(ranked)
@@ -5,16 +5,16 @@ Handles deduplication and photo fetching.
 
 import json
 import logging
-import ssl
-import certifi
 from typing import Optional, List
 
-import aiohttp
+import httpx
 from sqlalchemy import select
 from sqlalchemy.ext.asyncio import AsyncSession
 
 from core.config import settings
 from db.models import Place, GooglePic
+from services.http_clients import GOOGLE, get_http_client
+from services.places.autocomplete import increment_bounce_count, sync_db_place_to_redis
 
 logger = logging.getLogger(__name__)
 
@@ -24,11 +24,6 @@ GOOGLE_PLACES_PHOTO_URL = "https://maps.googleapis.com/maps/api/place/photo"
 MAX_PHOTOS = 5
 
 
-def get_ssl_context():
-    """Get SSL context for aiohttp requests"""
-    return ssl.create_default_context(cafile=certifi.where())
-
-
 class PlacesService:
     """Service for managing Google Places data"""
 
@@ -50,38 +45,36 @@ class PlacesService:
         }
 
         try:
-            ssl_ctx = get_ssl_context()
-            async with aiohttp.ClientSession() as session:
-                async with session.get(GOOGLE_PLACES_DETAILS_URL, params=params, ssl=ssl_ctx) as response:
-                    data = await response.json()
-
-                    if data.get("status") != "OK":
-                        logger.error(f"Places API error for {place_id}: {data.get('status')}")
-                        return None
-
-                    result = data.get("result", {})
-                    location = result.get("geometry", {}).get("location", {})
-
-                    # Extract photo references (up to MAX_PHOTOS)
-                    photos = []
-                    for photo in result.get("photos", [])[:MAX_PHOTOS]:
-                        photos.append({
-                            "photo_reference": photo.get("photo_reference"),
-                            "width": photo.get("width"),
-                            "height": photo.get("height"),
-                            "attributions": photo.get("html_attributions", [])
-                        })
-
-                    return {
-                        "name": result.get("name", ""),
-                        "address": result.get("formatted_address", ""),
-                        "latitude": location.get("lat", 0),
-                        "longitude": location.get("lng", 0),
-                        "types": result.get("types", []),
-                        "photos": photos
-                    }
-
-        except aiohttp.ClientError as e:
+            response = await get_http_client(GOOGLE).get(GOOGLE_PLACES_DETAILS_URL, params=params)
+            data = response.json()
+
+            if data.get("status") != "OK":
+                logger.error(f"Places API error for {place_id}: {data.get('status')}")
+                return None
+
+            result = data.get("result", {})
+            location = result.get("geometry", {}).get("location", {})
+
+            # Extract photo references (up to MAX_PHOTOS)
+            photos = []
+            for photo in result.get("photos", [])[:MAX_PHOTOS]:
+                photos.append({
+                    "photo_reference": photo.get("photo_reference"),
+                    "width": photo.get("width"),
+                    "height": photo.get("height"),
+                    "attributions": photo.get("html_attributions", [])
+                })
+
+            return {
+                "name": result.get("name", ""),
+                "address": result.get("formatted_address", ""),
+                "latitude": location.get("lat", 0),
+                "longitude": location.get("lng", 0),
+                "types": result.get("types", []),
+                "photos": photos
+            }
+
+        except (httpx.HTTPError, ValueError) as e:
             logger.error(f"Failed to fetch place details: {e}")
             return None
 
@@ -141,6 +134,8 @@ async def get_place_with_photos(
         if source == "bounce":
             existing_place.bounce_count += 1
             logger.info(f"Place {place_id} already exists, bounce_count now {existing_place.bounce_count}")
+            if await increment_bounce_count(place_id) < 0:
+                await _index_place_row(existing_place)
         # checkin source doesn't increment counts - checkins tracked separately
         await db.flush()
         return existing_place
@@ -201,4 +196,18 @@ async def get_place_with_photos(
         logger.info(f"Created place {place_id} without photos")
 
     await db.flush()
+    await _index_place_row(place)
     return place
+
+
+async def _index_place_row(place: Place) -> None:
+    """Add a Place row to the global autocomplete / nearby indexes"""
+    await sync_db_place_to_redis(
+        place_id=place.place_id,
+        name=place.name,
+        address=place.address,
+        lat=place.latitude,
+        lng=place.longitude,
+        types=place.types,
+        bounce_count=place.bounce_count,
+    )
@@ -0,0 +1,137 @@
+"""
+Slim authenticated principal with a two-tier cache.
+
+get_current_principal (api/dependencies.py) resolves a JWT to a Principal
+without touching the users table on the hot path: an in-process TTL/LRU first,
+then Redis (principal:{user_id}), then a narrow SELECT of just these columns.
+
+Call invalidate_principal() after committing any change to nickname, first_name,
+profile pictures, is_active or is_admin, or after deleting the user. The local
+tier only lives LOCAL_TTL seconds, which bounds how long another worker can keep
+serving a principal it cached before the invalidation.
+"""
+import json
+import logging
+import time
+from collections import OrderedDict
+from dataclasses import dataclass, asdict
+from typing import Optional
+
+from sqlalchemy import select
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from db.models import User
+from services.image_store import thumbnail_url
+
+logger = logging.getLogger(__name__)
+
+PRINCIPAL_KEY_PREFIX = "principal:"
+PRINCIPAL_TTL = 600  # 10 minutes in Redis
+LOCAL_TTL = 15  # seconds in-process
+LOCAL_MAX_ENTRIES = 10_000
+
+
+@dataclass(frozen=True)
+class Principal:
+    """What most endpoints need to know about the caller"""
+    id: int
+    nickname: Optional[str]
+    first_name: Optional[str]
+    avatar_url: Optional[str]
+    is_active: bool
+    is_admin: bool
+
+
+# user_id -> (expires_at, principal), oldest first
+_local_cache: "OrderedDict[int, tuple[float, Principal]]" = OrderedDict()
+
+
+def _local_get(user_id: int) -> Optional[Principal]:
+    entry = _local_cache.get(user_id)
+    if entry is None:
+        return None
+    expires_at, principal = entry
+    if expires_at < time.monotonic():
+        _local_cache.pop(user_id, None)
+        return None
+    _local_cache.move_to_end(user_id)
+    return principal
+
+
+def _local_put(principal: Principal) -> None:
+    _local_cache[principal.id] = (time.monotonic() + LOCAL_TTL, principal)
+    _local_cache.move_to_end(principal.id)
+    while len(_local_cache) > LOCAL_MAX_ENTRIES:
+        _local_cache.popitem(last=False)
+
+
+async def _load_principal(db: AsyncSession, user_id: int) -> Optional[Principal]:
+    result = await db.execute(
+        select(
+            User.id,
+            User.nickname,
+            User.first_name,
+            User.profile_picture,
+            User.instagram_profile_pic,
+            User.profile_picture_1,
+            User.is_active,
+            User.is_admin,
+        ).where(User.id == user_id)
+    )
+    row = result.first()
+    if row is None:
+        return None
+    return Principal(
+        id=row.id,
+        nickname=row.nickname,
+        first_name=row.first_name,
+        avatar_url=row.profile_picture or row.instagram_profile_pic or thumbnail_url(row.profile_picture_1),
+        is_active=bool(row.is_active),
+        is_admin=bool(row.is_admin),
+    )
+
+
+async def get_principal(db: AsyncSession, user_id: int) -> Optional[Principal]:
+    """Principal for user_id: local LRU -> Redis -> slim DB read. None if no such user."""
+    from services.redis import get_redis
+
+    principal = _local_get(user_id)
+    if principal is not None:
+        return principal
+
+    key = f"{PRINCIPAL_KEY_PREFIX}{user_id}"
+    r = None
+    try:
+        r = await get_redis()
+        cached = await r.get(key)
+        if cached:
+            principal = Principal(**json.loads(cached))
+            _local_put(principal)
+            return principal
+    except Exception as e:
+        logger.warning(f"Principal cache read failed for user {user_id}: {e}")
+        r = None
+
+    principal = await _load_principal(db, user_id)
+    if principal is None:
+        return None
+
+    _local_put(principal)
+    if r is not None:
+        try:
+            await r.setex(key, PRINCIPAL_TTL, json.dumps(asdict(principal)))
+        except Exception as e:
+            logger.warning(f"Principal cache write failed for user {user_id}: {e}")
+    return principal
+
+
+async def invalidate_principal(user_id: int) -> None:
+    """Drop a cached principal - call after committing changes to the user"""
+    from services.redis import get_redis
+
+    _local_cache.pop(user_id, None)
+    try:
+        r = await get_redis()
+        await r.delete(f"{PRINCIPAL_KEY_PREFIX}{user_id}")
+    except Exception as e:
+        logger.warning(f"Principal cache invalidation failed for user {user_id}: {e}")
@@ -0,0 +1,268 @@
+"""
+Background expiry reaper for presence tables.
+
+Removes rows that have gone stale so bounce_attendees, check_ins and
+bounce_location_shares only ever hold live presence, and read queries don't
+need time predicates:
+
+- bounce_attendees not seen for ATTENDEE_EXPIRY_MINUTES are deleted and the
+  bounce's new attendee list is broadcast (bounce_attendee_update).
+- check_ins not seen for CHECKIN_EXPIRY_HOURS (or never seen) are moved to
+  check_in_history with move_checkin_to_history and a venue_checkout is
+  broadcast. Legacy non-venue check-ins (POST /checkins/, no place_id) have
+  no history row to go to and are deleted.
+- bounce_location_shares that were switched off, went quiet for
+  LOCATION_SHARE_EXPIRY_HOURS, or belong to a bounce that is no longer active
+  are deleted; live ones get location_sharing_stopped.
+
+Work is done in small batches, each in its own transaction, with
+SKIP LOCKED so a request touching the same row is never blocked.
+"""
+import asyncio
+import logging
+from datetime import datetime, timezone, timedelta
+from typing import Optional, Set, Dict, List
+
+from sqlalchemy import or_, select, text
+from sqlalchemy.ext.asyncio import AsyncSession
+
+from db.models import CheckIn, User
+from services.etag import BOUNCES_SCOPE, CHECKINS_SCOPE, bump_versions, bump_close_friend_viewers
+from services.follow_graph import sync_checkins
+
+logger = logging.getLogger(__name__)
+
+REAPER_INTERVAL_SECONDS = 60
+REAPER_BATCH_SIZE = 500
+REAPER_LOCK_KEY = "reaper:lock"
+
+LOCATION_SHARE_EXPIRY_HOURS = 2  # Sharing with no location update for this long is abandoned
+LOCATION_SHARE_DISABLED_GRACE_MINUTES = 60  # Switched-off shares are kept this long for quick re-enable
+
+
+async def reap_attendees(db: AsyncSession) -> int:
+    """Delete expired bounce attendees and broadcast the updated lists. Returns rows deleted."""
+    from api.routes.bounces import ATTENDEE_EXPIRY_MINUTES, get_active_attendees
+    from api.routes.websocket import manager
+
+    cutoff = datetime.now(timezone.utc) - timedelta(minutes=ATTENDEE_EXPIRY_MINUTES)
+    total = 0
+    bounce_ids: Set[int] = set()
+
+    while True:
+        result = await db.execute(text("""
+            DELETE FROM bounce_attendees
+            WHERE id IN (
+                SELECT id FROM bounce_attendees
+                WHERE last_seen_at < :cutoff
+                LIMIT :batch_size
+                FOR UPDATE SKIP LOCKED
+            )
+            RETURNING bounce_id
+        """), {"cutoff": cutoff, "batch_size": REAPER_BATCH_SIZE})
+        rows = result.all()
+        await db.commit()
+
+        total += len(rows)
+        bounce_ids.update(row[0] for row in rows)
+        if len(rows) < REAPER_BATCH_SIZE:
+            break
+        await asyncio.sleep(0)
+
+    if bounce_ids:
+        await bump_versions(BOUNCES_SCOPE)
+    for bounce_id in bounce_ids:
+        count, attendees = await get_active_attendees(db, bounce_id, include_details=True)
+        await manager.broadcast({
+            "type": "bounce_attendee_update",
+            "bounce_id": bounce_id,
+            "attendee_count": count,
+            "attendees": [a.model_dump(mode='json') for a in attendees]
+        })
+
+    return total
+
+
+async def reap_checkins(db: AsyncSession) -> int:
+    """Move stale check-ins to history and broadcast venue_checkout. Returns check-ins removed."""
+    from api.routes.checkins import CHECKIN_EXPIRY_HOURS, move_checkin_to_history
+    from api.routes.websocket import manager
+    from services.cache import cache_delete
+
+    cutoff = datetime.now(timezone.utc) - timedelta(hours=CHECKIN_EXPIRY_HOURS)
+    total = 0
+
+    while True:
+        result = await db.execute(
+            select(CheckIn, User.nickname)
+            .join(User, CheckIn.user_id == User.id)
+            .where(or_(CheckIn.last_seen_at < cutoff, CheckIn.last_seen_at.is_(None)))
+            .order_by(CheckIn.id)
+            .limit(REAPER_BATCH_SIZE)
+            .with_for_update(of=CheckIn, skip_locked=True)
+        )
+        rows = result.all()
+        if not rows:
+            await db.rollback()
+            break
+
+        checkouts = []
+        for checkin, nickname in rows:
+            if checkin.place_id is None:
+                await db.delete(checkin)
+                continue
+            checkouts.append({
+                "place_id": checkin.place_id,
+                "venue_name": checkin.location_name,
+                "user_id": checkin.user_id,
+                "nickname": nickname,
+            })
+            await move_checkin_to_history(db, checkin)
+        await db.commit()
+        await sync_checkins(left=[(c["user_id"], c["place_id"]) for c in checkouts])
+        total += len(rows)
+
+        now = datetime.now(timezone.utc).isoformat()
+        for place_id in {c["place_id"] for c in checkouts}:
+            await cache_delete(f"venue_count:{place_id}")
+        await bump_versions(CHECKINS_SCOPE)
+        await bump_close_friend_viewers(db, [c["user_id"] for c in checkouts])
+        for checkout in checkouts:
+            await manager.broadcast({
+                "type": "venue_checkout",
+                **checkout,
+                "reason": "expired",
+                "timestamp": now
+            })
+
+        if len(rows) < REAPER_BATCH_SIZE:
+            break
+        await asyncio.sleep(0)
+
+    return total
+
+
+async def reap_location_shares(db: AsyncSession) -> int:
+    """Delete abandoned location shares, telling viewers of live ones. Returns rows deleted."""
+    from api.routes.bounces import get_bounce_participants
+    from api.routes.websocket import manager
+
+    now = datetime.now(timezone.utc)
+    total = 0
+    stopped: Dict[int, List[int]] = {}  # bounce_id -> users whose live share was reaped
+
+    while True:
+        result = await db.execute(text("""
+            DELETE FROM bounce_location_shares
+            WHERE id IN (
+                SELECT s.id FROM bounce_location_shares s
+                JOIN bounces b ON b.id = s.bounce_id
+                WHERE b.status <> 'active'
+                   OR (s.is_sharing = false AND s.updated_at < :disabled_cutoff)
+                   OR s.updated_at < :stale_cutoff
+                LIMIT :batch_size
+                FOR UPDATE OF s SKIP LOCKED
+            )
+            RETURNING bounce_id, user_id, is_sharing
+        """), {
+            "disabled_cutoff": now - timedelta(minutes=LOCATION_SHARE_DISABLED_GRACE_MINUTES),
+            "stale_cutoff": now - timedelta(hours=LOCATION_SHARE_EXPIRY_HOURS),
+            "batch_size": REAPER_BATCH_SIZE,
+        })
+        rows = result.all()
+        await db.commit()
+
+        total += len(rows)
+        for bounce_id, user_id, is_sharing in rows:
+            if is_sharing:
+                stopped.setdefault(bounce_id, []).append(user_id)
+        if len(rows) < REAPER_BATCH_SIZE:
+            break
+        await asyncio.sleep(0)
+
+    for bounce_id, user_ids in stopped.items():
+        participants = await get_bounce_participants(db, bounce_id)
+        for user_id in user_ids:
+            stop_message = {
+                "type": "location_sharing_stopped",
+                "bounce_id": bounce_id,
+                "user_id": user_id
+            }
+            for participant_id in participants:
+                if participant_id != user_id:
+                    await manager.send_to_user(participant_id, stop_message)
+            await manager.send_to_bounce(bounce_id, stop_message)
+
+    return total
+
+
+async def reap_expired(db: AsyncSession) -> Dict[str, int]:
+    """One full reaper pass. Returns rows removed per table (-1 if its pass failed)."""
+    passes = {
+        "bounce_attendees": reap_attendees,
+        "check_ins": reap_checkins,
+        "bounce_location_shares": reap_location_shares,
+    }
+    reaped = {}
+    # A failing table must not keep the others from being reaped
+    for table, reap in passes.items():
+        try:
+            reaped[table] = await reap(db)
+        except Exception as e:
+            logger.error(f"Reaper pass for {table} failed: {e}")
+            await db.rollback()
+            reaped[table] = -1
+    return reaped
+
+
+# Background task handle for the reaper
+_reaper_task: Optional[asyncio.Task] = None
+
+
+async def start_reaper_loop():
+    """Start background loop that expires stale presence rows"""
+    global _reaper_task
+    if _reaper_task is not None:
+        return
+    _reaper_task = asyncio.create_task(_reaper_loop())
+    logger.info("Started expiry reaper loop")
+
+
+async def stop_reaper_loop():
+    """Stop the reaper background loop"""
+    global _reaper_task
+    if _reaper_task is not None:
+        _reaper_task.cancel()
+        _reaper_task = None
+        logger.info("Stopped expiry reaper loop")
+
+
+async def _reaper_loop():
+    """Reap every REAPER_INTERVAL_SECONDS; one worker per interval via a Redis lock"""
+    from db.database import get_session_maker
+    from services.redis import get_redis
+
+    while True:
+        try:
+            await asyncio.sleep(REAPER_INTERVAL_SECONDS)
+
+            # Reads rely on the reaper, so without Redis every worker reaps -
+            # SKIP LOCKED keeps concurrent passes from colliding
+            try:
+                r = await get_redis()
+                if not await r.set(REAPER_LOCK_KEY, "1", nx=True, ex=REAPER_INTERVAL_SECONDS - 5):
+                    continue
+            except Exception as e:
+                logger.warning(f"Reaper lock unavailable, reaping anyway: {e}")
+
+            session_maker = get_session_maker()
+            async with session_maker() as db:
+                reaped = await reap_expired(db)
+
+            if any(reaped.values()):
+                logger.info(f"Reaper expired {reaped}")
+
+        except asyncio.CancelledError:
+            break
+        except Exception as e:
+            logger.error(f"Reaper loop error: {e}")
@@ -1,20 +1,154 @@
-"""Redis service for caching and pub/sub"""
+"""
+Redis service for caching and pub/sub.
+
+The client sits behind a circuit breaker shared by the whole process. After
+REDIS_FAILURE_THRESHOLD consecutive failed connection attempts the breaker
+opens: every command then fails immediately with RedisUnavailableError instead
+of waiting on its own connect timeout, and a background probe pings Redis every
+REDIS_PROBE_INTERVAL_SECONDS until it answers and the breaker closes again.
+
+Callers that have a local fallback (cache, WebSocket fan-out, badges) check
+redis_available() and skip Redis outright while it is open.
+"""
+
+import asyncio
+import logging
+import time
 
 import redis.asyncio as redis
 from core.config import settings
 
+logger = logging.getLogger(__name__)
+
+REDIS_FAILURE_THRESHOLD = 3  # Consecutive connection failures before the breaker opens
+REDIS_PROBE_INTERVAL_SECONDS = 2
+REDIS_CONNECT_TIMEOUT = 1.0  # seconds
+
+
+class RedisUnavailableError(redis.ConnectionError):
+    """Raised without touching the network while the breaker is open"""
+
+
+class RedisCircuitBreaker:
+    """Tracks connection health and the time spent degraded"""
+
+    def __init__(self):
+        self.consecutive_failures = 0
+        self.opened_at: float | None = None  # monotonic, set while open
+        self.trips = 0
+        self.fast_failures = 0
+        self.degraded_seconds = 0.0  # Completed outages only, see stats()
+        self.last_error: str | None = None
+        self._probe_task: asyncio.Task | None = None
+
+    @property
+    def is_open(self) -> bool:
+        return self.opened_at is not None
+
+    def before_call(self) -> None:
+        if self.is_open:
+            self.fast_failures += 1
+            raise RedisUnavailableError(f"Redis circuit open: {self.last_error}")
+
+    def record_success(self) -> None:
+        self.consecutive_failures = 0
+
+    def record_failure(self, error: Exception) -> None:
+        self.consecutive_failures += 1
+        self.last_error = str(error) or type(error).__name__
+        if self.is_open or self.consecutive_failures < REDIS_FAILURE_THRESHOLD:
+            return
+        self.opened_at = time.monotonic()
+        self.trips += 1
+        logger.error(f"Redis circuit opened after {self.consecutive_failures} failures: {self.last_error}")
+        if self._probe_task is None or self._probe_task.done():
+            self._probe_task = asyncio.create_task(self._probe_loop())
+
+    def close(self) -> None:
+        if not self.is_open:
+            return
+        outage = time.monotonic() - self.opened_at
+        self.degraded_seconds += outage
+        self.opened_at = None
+        self.consecutive_failures = 0
+        logger.info(f"Redis circuit closed after {outage:.1f}s degraded")
+
+    async def _probe_loop(self) -> None:
+        """Ping Redis on a separate connection until it answers"""
+        while self.is_open:
+            await asyncio.sleep(REDIS_PROBE_INTERVAL_SECONDS)
+            probe = redis.from_url(
+                settings.REDIS_URL,
+                socket_connect_timeout=REDIS_CONNECT_TIMEOUT,
+                socket_timeout=REDIS_CONNECT_TIMEOUT
+            )
+            try:
+                await probe.ping()
+                self.close()
+            except Exception as e:
+                self.last_error = str(e) or type(e).__name__
+            finally:
+                try:
+                    await probe.close(close_connection_pool=True)
+                except Exception:
+                    pass
+
+    def stats(self) -> dict:
+        current = time.monotonic() - self.opened_at if self.is_open else 0.0
+        return {
+            "state": "open" if self.is_open else "closed",
+            "trips": self.trips,
+            "fast_failures": self.fast_failures,
+            "degraded_seconds": round(self.degraded_seconds + current, 1),
+            "current_outage_seconds": round(current, 1) if self.is_open else None,
+            "last_error": self.last_error,
+        }
+
+
+_breaker = RedisCircuitBreaker()
+
+
+class _BreakerConnectionPool(redis.ConnectionPool):
+    """Connection pool that fails fast while the breaker is open and reports connect results"""
+
+    async def get_connection(self, command_name, *keys, **options):
+        _breaker.before_call()
+        return await super().get_connection(command_name, *keys, **options)
+
+    async def ensure_connection(self, connection):
+        try:
+            await super().ensure_connection(connection)
+        except (redis.ConnectionError, redis.TimeoutError, OSError) as e:
+            _breaker.record_failure(e)
+            raise
+        _breaker.record_success()
+
+
+def redis_available() -> bool:
+    """False while the breaker is open - use the local fallback instead of calling Redis"""
+    return not _breaker.is_open
+
+
+def redis_breaker_stats() -> dict:
+    """Breaker state and time spent degraded, for this process"""
+    return _breaker.stats()
+
+
 _redis_client: redis.Redis | None = None
 
 
 async def get_redis() -> redis.Redis:
-    """Get Redis client instance (lazy initialization)"""
+    """Get Redis client instance (lazy initialization). Raises RedisUnavailableError while the breaker is open."""
     global _redis_client
+    _breaker.before_call()
     if _redis_client is None:
-        _redis_client = redis.from_url(
+        pool = _BreakerConnectionPool.from_url(
             settings.REDIS_URL,
             encoding="utf-8",
-            decode_responses=True
+            decode_responses=True,
+            socket_connect_timeout=REDIS_CONNECT_TIMEOUT
         )
+        _redis_client = redis.Redis(connection_pool=pool)
     return _redis_client
 
 
@@ -22,7 +156,7 @@ async def close_redis():
     """Close Redis connection"""
     global _redis_client
     if _redis_client:
-        await _redis_client.close()
+        await _redis_client.close(close_connection_pool=True)
         _redis_client = None
 
 
@@ -37,6 +171,18 @@ async def increment_badge_count(user_id: int) -> int:
     return await r.incr(key)
 
 
+async def increment_badge_counts(user_ids: list[int]) -> dict[int, int]:
+    """Increment badge counts for many users in one pipelined round trip"""
+    if not user_ids:
+        return {}
+    r = await get_redis()
+    pipe = r.pipeline(transaction=False)
+    for user_id in user_ids:
+        pipe.incr(f"{BADGE_KEY_PREFIX}{user_id}")
+    counts = await pipe.execute()
+    return dict(zip(user_ids, counts))
+
+
 async def get_badge_count(user_id: int) -> int:
     """Get current badge count for a user"""
     r = await get_redis()
@@ -45,6 +191,22 @@ async def get_badge_count(user_id: int) -> int:
     return int(count) if count else 0
 
 
+# Read-your-writes marker for replica routing
+RECENT_WRITE_KEY_PREFIX = "recent_write:"
+
+
+async def mark_recent_write(user_id: int) -> None:
+    """Pin a user's reads to the primary for REPLICA_PIN_SECONDS"""
+    r = await get_redis()
+    await r.set(f"{RECENT_WRITE_KEY_PREFIX}{user_id}", "1", ex=settings.REPLICA_PIN_SECONDS)
+
+
+async def has_recent_write(user_id: int) -> bool:
+    """Whether the user wrote within the pin window"""
+    r = await get_redis()
+    return bool(await r.exists(f"{RECENT_WRITE_KEY_PREFIX}{user_id}"))
+
+
 async def reset_badge_count(user_id: int) -> None:
     """Reset badge count to 0 for a user"""
     r = await get_redis()
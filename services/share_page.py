@@ -0,0 +1,245 @@
+"""
+Precompiled bounce share page.
+
+The page is composed from templates/bounce_share.html and its partials once
+per process. Compiling it:
+- moves every <style> block into one stylesheet and every inline <script>
+  without placeholders into its own script file, keeping their positions in
+  the page (a script with placeholders keeps only the lines up to its last
+  placeholder inline). These assets are served from memory under
+  /bounce/assets/{name}.{hash}.{ext}, gzip and brotli compressed once, with an
+  immutable Cache-Control.
+- splits the remaining HTML on its {{PLACEHOLDER}}s, so rendering a bounce
+  is a single join.
+
+Rendered pages are kept per share token and WebSocket base (pre-compressed)
+for PAGE_CACHE_TTL seconds, and dropped earlier when the bounce or its
+creator's version counter (services/etag.py) moves. Without Redis pages are
+rendered on every request.
+"""
+import gzip
+import hashlib
+import logging
+import os
+import re
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+import brotli
+
+from core.config import settings
+from services.etag import get_versions
+
+logger = logging.getLogger(__name__)
+
+TEMPLATE_DIR = os.path.join(os.path.dirname(__file__), "..", "templates")
+ASSET_URL_PREFIX = "/bounce/assets"
+ASSET_CACHE_CONTROL = "public, max-age=31536000, immutable"
+
+PAGE_CACHE_TTL = 300  # Bounds staleness of data without a version counter (venue photo)
+PAGE_CACHE_MAX_ENTRIES = 1000
+
+_PLACEHOLDER_RE = re.compile(r"\{\{([A-Z_]+)\}\}")
+_STYLE_RE = re.compile(r"<style>(.*?)</style>\n?", re.DOTALL)
+_SCRIPT_RE = re.compile(r"<script>(.*?)</script>", re.DOTALL)
+
+CONTENT_TYPES = {
+    "css": "text/css",
+    "js": "application/javascript",
+}
+
+
+@dataclass
+class CompressedBody:
+    """One body in every encoding we serve"""
+    identity: bytes
+    gzip: bytes
+    br: bytes
+
+    @classmethod
+    def build(cls, data: bytes, best: bool = False) -> "CompressedBody":
+        # Assets are compressed once per process, pages once per cache fill
+        return cls(
+            identity=data,
+            gzip=gzip.compress(data, compresslevel=9 if best else 6),
+            br=brotli.compress(data, quality=11 if best else 5),
+        )
+
+    def select(self, accept_encoding: Optional[str]) -> Tuple[bytes, Optional[str]]:
+        """Body and Content-Encoding for an Accept-Encoding header"""
+        encoding = choose_encoding(accept_encoding)
+        if encoding == "br":
+            return self.br, "br"
+        if encoding == "gzip":
+            return self.gzip, "gzip"
+        return self.identity, None
+
+
+def choose_encoding(accept_encoding: Optional[str]) -> Optional[str]:
+    """Preferred encoding the client accepts: br, then gzip, else None"""
+    accepted = set()
+    for part in (accept_encoding or "").lower().split(","):
+        coding, _, params = part.strip().partition(";")
+        if params.replace(" ", "") in ("q=0", "q=0.0", "q=0.00", "q=0.000"):
+            continue
+        accepted.add(coding.strip())
+    for encoding in ("br", "gzip"):
+        if encoding in accepted or "*" in accepted:
+            return encoding
+    return None
+
+
+@dataclass
+class Asset:
+    content_type: str
+    body: CompressedBody
+
+
+@dataclass
+class CompiledPage:
+    segments: List[str]  # Even indexes are literal HTML, odd ones placeholder names
+    assets: Dict[str, Asset]  # "{name}.{hash}.{ext}" -> asset
+
+    def render(self, values: Dict[str, str]) -> str:
+        segments = self.segments
+        parts = segments[:]
+        for i in range(1, len(segments), 2):
+            parts[i] = values[segments[i]]
+        return "".join(parts)
+
+
+@dataclass
+class _CachedPage:
+    scopes: List[str]
+    versions: List[int]
+    expires_at: float
+    body: CompressedBody
+
+
+_compiled: Optional[CompiledPage] = None
+
+# (share_token, ws_base) -> rendered page, oldest first
+_page_cache: "OrderedDict[Tuple[str, str], _CachedPage]" = OrderedDict()
+
+
+def _read_template(name: str) -> str:
+    with open(os.path.join(TEMPLATE_DIR, name), "r") as f:
+        return f.read()
+
+
+def _compose() -> str:
+    html = _read_template("bounce_share.html")
+    html = html.replace("{{VENUE_SHEET}}", _read_template("venue_sheet.html"))
+    html = html.replace("{{USER_SHEET}}", _read_template("user_sheet.html"))
+    chat_panel_html = _read_template("chat_panel.html").replace("{{FEED_ITEM}}", _read_template("feed_item.html"))
+    html = html.replace("{{CHAT_PANEL}}", chat_panel_html)
+    # Same for every bounce
+    return html.replace("{{GOOGLE_MAPS_API_KEY}}", settings.GOOGLE_MAPS_API_KEY)
+
+
+def _add_asset(assets: Dict[str, Asset], name: str, ext: str, content: str) -> str:
+    data = content.encode()
+    digest = hashlib.sha256(data).hexdigest()[:12]
+    filename = f"{name}.{digest}.{ext}"
+    assets[filename] = Asset(CONTENT_TYPES[ext], CompressedBody.build(data, best=True))
+    return f"{ASSET_URL_PREFIX}/{filename}"
+
+
+def compile_share_page() -> CompiledPage:
+    """Compose the templates and split them into static assets and a render function"""
+    html = _compose()
+    assets: Dict[str, Asset] = {}
+
+    # All styles go into one stylesheet, linked where the first one was
+    styles = [m.group(1) for m in _STYLE_RE.finditer(html) if "{{" not in m.group(1)]
+    if styles:
+        css_url = _add_asset(assets, "share", "css", "\n".join(styles))
+        link = f'<link rel="stylesheet" href="{css_url}">\n'
+        first = True
+
+        def replace_style(match: re.Match) -> str:
+            nonlocal first
+            if "{{" in match.group(1):
+                return match.group(0)
+            if first:
+                first = False
+                return link
+            return ""
+
+        html = _STYLE_RE.sub(replace_style, html)
+
+    # Each inline script becomes an external one in the same place, so execution order is unchanged
+    script_count = 0
+
+    def replace_script(match: re.Match) -> str:
+        nonlocal script_count
+        body = match.group(1)
+        inline = ""
+        if "{{" in body:
+            lines = body.split("\n")
+            last = max(i for i, line in enumerate(lines) if "{{" in line)
+            inline = "<script>" + "\n".join(lines[:last + 1]) + "\n</script>"
+            body = "\n".join(lines[last + 1:])
+        if not body.strip():
+            return inline or match.group(0)
+        script_count += 1
+        url = _add_asset(assets, f"share-{script_count}", "js", body)
+        return f'{inline}<script src="{url}"></script>'
+
+    html = _SCRIPT_RE.sub(replace_script, html)
+
+    segments = _PLACEHOLDER_RE.split(html)
+    page = CompiledPage(segments=segments, assets=assets)
+    logger.info(
+        f"Compiled share page: {len(html)} bytes of HTML, "
+        f"{len(segments) // 2} placeholders, {len(assets)} static assets"
+    )
+    return page
+
+
+def get_share_page() -> CompiledPage:
+    """Compiled share page (compiled on first use; main.lifespan compiles it at startup)"""
+    global _compiled
+    if _compiled is None:
+        _compiled = compile_share_page()
+    return _compiled
+
+
+def get_asset(filename: str) -> Optional[Asset]:
+    return get_share_page().assets.get(filename)
+
+
+async def get_cached_page(share_token: str, ws_base: str) -> Optional[CompressedBody]:
+    """Rendered page if its version counters haven't moved and it hasn't expired"""
+    key = (share_token, ws_base)
+    entry = _page_cache.get(key)
+    if entry is None:
+        return None
+    if entry.expires_at < time.monotonic() or await get_versions(*entry.scopes) != entry.versions:
+        _page_cache.pop(key, None)
+        return None
+    _page_cache.move_to_end(key)
+    return entry.body
+
+
+def cache_page(
+    share_token: str,
+    ws_base: str,
+    scopes: List[str],
+    versions: Optional[List[int]],
+    html: str
+) -> CompressedBody:
+    """
+    Compress a rendered page and keep it for later requests. versions must be
+    read before the data the page was rendered from; None (no Redis) skips caching.
+    """
+    body = CompressedBody.build(html.encode())
+    if versions is not None:
+        key = (share_token, ws_base)
+        _page_cache[key] = _CachedPage(scopes, versions, time.monotonic() + PAGE_CACHE_TTL, body)
+        _page_cache.move_to_end(key)
+        while len(_page_cache) > PAGE_CACHE_MAX_ENTRIES:
+            _page_cache.popitem(last=False)
+    return body
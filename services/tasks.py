@@ -17,6 +17,9 @@ logger = logging.getLogger(__name__)
 _redis_conn: Optional[Redis] = None
 _notification_queue: Optional[Queue] = None
 
+# Recipients per DB session / badge pipeline in bulk sends
+NOTIFICATION_BATCH_SIZE = 500
+
 
 def get_notification_queue() -> Queue:
     """Get the notification queue (lazy initialization)"""
@@ -41,27 +44,13 @@ def enqueue_notification(user_id: int, payload_dict: Dict[str, Any]) -> None:
 
 async def _send_apns_direct(user_id: int, payload_dict: Dict[str, Any]) -> None:
     """Send APNs notification directly without queue"""
-    from services.apns_service import get_apns_service, NotificationPayload, NotificationType
+    from services.apns_service import get_apns_service
     from db.database import get_session_maker
 
     try:
         session_maker = get_session_maker()
         async with session_maker() as db:
-            payload = NotificationPayload(
-                notification_type=NotificationType(payload_dict['notification_type']),
-                title=payload_dict['title'],
-                body=payload_dict['body'],
-                actor_id=payload_dict['actor_id'],
-                actor_nickname=payload_dict['actor_nickname'],
-                actor_profile_picture=payload_dict.get('actor_profile_picture'),
-                bounce_id=payload_dict.get('bounce_id'),
-                bounce_venue_name=payload_dict.get('bounce_venue_name'),
-                bounce_place_id=payload_dict.get('bounce_place_id'),
-                venue_place_id=payload_dict.get('venue_place_id'),
-                venue_name=payload_dict.get('venue_name'),
-                venue_latitude=payload_dict.get('venue_latitude'),
-                venue_longitude=payload_dict.get('venue_longitude'),
-            )
+            payload = payload_from_dict(payload_dict)
 
             apns = await get_apns_service()
             result = await apns.send_notification(db, user_id, payload)
@@ -73,14 +62,54 @@ async def _send_apns_direct(user_id: int, payload_dict: Dict[str, Any]) -> None:
 
 def enqueue_notifications_bulk(user_ids: list, payload_dict: Dict[str, Any]) -> None:
     """
-    Enqueue notifications for multiple users.
+    Send one notification to many users in a single background task.
+
+    Args:
+        user_ids: List of target user IDs
+        payload_dict: Serialized NotificationPayload as dict
+    """
+    if not user_ids:
+        return
+    asyncio.create_task(_send_apns_batch(list(user_ids), payload_dict))
+
+
+async def _send_apns_batch(user_ids: list, payload_dict: Dict[str, Any]) -> None:
+    """Send APNs notifications in chunks, one DB session and badge pipeline per chunk"""
+    from services.apns_service import get_apns_service
+    from db.database import get_session_maker
+
+    payload = payload_from_dict(payload_dict)
+    apns = await get_apns_service()
+    session_maker = get_session_maker()
+
+    for i in range(0, len(user_ids), NOTIFICATION_BATCH_SIZE):
+        chunk = user_ids[i:i + NOTIFICATION_BATCH_SIZE]
+        try:
+            async with session_maker() as db:
+                await apns.send_notification_batch(db, chunk, payload)
+        except Exception as e:
+            logger.error(f"Failed to send APNs batch of {len(chunk)} notification(s): {e}")
+
+
+def enqueue_notification_fanout(user_ids: list, payload_dict: Dict[str, Any]) -> None:
+    """
+    Deliver one notification to many users - in-app via WebSocket and push via
+    APNs - in a single background task, so the caller returns immediately.
 
     Args:
         user_ids: List of target user IDs
         payload_dict: Serialized NotificationPayload as dict
     """
+    if not user_ids:
+        return
+    asyncio.create_task(_fan_out_notification(list(user_ids), payload_dict))
+
+
+async def _fan_out_notification(user_ids: list, payload_dict: Dict[str, Any]) -> None:
+    """WebSocket notifications for connected users, then chunked APNs sends"""
     for user_id in user_ids:
-        enqueue_notification(user_id, payload_dict)
+        await send_websocket_notification(user_id, payload_dict)
+    await _send_apns_batch(user_ids, payload_dict)
 
 
 def send_notification_task(user_id: int, payload_dict: Dict[str, Any]) -> bool:
@@ -94,7 +123,7 @@ def send_notification_task(user_id: int, payload_dict: Dict[str, Any]) -> bool:
 
 async def _send_notification_async(user_id: int, payload_dict: Dict[str, Any]) -> bool:
     """Async implementation of notification sending"""
-    from services.apns_service import get_apns_service, NotificationPayload, NotificationType
+    from services.apns_service import get_apns_service
     from db.database import get_session_maker
 
     try:
@@ -102,21 +131,7 @@ async def _send_notification_async(user_id: int, payload_dict: Dict[str, Any]) -
         session_maker = get_session_maker()
         async with session_maker() as db:
             # Reconstruct the NotificationPayload from dict
-            payload = NotificationPayload(
-                notification_type=NotificationType(payload_dict['notification_type']),
-                title=payload_dict['title'],
-                body=payload_dict['body'],
-                actor_id=payload_dict['actor_id'],
-                actor_nickname=payload_dict['actor_nickname'],
-                actor_profile_picture=payload_dict.get('actor_profile_picture'),
-                bounce_id=payload_dict.get('bounce_id'),
-                bounce_venue_name=payload_dict.get('bounce_venue_name'),
-                bounce_place_id=payload_dict.get('bounce_place_id'),
-                venue_place_id=payload_dict.get('venue_place_id'),
-                venue_name=payload_dict.get('venue_name'),
-                venue_latitude=payload_dict.get('venue_latitude'),
-                venue_longitude=payload_dict.get('venue_longitude'),
-            )
+            payload = payload_from_dict(payload_dict)
 
             apns = await get_apns_service()
             result = await apns.send_notification(db, user_id, payload)
@@ -129,6 +144,27 @@ async def _send_notification_async(user_id: int, payload_dict: Dict[str, Any]) -
         raise  # Re-raise so RQ can retry
 
 
+def payload_from_dict(payload_dict: Dict[str, Any]):
+    """Rebuild a NotificationPayload from payload_to_dict output"""
+    from services.apns_service import NotificationPayload, NotificationType
+
+    return NotificationPayload(
+        notification_type=NotificationType(payload_dict['notification_type']),
+        title=payload_dict['title'],
+        body=payload_dict['body'],
+        actor_id=payload_dict['actor_id'],
+        actor_nickname=payload_dict['actor_nickname'],
+        actor_profile_picture=payload_dict.get('actor_profile_picture'),
+        bounce_id=payload_dict.get('bounce_id'),
+        bounce_venue_name=payload_dict.get('bounce_venue_name'),
+        bounce_place_id=payload_dict.get('bounce_place_id'),
+        venue_place_id=payload_dict.get('venue_place_id'),
+        venue_name=payload_dict.get('venue_name'),
+        venue_latitude=payload_dict.get('venue_latitude'),
+        venue_longitude=payload_dict.get('venue_longitude'),
+    )
+
+
 def payload_to_dict(payload) -> Dict[str, Any]:
     """Convert NotificationPayload to dict for queue serialization"""
     return {
@@ -3,6 +3,8 @@ Startup script for Railway deployment
 Handles:
 - Apple Sign-In private key decoding from base64 env var
 - Directory creation
+- Database migrations (once, before any worker starts)
+- Places autocomplete completion sets (built once if missing)
 - Uvicorn server launch
 """
 
@@ -54,6 +56,47 @@ def setup_apple_private_key():
         return False
 
 
+def run_database_migrations():
+    """Bring the schema up to the latest Alembic revision and top up history partitions"""
+    import asyncio
+    from db.database import upgrade_schema, ensure_history_partitions
+
+    try:
+        upgrade_schema()
+        print("✓ Database schema is at the latest revision")
+        created = asyncio.run(ensure_history_partitions())
+        print(f"✓ Check-in history partitions ready ({created} created)")
+        return True
+    except Exception as e:
+        print(f"❌ Database migration failed: {e}")
+        return False
+
+
+def build_place_completions():
+    """Build the places completion sets if Redis has never had them (first deploy, flushed Redis)"""
+    import asyncio
+    from services.places.autocomplete import ensure_completion_index
+    from services.redis import close_redis
+
+    async def build():
+        try:
+            return await ensure_completion_index()
+        finally:
+            await close_redis()
+
+    try:
+        indexed = asyncio.run(build())
+        if indexed is None:
+            print("✓ Places completion sets already built")
+        else:
+            print(f"✓ Places completion sets built ({indexed} places)")
+        return True
+    except Exception as e:
+        # Searches fall back to the lexical index until the sets are built
+        print(f"⚠️  Places completion build skipped: {e}")
+        return False
+
+
 def main():
     """Main startup sequence"""
     print("=" * 60)
@@ -61,15 +104,25 @@ def main():
     print("=" * 60)
 
     # Step 1: Create directories
-    print("\n[1/3] Setting up directories...")
+    print("\n[1/5] Setting up directories...")
     setup_directories()
 
     # Step 2: Decode Apple private key
-    print("\n[2/3] Setting up Apple Sign-In private key...")
+    print("\n[2/5] Setting up Apple Sign-In private key...")
     setup_apple_private_key()
 
-    # Step 3: Launch uvicorn
-    print("\n[3/3] Starting uvicorn server...")
+    # Step 3: Apply schema migrations
+    print("\n[3/5] Running database migrations...")
+    if not run_database_migrations():
+        # Never serve traffic against a half-migrated schema; fail the deploy
+        sys.exit(1)
+
+    # Step 4: Build the places completion sets if missing
+    print("\n[4/5] Building places completion sets...")
+    build_place_completions()
+
+    # Step 5: Launch uvicorn
+    print("\n[5/5] Starting uvicorn server...")
     print("=" * 60)
 
     # Get port from environment (Railway provides this)